@@ -0,0 +1,286 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c)  2012 The Provost, Fellows and Scholars of the
+ * College of the Holy and Undivided Trinity of Queen Elizabeth near Dublin.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jerome Arokkiam <jerome.arokkiam@bt.com>
+ */
+
+/**********************************************************************
+* ARCHITECTURE:
+*
+*  [SERVER]----[OLT]-------[ONU i]------[CELL i]
+*
+* Latency benchmark of the cooperative DBA (mobile fronthaul/midhaul over XG(S)-PON).
+* Every CELL (e.g., the DU of one small cell) sends one burst of UDP packets per TTI. With "--cooperative=true",
+* the radio scheduler announces each burst to the OLT ("lead" ahead of its arrival at ONU) through
+* XgponOltNetDevice::AnnounceUpstreamData, so that it is granted in the frame that it arrives. Otherwise, the data
+* waits for the status-report/grant loop of the DBA engine.
+*
+* Run the same configuration with and without the announcements, e.g.,
+*   ./ns3 run "xpon-cooperative-dba-benchmark --upstreamDBA=Xgiant --cooperative=false"
+*   ./ns3 run "xpon-cooperative-dba-benchmark --upstreamDBA=Xgiant --cooperative=true"
+* and compare the upstream one-way delays (from the CELL to the SERVER) that are printed at the end.
+**************************************************************/
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/point-to-point-module.h"
+
+#include "ns3/xgpon-helper.h"
+#include "ns3/xgpon-config-db.h"
+
+#include "ns3/xgpon-onu-net-device.h"
+#include "ns3/xgpon-olt-net-device.h"
+
+
+#define APP_START 0.5
+#define APP_STOP 2.5
+#define SIM_STOP APP_STOP +0.5
+
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("xpon-cooperative-dba-benchmark");
+
+
+static const uint32_t SEQ_TS_HEADER_SIZE = 12;    //the size of SeqTsHeader. unit: byte
+static const uint32_t UDP_IP_HEADER_SIZE = 28;    //unit: byte
+static const uint32_t XGEM_HEADER_SIZE = 8;       //unit: byte
+
+static std::vector<double> delays;                //the upstream one-way delays of the received packets. unit: microsecond
+
+
+//called by the sink at the server
+static void
+ReceivePacket (Ptr<const Packet> packet, const Address& from)
+{
+  SeqTsHeader header;
+  packet->PeekHeader (header);
+  delays.push_back ((Simulator::Now () - header.GetTs ()).GetNanoSeconds () / 1000.0);
+}
+
+
+//send the packets of one TTI from one CELL and schedule the next TTI
+static void
+SendTti (Ptr<Socket> socket, uint32_t nPackets, uint32_t packetSize, Time tti)
+{
+  for(uint32_t i = 0; i < nPackets; i++)
+  {
+    Ptr<Packet> packet = Create<Packet> (packetSize - SEQ_TS_HEADER_SIZE);
+    SeqTsHeader header;
+    packet->AddHeader (header);
+    socket->Send (packet);
+  }
+  if(Simulator::Now () + tti < Seconds (APP_STOP)) Simulator::Schedule (tti, &SendTti, socket, nPackets, packetSize, tti);
+}
+
+
+//announce the data of one TTI to the OLT ("lead" ahead) and schedule the next announcement
+static void
+AnnounceTti (Ptr<XgponOltNetDevice> oltDevice, uint16_t allocId, uint32_t size, Time lead, Time lastMileTime, Time tti)
+{
+  oltDevice->AnnounceUpstreamData (allocId, size, Simulator::Now () + lead + lastMileTime);
+  if(Simulator::Now () + lead + tti < Seconds (APP_STOP)) Simulator::Schedule (tti, &AnnounceTti, oltDevice, allocId, size, lead, lastMileTime, tti);
+}
+
+
+
+int
+main (int argc, char *argv[])
+{
+  uint16_t nOnus = 8;                     //number of ONUs (one small cell per ONU)
+  std::string pon_mode = "XGSPON";
+  std::string upstream_dba = "Xgiant";    //DBA to be used for upstream bandwidth allocation
+  bool cooperative = false;               //whether the data of each TTI is announced to the OLT
+  uint32_t ttiUs = 500;                   //TTI of the radio. unit: microsecond
+  uint32_t ttiSize = 30000;               //the data sent by one CELL per TTI. unit: byte
+  uint32_t packetSize = 1400;             //UDP payload size. unit: byte
+  uint32_t leadUs = 1000;                 //how long before its arrival the data of one TTI is announced. unit: microsecond
+
+  CommandLine cmd;
+  cmd.AddValue ("nOnus", "Number of ONUs in the XG(S)PON (default 8)", nOnus);
+  cmd.AddValue ("pon-mode", "Select the PON technology to be used in the simualtion [XGPON, XGSPON] (default XGSPON)", pon_mode);
+  cmd.AddValue ("upstreamDBA", "DBA to be used for XG(S)PON upstream [RoundRobin, Giant, Ebu, Xgiant, XgiantDeficit, XgiantProp, MaxMin, Predictive] (default Xgiant)", upstream_dba);
+  cmd.AddValue ("cooperative", "Announce the data of each TTI to the OLT ahead of its arrival (default false)", cooperative);
+  cmd.AddValue ("tti", "TTI of the radio in microseconds (default 500)", ttiUs);
+  cmd.AddValue ("ttiSize", "Bytes sent by each small cell per TTI (default 30000)", ttiSize);
+  cmd.AddValue ("packetSize", "UDP payload size in bytes (default 1400)", packetSize);
+  cmd.AddValue ("lead", "Microseconds between the announcement and the arrival of the data of one TTI (default 1000)", leadUs);
+  cmd.Parse (argc, argv);
+
+  NS_ASSERT_MSG((packetSize > SEQ_TS_HEADER_SIZE), "The packet is too small to carry the timestamp!!!");
+
+  std::string xgponDba = "ns3::XgponOltDbaEngine";
+  xgponDba.append (upstream_dba);
+
+  Time tti = MicroSeconds (ttiUs);
+  Time lead = MicroSeconds (leadUs);
+  uint32_t nPackets = (ttiSize + packetSize - 1) / packetSize;
+  double cellRate = 8.0 * nPackets * packetSize * 1e6 / ttiUs;    //unit: bps
+
+  //the size of the XGEM frames that carry one TTI (the XGEM payload is padded to 4 bytes)
+  uint32_t xgemSize = nPackets * (XGEM_HEADER_SIZE + ((packetSize + UDP_IP_HEADER_SIZE + 3) / 4) * 4);
+
+
+  //////////////////////////////////////////////////////////////////////////CONFIGURATIONS FOR XGPON HELPER
+  XgponHelper xgponHelper;
+  XgponConfigDb& xgponConfigDb = xgponHelper.GetConfigDb ( );
+
+  xgponConfigDb.SetPonMode (pon_mode);
+  xgponConfigDb.SetOltNetmaskLen (8);
+  xgponConfigDb.SetOnuNetmaskLen (24);
+  xgponConfigDb.SetIpAddressFirstByteForXgpon (10);
+  xgponConfigDb.SetIpAddressFirstByteForOnus (173);
+  xgponConfigDb.SetAllocateIds4Speed (true);
+  xgponConfigDb.SetOltDbaEngineTypeIdStr (xgponDba);
+  xgponHelper.InitializeObjectFactories ( );
+
+  Config::SetDefault ("ns3::XgponQueue::MaxBytes", UintegerValue (4 * xgemSize * (leadUs / ttiUs + 2)));
+
+
+  //////////////////////////////////////////CREATE THE NODES AND LINKS
+  NodeContainer oltNode, serverNode, onuNodes, cellNodes;
+  oltNode.Create (1);
+  serverNode.Create (1);
+  onuNodes.Create (nOnus);
+  cellNodes.Create (nOnus);
+
+  NodeContainer xgponNodes;
+  xgponNodes.Add (oltNode.Get(0));
+  for(int i=0; i<nOnus; i++) { xgponNodes.Add (onuNodes.Get(i)); }
+
+  //0: olt; i (>0): onu
+  NetDeviceContainer xgponDevices = xgponHelper.Install (xgponNodes);
+  Ptr<XgponOltNetDevice> oltDevice = DynamicCast<XgponOltNetDevice, NetDevice> (xgponDevices.Get(0));
+
+  InternetStackHelper stack;
+  stack.Install (xgponNodes);
+  stack.Install (serverNode);
+  stack.Install (cellNodes);
+
+  //the links outside XG(S)-PON are never the bottleneck
+  PointToPointHelper pointToPoint;
+  pointToPoint.SetChannelAttribute ("Delay", StringValue ("1us"));
+  pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("40Gbps"));
+
+  NetDeviceContainer metroDevices = pointToPoint.Install (serverNode.Get(0), oltNode.Get(0));
+  std::vector<NetDeviceContainer> lastMileDevices (nOnus);
+  for(int i=0; i<nOnus; i++) { lastMileDevices[i] = pointToPoint.Install (cellNodes.Get(i), onuNodes.Get(i)); }
+
+  //the time for the data of one TTI to reach the T-CONT after the CELL starts to send it
+  Time lastMileTime = MicroSeconds (1) + NanoSeconds ((uint64_t) nPackets * (packetSize + UDP_IP_HEADER_SIZE + 2) * 8 / 40);
+
+
+  /////////////////////////////////////////////////////ASSIGN IP ADDRESSES
+  Ipv4AddressHelper addressHelper;
+  std::string xgponIpbase = xgponHelper.GetXgponIpAddressBase ( );
+  std::string xgponNetmask = xgponHelper.GetOltAddressNetmask();
+  addressHelper.SetBase (xgponIpbase.c_str(), xgponNetmask.c_str());
+  Ipv4InterfaceContainer xgponInterfaces = addressHelper.Assign (xgponDevices);
+  for(int i=0; i<(nOnus+1);i++)
+  {
+    Ptr<XgponNetDevice> tmpDevice = DynamicCast<XgponNetDevice, NetDevice> (xgponDevices.Get(i));
+    tmpDevice->SetAddress (xgponInterfaces.GetAddress(i));
+  }
+
+  addressHelper.SetBase ("172.0.0.0", "255.255.255.0");
+  Ipv4InterfaceContainer metroInterfaces = addressHelper.Assign (metroDevices);
+
+  std::vector<Ipv4InterfaceContainer> lastMileInterfaces (nOnus);
+  for(int i=0; i<nOnus; i++)
+  {
+    Ptr<XgponOnuNetDevice> onuDevice = DynamicCast<XgponOnuNetDevice, NetDevice> (xgponDevices.Get(i+1));
+    std::string onuIpbase = xgponHelper.GetOnuIpAddressBase (onuDevice);
+    std::string onuNetmask = xgponHelper.GetOnuAddressNetmask();
+    addressHelper.SetBase (onuIpbase.c_str(), onuNetmask.c_str());
+    lastMileInterfaces[i] = addressHelper.Assign (lastMileDevices[i]);
+  }
+
+
+  //////////////////////////////////////////////CONFIGURE THE XGPON CONNECTIONS (ONE ASSURED T-CONT AND ONE DOWNSTREAM CONNECTION PER ONU)
+  //the T-CONT is provisioned with twice the rate of its CELL (used by the QoS-aware DBAs only)
+  std::vector<uint16_t> allocIds (nOnus);
+  for(int i=0; i< nOnus; i++)
+  {
+    Address addr = lastMileInterfaces[i].GetAddress(1); //address of the ONU
+    Ptr<XgponOnuNetDevice> onuDevice = DynamicCast<XgponOnuNetDevice, NetDevice> (xgponDevices.Get(i+1));
+
+    xgponHelper.SetQosParametersAttribute ("FixedBandwidth", UintegerValue (0));
+    xgponHelper.SetQosParametersAttribute ("AssuredBandwidth", UintegerValue ((uint64_t) (2 * cellRate)));
+    xgponHelper.SetQosParametersAttribute ("NonAssuredBandwidth", UintegerValue ((uint64_t) (2 * cellRate)));
+    xgponHelper.SetQosParametersAttribute ("BestEffortBandwidth", UintegerValue (0));
+    xgponHelper.SetQosParametersAttribute ("MaxServiceInterval", UintegerValue (1));
+    xgponHelper.SetQosParametersAttribute ("MinServiceInterval", UintegerValue (2));
+
+    xgponHelper.AddOneDownstreamConnectionForOnu (onuDevice, oltDevice, addr);
+    allocIds[i] = xgponHelper.AddOneTcontForOnu (onuDevice, oltDevice, XgponQosParameters::XGPON_TCONT_TYPE_2);
+    xgponHelper.AddOneUpstreamConnectionForOnu (onuDevice, oltDevice, allocIds[i], addr);
+  }
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+
+  ////////////////////////////////////////////////////CONFIGURE APPLICATION TRAFFIC
+  uint16_t usPort = 9001;
+  PacketSinkHelper sink ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), usPort));
+  ApplicationContainer sinkApp = sink.Install (serverNode.Get(0));
+  sinkApp.Start (Seconds (0.05));
+  sinkApp.Stop (Seconds (SIM_STOP));
+  sinkApp.Get(0)->TraceConnectWithoutContext ("Rx", MakeCallback (&ReceivePacket));
+
+  for (int i=0; i<nOnus; i++)
+  {
+    Ptr<Socket> socket = Socket::CreateSocket (cellNodes.Get(i), UdpSocketFactory::GetTypeId ());
+    socket->SetIpTos (XgponQosParameters::XGPON_TCONT_TYPE_2 << 2);  //the T-CONT type is derived from the TOS field at ONU
+    socket->Connect (InetSocketAddress (metroInterfaces.GetAddress(0), usPort));
+
+    //the CELLs send in different parts of the TTI
+    Time start = Seconds (APP_START) + NanoSeconds (tti.GetNanoSeconds () * i / nOnus);
+    Simulator::Schedule (start, &SendTti, socket, nPackets, packetSize, tti);
+    if(cooperative) { Simulator::Schedule (start - lead, &AnnounceTti, oltDevice, allocIds[i], xgemSize, lead, lastMileTime, tti); }
+  }
+
+
+  Simulator::Stop (Seconds (SIM_STOP));
+  Simulator::Run ();
+
+  //the delays of the received packets
+  std::sort (delays.begin (), delays.end ());
+  double sum = 0;
+  for(std::vector<double>::const_iterator it = delays.begin (); it != delays.end (); it++) sum += *it;
+
+  std::cout << "dba," << upstream_dba << ",cooperative," << cooperative << ",onus," << nOnus
+            << ",cellRate(Mbps)," << cellRate / 1e6 << ",received," << delays.size () << ",packets";
+  if(!delays.empty ())
+  {
+    std::cout << ",delay(us),mean," << sum / delays.size ()
+              << ",p50," << delays[delays.size () / 2]
+              << ",p99," << delays[(delays.size () * 99) / 100]
+              << ",max," << delays.back ();
+  }
+  std::cout << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
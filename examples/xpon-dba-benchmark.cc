@@ -0,0 +1,346 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c)  2012 The Provost, Fellows and Scholars of the
+ * College of the Holy and Undivided Trinity of Queen Elizabeth near Dublin.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jerome Arokkiam <jerome.arokkiam@bt.com>
+ */
+
+/**********************************************************************
+* Offline benchmark of the upstream DBA engines (no traffic, network stack or XG(S)-PON frames are simulated).
+*
+* The OLT and ONU devices are created without nodes (XgponHelper::CreateDevices) and never started; only the DBA engine
+* (instantiated by its TypeId) is driven. It generates one BWmap per frame and receives the queue status reports (DBRu):
+*   - synthetic (default): every T-CONT has one ONU queue with random arrivals. The grants of each BWmap drain the queues
+*     one RTT later and the ONUs report their occupancies in the DBRu of these grants (closed loop);
+*   - replay ("--trace=file"): the reports of one file ("time(ns),allocId,bufOcc(blocks)" per line, in the order of time)
+*     are delivered at their times, whatever is granted (open loop). "--record=file" writes the reports of one synthetic run
+*     in this format, so that different engines can be compared with the same reports.
+*
+* It prints the time to generate one BWmap, the utilisation of the upstream frames and the Jain's fairness index of the
+* served/offered ratios (synthetic) or granted/reported ratios (replay) of the T-CONTs. The grants of each T-CONT
+* (the allocation vector) are written by "--allocations=file".
+*
+* Run with:
+*   ./ns3 run "xpon-dba-benchmark --dba=XgponOltDbaEngineXgiant --nOnus=1021 --nFrames=8000 --load=0.9"
+**************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+
+#include "ns3/xgpon-helper.h"
+#include "ns3/xgpon-config-db.h"
+
+#include "ns3/xgpon-onu-net-device.h"
+#include "ns3/xgpon-olt-net-device.h"
+
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("xpon-dba-benchmark");
+
+
+/**
+ * \brief the ONU-side queue and the counters of one T-CONT
+ */
+struct TcontState
+{
+  uint16_t m_onuId;
+  double m_meanArrival;      //synthetic: the mean arrivals per frame. unit: byte
+  uint64_t m_queue;          //synthetic: the data waiting at ONU. unit: byte
+  uint64_t m_offered;        //synthetic: the data arrived at ONU; replay: the sum of the reported occupancies. unit: byte
+  uint64_t m_served;         //synthetic: the data sent with the grants. unit: byte
+  uint64_t m_granted;        //the grants (DBRu excluded). unit: byte
+};
+
+
+static Ptr<XgponOltDbaEngine> dbaEngine;
+static std::vector<TcontState> tconts;          //indexed by alloc-id (empty entries for unused alloc-ids)
+static std::vector<uint16_t> allocIds;
+static Ptr<ExponentialRandomVariable> arrivalRng;
+
+static uint32_t blockSize;                      //unit: byte
+static uint64_t rtt;                            //unit: nanosecond
+static uint64_t usRate;                         //unit: byte per second
+static uint32_t usFrameSize;                    //unit: block
+static bool synthetic;
+static std::ofstream record;
+
+static std::vector<double> generationTimes;     //the time to generate each BWmap. unit: microsecond
+static uint64_t grantedBlocks = 0;              //all grants, DBRu included. unit: block
+
+
+
+//deliver one status report to the engine
+static void
+DeliverReport (uint16_t allocId, uint32_t bufOcc, uint64_t time)
+{
+  TcontState& tcont = tconts[allocId];
+  if(!synthetic) tcont.m_offered += (uint64_t) bufOcc * blockSize;
+  if(record.is_open ()) record << time << "," << allocId << "," << bufOcc << "\n";
+
+  Ptr<XgponXgtcDbru> dbru = Create<XgponXgtcDbru> (bufOcc);
+  dbaEngine->ReceiveStatusReport (dbru, tcont.m_onuId, allocId, time);
+}
+
+
+//the bursts of one BWmap are received one RTT later (synthetic): serve the ONU queues and deliver the reports.
+static void
+ReceiveBurst (Ptr<XgponXgtcBwmap> map, uint16_t first, uint16_t end)
+{
+  uint64_t now = Simulator::Now ().GetNanoSeconds ();
+  for(uint16_t i = first; i < end; i++)
+  {
+    const Ptr<XgponXgtcBwAllocation>& bwAlloc = map->GetBwAllocationByIndex (i);
+    TcontState& tcont = tconts[bwAlloc->GetAllocId ()];
+
+    uint32_t dataSize = bwAlloc->GetGrantSize () - (bwAlloc->GetDbruFlag () ? 1 : 0);
+    uint64_t served = std::min ((uint64_t) dataSize * blockSize, tcont.m_queue);
+    tcont.m_queue -= served;
+    tcont.m_served += served;
+
+    if(bwAlloc->GetDbruFlag ()) DeliverReport (bwAlloc->GetAllocId (), (tcont.m_queue + blockSize - 1) / blockSize, now);
+  }
+}
+
+
+//generate the BWmap of one frame and account its grants
+static void
+GenerateBwMap (uint64_t frame, uint64_t nFrames, uint64_t slotSize)
+{
+  //the arrivals at ONUs during the last frame
+  if(synthetic)
+  {
+    for(std::vector<uint16_t>::const_iterator it = allocIds.begin (); it != allocIds.end (); it++)
+    {
+      TcontState& tcont = tconts[*it];
+      uint64_t arrival = (uint64_t) arrivalRng->GetValue (tcont.m_meanArrival, 0);
+      tcont.m_queue += arrival;
+      tcont.m_offered += arrival;
+    }
+  }
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  Ptr<XgponXgtcBwmap> map = dbaEngine->GenerateBwMap ();
+  generationTimes.push_back (std::chrono::duration<double, std::micro> (std::chrono::steady_clock::now () - start).count ());
+
+  uint16_t num = map->GetNumberOfBwAllocation ();
+  uint16_t burstFirst = 0;
+  uint16_t burstStart = 0;
+  for(uint16_t i = 0; i < num; i++)
+  {
+    const Ptr<XgponXgtcBwAllocation>& bwAlloc = map->GetBwAllocationByIndex (i);
+    uint16_t grantSize = bwAlloc->GetGrantSize ();
+    grantedBlocks += grantSize;
+    tconts[bwAlloc->GetAllocId ()].m_granted += (uint64_t) (grantSize - (bwAlloc->GetDbruFlag () ? 1 : 0)) * blockSize;
+
+    //StartTime is only set in the first allocation of each burst (0 in the others)
+    if(synthetic && (i == 0 || bwAlloc->GetStartTime () != 0))
+    {
+      if(i > 0) Simulator::Schedule (NanoSeconds (rtt + (uint64_t) burstStart * blockSize * 1000000000ULL / usRate), &ReceiveBurst, map, burstFirst, i);
+      burstFirst = i;
+      burstStart = bwAlloc->GetStartTime ();
+    }
+  }
+  if(synthetic && num > 0) Simulator::Schedule (NanoSeconds (rtt + (uint64_t) burstStart * blockSize * 1000000000ULL / usRate), &ReceiveBurst, map, burstFirst, num);
+
+  if(frame + 1 < nFrames) Simulator::Schedule (NanoSeconds (slotSize), &GenerateBwMap, frame + 1, nFrames, slotSize);
+}
+
+
+//schedule the reports of one file (replay)
+static uint64_t
+ScheduleReports (const std::string& fileName)
+{
+  std::ifstream trace (fileName.c_str ());
+  NS_ASSERT_MSG(trace.is_open (), "The trace of reports cannot be opened!!!");
+
+  uint64_t num = 0;
+  std::string line;
+  while(std::getline (trace, line))
+  {
+    uint64_t time;
+    uint32_t allocId, bufOcc;
+    char comma1, comma2;
+    std::istringstream fields (line);
+    if(!(fields >> time >> comma1 >> allocId >> comma2 >> bufOcc)) continue;
+    NS_ASSERT_MSG((allocId < tconts.size () && tconts[allocId].m_onuId != 0xFFFF), "The report belongs to an unknown T-CONT!!!");
+
+    Simulator::Schedule (NanoSeconds (time), &DeliverReport, (uint16_t) allocId, bufOcc, time);
+    num++;
+  }
+  return num;
+}
+
+
+
+int
+main (int argc, char *argv[])
+{
+  std::string dba = "XgponOltDbaEngineXgiant";
+  std::string pon_mode = "XGSPON";
+  uint16_t nOnus = 1021;
+  uint16_t nTconts = 4;               //T-CONTs per ONU (of the types 1 to nTconts)
+  uint32_t nFrames = 8000;            //one second
+  double load = 0.9;                  //synthetic: the offered load relative to the upstream capacity
+  std::string traceFile = "";
+  std::string recordFile = "";
+  std::string allocationFile = "";
+
+  CommandLine cmd;
+  cmd.AddValue ("dba", "TypeId of the DBA engine, with or without \"ns3::\" (default XgponOltDbaEngineXgiant)", dba);
+  cmd.AddValue ("pon-mode", "Select the PON technology [XGPON, XGSPON] (default XGSPON)", pon_mode);
+  cmd.AddValue ("nOnus", "Number of ONUs (default 1021)", nOnus);
+  cmd.AddValue ("nTconts", "Number of T-CONTs per ONU, of the types 1 to nTconts (default 4)", nTconts);
+  cmd.AddValue ("nFrames", "Number of BWmaps to generate (default 8000)", nFrames);
+  cmd.AddValue ("load", "Synthetic: offered load relative to the upstream capacity (default 0.9)", load);
+  cmd.AddValue ("trace", "Replay the reports of this file instead of the synthetic ONU queues", traceFile);
+  cmd.AddValue ("record", "Write the reports of the synthetic ONU queues to this file", recordFile);
+  cmd.AddValue ("allocations", "Write the grants of each T-CONT to this file", allocationFile);
+  cmd.Parse (argc, argv);
+
+  NS_ASSERT_MSG((nTconts >= 1 && nTconts <= 4), "One ONU has 1 to 4 T-CONTs in this benchmark!!!");
+  if(dba.compare (0, 5, "ns3::") != 0) dba = "ns3::" + dba;
+  synthetic = traceFile.empty ();
+
+
+  //////////////////////////////////////////////////////////////////////////CREATE THE DEVICES (WITHOUT NODES)
+  XgponHelper xgponHelper;
+  XgponConfigDb& xgponConfigDb = xgponHelper.GetConfigDb ( );
+  xgponConfigDb.SetPonMode (pon_mode);
+  xgponConfigDb.SetAllocateIds4Speed (false);    //the speed allocator only moves to the next alloc-id when an upstream connection is added
+  xgponConfigDb.SetOltDbaEngineTypeIdStr (dba);
+  xgponHelper.InitializeObjectFactories ( );
+
+  //the QoS parameters share the offered load among all T-CONTs (used by the QoS-aware DBAs only)
+  double capacity = (pon_mode == "XGPON") ? 2.24e9 : 9.94e9;  //unit: bps
+  uint64_t perTcontRate = (uint64_t) (capacity / (nOnus * nTconts));
+  xgponHelper.SetQosParametersAttribute ("FixedBandwidth", UintegerValue (perTcontRate / 4));
+  xgponHelper.SetQosParametersAttribute ("AssuredBandwidth", UintegerValue (perTcontRate));
+  xgponHelper.SetQosParametersAttribute ("NonAssuredBandwidth", UintegerValue (perTcontRate));
+  xgponHelper.SetQosParametersAttribute ("BestEffortBandwidth", UintegerValue (perTcontRate));
+  xgponHelper.SetQosParametersAttribute ("MaxServiceInterval", UintegerValue (1));
+  xgponHelper.SetQosParametersAttribute ("MinServiceInterval", UintegerValue (2));
+
+  NetDeviceContainer xgponDevices = xgponHelper.CreateDevices (nOnus);
+  Ptr<XgponOltNetDevice> oltDevice = DynamicCast<XgponOltNetDevice, NetDevice> (xgponDevices.Get(0));
+  dbaEngine = oltDevice->GetDbaEngine ();
+
+  const Ptr<XgponPhy>& phy = oltDevice->GetXgponPhy ();
+  blockSize = (pon_mode == "XGPON") ? 4 : 16;
+  usRate = phy->GetUsLinkRate ();
+  usFrameSize = phy->GetUsPhyFrameSizeInBlocks ();
+  uint64_t slotSize = phy->GetDsFrameSlotSize ();
+  rtt = 2 * (DynamicCast<XgponChannel, Channel> (oltDevice->GetChannel ()))->GetLogicOneWayDelay ();
+
+  arrivalRng = CreateObject<ExponentialRandomVariable> ();
+  Ptr<UniformRandomVariable> rateRng = CreateObject<UniformRandomVariable> ();
+  double meanArrival = load * usFrameSize * blockSize / (nOnus * nTconts);   //unit: byte per frame
+
+  for(uint16_t i = 0; i < nOnus; i++)
+  {
+    Ptr<XgponOnuNetDevice> onuDevice = DynamicCast<XgponOnuNetDevice, NetDevice> (xgponDevices.Get(i+1));
+    for(uint16_t type = 1; type <= nTconts; type++)
+    {
+      uint16_t allocId = xgponHelper.AddOneTcontForOnu (onuDevice, oltDevice, static_cast<XgponQosParameters::XgponTcontType> (type));
+      if(allocId >= tconts.size ())
+      {
+        TcontState unused = { 0xFFFF, 0, 0, 0, 0, 0 };
+        tconts.resize (allocId + 1, unused);
+      }
+      TcontState& tcont = tconts[allocId];
+      tcont.m_onuId = onuDevice->GetOnuId ();
+      tcont.m_meanArrival = meanArrival * rateRng->GetValue (0.5, 1.5);   //heterogeneous T-CONTs
+      allocIds.push_back (allocId);
+    }
+  }
+
+  if(!recordFile.empty ()) record.open (recordFile.c_str ());
+  uint64_t nReports = synthetic ? 0 : ScheduleReports (traceFile);
+
+
+  ////////////////////////////////////////////////////////////////////////////RUN
+  Simulator::Schedule (NanoSeconds (0), &GenerateBwMap, 0, nFrames, slotSize);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  Simulator::Run ();
+  double wallTime = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+
+
+  //////////////////////////////////////////////////////////////////////////REPORT
+  std::vector<double> sortedTimes (generationTimes);
+  std::sort (sortedTimes.begin (), sortedTimes.end ());
+  double sumTime = 0;
+  for(std::vector<double>::const_iterator it = sortedTimes.begin (); it != sortedTimes.end (); it++) sumTime += *it;
+
+  //utilisation: the grants relative to the upstream capacity (and the part of the grants used by data in synthetic runs)
+  uint64_t granted = 0, served = 0;
+  double sumRatio = 0, sumRatio2 = 0;
+  uint32_t nRatios = 0;
+  for(std::vector<uint16_t>::const_iterator it = allocIds.begin (); it != allocIds.end (); it++)
+  {
+    const TcontState& tcont = tconts[*it];
+    granted += tcont.m_granted;
+    served += tcont.m_served;
+    if(tcont.m_offered == 0) continue;
+
+    double ratio = (double) (synthetic ? tcont.m_served : tcont.m_granted) / tcont.m_offered;
+    sumRatio += ratio;
+    sumRatio2 += ratio * ratio;
+    nRatios++;
+  }
+
+  std::cout << "dba," << dba << ",onus," << nOnus << ",tconts," << allocIds.size () << ",frames," << generationTimes.size ();
+  if(synthetic) std::cout << ",load," << load;
+  else std::cout << ",reports," << nReports;
+  std::cout << ",wallTime(s)," << wallTime << std::endl;
+
+  if(!sortedTimes.empty ())
+  {
+    std::cout << "bwmapTime(us),mean," << sumTime / sortedTimes.size ()
+              << ",p50," << sortedTimes[sortedTimes.size () / 2]
+              << ",p99," << sortedTimes[(sortedTimes.size () * 99) / 100]
+              << ",max," << sortedTimes.back () << std::endl;
+  }
+
+  std::cout << "utilisation,granted," << (double) grantedBlocks / ((double) usFrameSize * generationTimes.size ())
+            << ",grantedData," << (double) granted / ((double) usFrameSize * blockSize * generationTimes.size ());
+  if(synthetic) std::cout << ",used," << (granted > 0 ? (double) served / granted : 0);
+  std::cout << std::endl;
+
+  std::cout << "fairness(Jain)," << (nRatios > 0 && sumRatio2 > 0 ? (sumRatio * sumRatio) / (nRatios * sumRatio2) : 0) << std::endl;
+
+  if(!allocationFile.empty ())
+  {
+    std::ofstream allocations (allocationFile.c_str ());
+    allocations << "allocId,onuId,offered(Bytes),granted(Bytes),served(Bytes)" << std::endl;
+    for(std::vector<uint16_t>::const_iterator it = allocIds.begin (); it != allocIds.end (); it++)
+    {
+      const TcontState& tcont = tconts[*it];
+      allocations << *it << "," << tcont.m_onuId << "," << tcont.m_offered << "," << tcont.m_granted << "," << tcont.m_served << std::endl;
+    }
+  }
+
+  Simulator::Destroy ();
+  return 0;
+}
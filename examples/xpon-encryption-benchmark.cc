@@ -0,0 +1,106 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c)  2012 The Provost, Fellows and Scholars of the
+ * College of the Holy and Undivided Trinity of Queen Elizabeth near Dublin.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jerome Arokkiam <jerome.arokkiam@bt.com>
+ */
+
+/**********************************************************************
+* Micro-benchmark of the AES-128-CTR encryption of XGEM payloads.
+*
+* It checks the keystream against the counter-mode vector of NIST SP 800-38A, compares the batched keystream
+* (AES instructions when the compiler targets them) with the portable table-driven one, and measures the cost of
+* encrypting one downstream frame. Its output indicates the per-frame cost of enabling "--XgponEncryptionEnabled=true"
+* in the simulation scripts.
+*
+* Run with:
+*   ./ns3 run "xpon-encryption-benchmark --frameSize=155520 --nFrames=2000"
+**************************************************************/
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "ns3/core-module.h"
+
+#include "ns3/xgpon-aes-ctr.h"
+
+
+using namespace ns3;
+
+
+static double
+ElapsedNs (std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double, std::nano> (std::chrono::steady_clock::now () - start).count ();
+}
+
+
+int 
+main (int argc, char *argv[])
+{
+  uint32_t frameSize = 155520;    //one downstream frame of 9.95328Gbps in 125us (bytes)
+  uint32_t nFrames = 2000;
+
+  CommandLine cmd;
+  cmd.AddValue ("frameSize", "The number of bytes encrypted per downstream frame", frameSize);
+  cmd.AddValue ("nFrames", "The number of downstream frames", nFrames);
+  cmd.Parse (argc, argv);
+
+
+  //NIST SP 800-38A, F.5.1 (CTR-AES128.Encrypt), the first block.
+  const uint8_t key[16] = { 0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c };
+  const uint8_t expected[16] = { 0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26, 0x1b, 0xef, 0x68, 0x64, 0x99, 0x0d, 0xb6, 0xce };
+  uint8_t block[16] = { 0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a };
+
+  uint8_t roundKeys[XgponAesCtr::XGPON_AES_ROUND_KEYS_SIZE];
+  XgponAesCtr::ExpandKey (key, roundKeys);
+  XgponAesCtr::Crypt (roundKeys, 0xf0f1f2f3f4f5f6f7ULL, 0xf8f9fafbfcfdfeffULL, block, 16);
+  NS_ABORT_MSG_IF ((memcmp (block, expected, 16) != 0), "The keystream is different with the one of SP 800-38A!!!");
+
+
+  uint32_t nBlocks = XgponAesCtr::GetNumberOfBlocks (frameSize);
+  std::vector<uint8_t> batched (nBlocks * XgponAesCtr::XGPON_AES_BLOCK_SIZE);
+  std::vector<uint8_t> portable (nBlocks * XgponAesCtr::XGPON_AES_BLOCK_SIZE);
+  XgponAesCtr::GenerateKeystream (roundKeys, 1, 0, &batched[0], nBlocks);
+  XgponAesCtr::GenerateKeystreamPortable (roundKeys, 1, 0, &portable[0], nBlocks);
+  NS_ABORT_MSG_IF ((batched != portable), "The batched keystream is different with the portable one!!!");
+
+
+  std::vector<uint8_t> frame (frameSize);
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  for(uint32_t i = 0; i < frameSize; i++) frame[i] = rand->GetInteger (0, 255);
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  for(uint32_t i = 0; i < nFrames; i++) XgponAesCtr::GenerateKeystreamPortable (roundKeys, i, 0, &portable[0], nBlocks);
+  double portableNs = ElapsedNs (start) / nFrames;
+
+  start = std::chrono::steady_clock::now ();
+  for(uint32_t i = 0; i < nFrames; i++) XgponAesCtr::Crypt (roundKeys, i, 0, &frame[0], frameSize);
+  double cryptNs = ElapsedNs (start) / nFrames;
+
+
+  std::cout << "AES instructions:     " << (XgponAesCtr::IsAesNiUsed () ? "yes" : "no") << std::endl;
+  std::cout << "keystream (portable): " << portableNs << " ns per frame of " << frameSize << " bytes (" 
+            << (frameSize * 8.0 / portableNs) << " Gbps)" << std::endl;
+  std::cout << "encryption (batched): " << cryptNs << " ns per frame of " << frameSize << " bytes (" 
+            << (frameSize * 8.0 / cryptNs) << " Gbps)" << std::endl;
+  std::cout << "(checksum: " << (uint32_t) (frame[0] ^ portable[0]) << ")" << std::endl;
+
+  return 0;
+}
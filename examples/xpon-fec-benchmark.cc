@@ -0,0 +1,113 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c)  2012 The Provost, Fellows and Scholars of the
+ * College of the Holy and Undivided Trinity of Queen Elizabeth near Dublin.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jerome Arokkiam <jerome.arokkiam@bt.com>
+ */
+
+/**********************************************************************
+* Micro-benchmark of the Reed-Solomon FEC of XG-PON: RS(248,216) in downstream and RS(248,232) in upstream.
+*
+* It checks that t random symbol errors per codeword are corrected (shortened codewords included), and measures
+* the cost of encoding and decoding one downstream frame. Its output indicates the per-frame cost of enabling
+* "--XgponFecEnabled=true" (or "ns3::XgponChannel::BitErrorRate") in the simulation scripts.
+*
+* Run with:
+*   ./ns3 run "xpon-fec-benchmark --frameSize=135432 --nFrames=1000"
+**************************************************************/
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "ns3/core-module.h"
+
+#include "ns3/xgpon-fec.h"
+
+
+using namespace ns3;
+
+
+static double
+ElapsedNs (std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double, std::nano> (std::chrono::steady_clock::now () - start).count ();
+}
+
+
+int 
+main (int argc, char *argv[])
+{
+  uint32_t frameSize = 135432;    //the XGTC payload of one downstream frame with FEC (627 codewords of 216 bytes)
+  uint32_t nFrames = 1000;
+  uint32_t nTrials = 10000;
+
+  CommandLine cmd;
+  cmd.AddValue ("frameSize", "The number of bytes encoded per downstream frame", frameSize);
+  cmd.AddValue ("nFrames", "The number of downstream frames", nFrames);
+  cmd.AddValue ("nTrials", "The number of codewords corrupted to check the decoder", nTrials);
+  cmd.Parse (argc, argv);
+
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+
+  const uint16_t dataSizes[2] = { 216, 232 };
+  for(uint32_t c = 0; c < 2; c++)
+  {
+    const XgponFec& code = XgponFec::GetCode (248, dataSizes[c]);
+    uint32_t t = code.GetParitySize () / 2;
+
+    for(uint32_t trial = 0; trial < nTrials; trial++)
+    {
+      uint8_t codeword[248], original[248];
+      uint32_t len = (trial % 4 == 0) ? rand->GetInteger (1, code.GetDataSize ()) : code.GetDataSize ();
+      for(uint32_t i = 0; i < len; i++) codeword[i] = rand->GetInteger (0, 255);
+      code.Encode (codeword, len, codeword + len);
+
+      uint32_t size = len + code.GetParitySize ();
+      memcpy (original, codeword, size);
+      for(uint32_t e = 0; e < t; e++) codeword[rand->GetInteger (0, size - 1)] ^= rand->GetInteger (1, 255);
+
+      int32_t corrected = code.Decode (codeword, size);
+      NS_ABORT_MSG_IF ((corrected < 0 || memcmp (codeword, original, size) != 0), "One codeword with t errors is not corrected!!!");
+    }
+
+
+    std::vector<uint8_t> frame (frameSize);
+    for(uint32_t i = 0; i < frameSize; i++) frame[i] = rand->GetInteger (0, 255);
+    std::vector<uint8_t> codewords, received;
+    std::vector<uint32_t> lostBlocks;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+    for(uint32_t i = 0; i < nFrames; i++) code.EncodeBlocks (&frame[0], frameSize, codewords);
+    double encodeNs = ElapsedNs (start) / nFrames;
+
+    received = codewords;
+    start = std::chrono::steady_clock::now ();
+    for(uint32_t i = 0; i < nFrames; i++) code.DecodeBlocks (&received[0], &codewords[0], frameSize, lostBlocks);
+    double decodeNs = ElapsedNs (start) / nFrames;
+    NS_ABORT_MSG_IF ((!lostBlocks.empty ()), "Error-free codewords are reported as damaged!!!");
+
+    std::cout << "RS(248," << dataSizes[c] << "): " << nTrials << " codewords with " << t << " errors corrected" << std::endl;
+    std::cout << "  encoding: " << encodeNs << " ns per frame of " << frameSize << " bytes (" 
+              << (frameSize * 8.0 / encodeNs) << " Gbps)" << std::endl;
+    std::cout << "  decoding: " << decodeNs << " ns per frame of " << frameSize << " bytes (" 
+              << (frameSize * 8.0 / decodeNs) << " Gbps)" << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,267 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c)  2012 The Provost, Fellows and Scholars of the
+ * College of the Holy and Undivided Trinity of Queen Elizabeth near Dublin.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jerome Arokkiam <jerome.arokkiam@bt.com>
+ */
+
+/**********************************************************************
+* ARCHITECTURE (distributed through MPI):
+*
+*  |<----------------- rank 0 ----------------->|<-- rank 1 + (i % (N-1)) -->|
+*
+*  [SERVER]----[ROUTER]---[OLT]-------------------[ONU i]------[EDGE i]____[USER]
+*            |                    |
+*  [SERVER]__|                    |___[ONU j]------[EDGE j]____[USER]
+*
+* The OLT (with the core/metro nodes) is simulated by rank 0 and the ONUs (with their edge/user nodes)
+* are spread over the other ranks. Only the XG-PON channel crosses the ranks.
+*
+* Run with (ns-3 built with --enable-mpi):
+*   mpirun -np 3 ./ns3 run "xpon-mpi-DS-US --nOnus=8"
+* With one rank, the same topology is simulated sequentially and can be used as the reference.
+*
+* Limitations: packet tags (e.g., the ones used by flow monitor) are not carried across ranks, so the
+* statistics based on them only cover the traffic that stays in one rank. This path has not been run
+* under mpirun in the test suite; compare its results with the one-rank run before relying on them.
+**************************************************************/
+
+#include <iostream>
+#include <string>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/mpi-interface.h"
+
+#include "ns3/xgpon-helper.h"
+#include "ns3/xgpon-config-db.h"
+
+#include "ns3/xgpon-channel.h"
+#include "ns3/xgpon-onu-net-device.h"
+#include "ns3/xgpon-olt-net-device.h"
+
+
+#define APP_STOP 2
+#define SIM_STOP APP_STOP +0.5
+
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("xpon-mpi-DS-US");
+
+
+int
+main (int argc, char *argv[])
+{
+  uint16_t nOnus = 8;                  //number of ONUs to be used in the XGPON
+  std::string pon_mode = "XGSPON";
+  std::string per_app_rate = "100Mbps";
+  bool nullmsg = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("nOnus", "Number of ONUs in the XG(S)PON (default 8)", nOnus);
+  cmd.AddValue ("pon-mode", "Select the PON technology to be used in the simualtion [XGPON, XGSPON] (default XGSPON)", pon_mode);
+  cmd.AddValue ("app-rate", "Datarate of each (upstream and downstream) application traffic source (default 100Mbps)", per_app_rate);
+  cmd.AddValue ("nullmsg", "Use the null message synchronization instead of the granted time window (default false)", nullmsg);
+  cmd.Parse (argc, argv);
+
+  //////////////////////////////////////////ENABLE THE DISTRIBUTED SIMULATOR
+  if(nullmsg) { GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::NullMessageSimulatorImpl")); }
+  else { GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::DistributedSimulatorImpl")); }
+  MpiInterface::Enable (&argc, &argv);
+
+  uint32_t systemId = MpiInterface::GetSystemId ();
+  uint32_t systemCount = MpiInterface::GetSize ();
+  std::cout << "rank " << systemId << " of " << systemCount << std::endl;
+
+  //the rank that simulates ONU i (and its edge/user nodes)
+  std::vector<uint32_t> onuSystemIds (nOnus);
+  for(uint16_t i = 0; i < nOnus; i++) { onuSystemIds[i] = (systemCount > 1) ? 1 + (i % (systemCount - 1)) : 0; }
+
+
+  //////////////////////////////////////////////////////////////////////////CONFIGURATIONS FOR XGPON HELPER
+  XgponHelper xgponHelper;
+  XgponConfigDb& xgponConfigDb = xgponHelper.GetConfigDb ( );
+
+  xgponConfigDb.SetPonMode (pon_mode);
+  xgponConfigDb.SetOltNetmaskLen (8);
+  xgponConfigDb.SetOnuNetmaskLen (24);
+  xgponConfigDb.SetIpAddressFirstByteForXgpon (10);
+  xgponConfigDb.SetIpAddressFirstByteForOnus (173);
+  xgponConfigDb.SetAllocateIds4Speed (true);
+  xgponConfigDb.SetOltDbaEngineTypeIdStr ("ns3::XgponOltDbaEngineRoundRobin");
+  xgponHelper.InitializeObjectFactories ( );
+
+
+  //////////////////////////////////////////CREATE THE NODES (EACH NODE IS OWNED BY ONE RANK; ALL RANKS HOLD THE WHOLE TOPOLOGY)
+  NodeContainer oltNode, routerNode, serverNodes, onuNodes, edgeNodes, userNodes;
+  oltNode.Create (1, 0);
+  routerNode.Create (1, 0);
+  serverNodes.Create (nOnus, 0);
+  for(uint16_t i = 0; i < nOnus; i++)
+  {
+    onuNodes.Create (1, onuSystemIds[i]);
+    edgeNodes.Create (1, onuSystemIds[i]);
+    userNodes.Create (1, onuSystemIds[i]);
+  }
+
+  NodeContainer xgponNodes;
+  xgponNodes.Add (oltNode.Get(0));
+  for(int i=0; i<nOnus; i++) { xgponNodes.Add (onuNodes.Get(i)); }
+
+  //0: olt; i (>0): onu
+  NetDeviceContainer xgponDevices = xgponHelper.Install (xgponNodes);
+
+  //let the channel exchange frames with the other ranks. It is called after all ONUs are attached and their delays are set.
+  Ptr<XgponOltNetDevice> oltDevice = DynamicCast<XgponOltNetDevice, NetDevice> (xgponDevices.Get(0));
+  Ptr<XgponChannel> channel = DynamicCast<XgponChannel, Channel> (oltDevice->GetChannel ( ));
+  if(systemCount > 1) { channel->EnableDistributedSimulation ( ); }
+
+
+  //////////////////////////////////////////SETTING UP OTHER P2P LINKS IN THE NETWORK (NONE OF THEM CROSSES THE RANKS)
+  InternetStackHelper stack;
+  stack.Install (xgponNodes);
+  stack.Install (routerNode);
+  stack.Install (serverNodes);
+  stack.Install (edgeNodes);
+  stack.Install (userNodes);
+
+  PointToPointHelper pointToPoint;
+  pointToPoint.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("40Gbps"));
+
+  NetDeviceContainer metroDevices = pointToPoint.Install (routerNode.Get(0), oltNode.Get(0));
+  std::vector<NetDeviceContainer> coreDevices (nOnus), lastMileDevices (nOnus), edgeDevices (nOnus);
+  for(int i=0; i<nOnus; i++)
+  {
+    coreDevices[i] = pointToPoint.Install (serverNodes.Get(i), routerNode.Get(0));
+    lastMileDevices[i] = pointToPoint.Install (edgeNodes.Get(i), onuNodes.Get(i));
+    edgeDevices[i] = pointToPoint.Install (userNodes.Get(i), edgeNodes.Get(i));
+  }
+
+
+  /////////////////////////////////////////////////////ASSIGN IP ADDRESSES
+  Ipv4AddressHelper addressHelper;
+  std::string xgponIpbase = xgponHelper.GetXgponIpAddressBase ( );
+  std::string xgponNetmask = xgponHelper.GetOltAddressNetmask();
+  addressHelper.SetBase (xgponIpbase.c_str(), xgponNetmask.c_str());
+  Ipv4InterfaceContainer xgponInterfaces = addressHelper.Assign (xgponDevices);
+  for(int i=0; i<(nOnus+1);i++)
+  {
+    Ptr<XgponNetDevice> tmpDevice = DynamicCast<XgponNetDevice, NetDevice> (xgponDevices.Get(i));
+    tmpDevice->SetAddress (xgponInterfaces.GetAddress(i));
+  }
+
+  addressHelper.SetBase ("172.0.0.0", "255.255.255.0");
+  addressHelper.Assign (metroDevices);
+
+  std::vector<Ipv4InterfaceContainer> coreInterfaces (nOnus), lastMileInterfaces (nOnus), edgeInterfaces (nOnus);
+  for(int i=0; i<nOnus; i++)
+  {
+    std::string ipBaseCore = "171.0." + std::to_string(i) + ".0";
+    addressHelper.SetBase (ipBaseCore.c_str(), "255.255.255.0");
+    coreInterfaces[i] = addressHelper.Assign (coreDevices[i]);
+
+    std::string ipBaseEdge = "174.0." + std::to_string(i) + ".0";
+    addressHelper.SetBase (ipBaseEdge.c_str(), "255.255.255.0");
+    edgeInterfaces[i] = addressHelper.Assign (edgeDevices[i]);
+
+    Ptr<XgponOnuNetDevice> onuDevice = DynamicCast<XgponOnuNetDevice, NetDevice> (xgponDevices.Get(i+1));
+    std::string onuIpbase = xgponHelper.GetOnuIpAddressBase (onuDevice);
+    std::string onuNetmask = xgponHelper.GetOnuAddressNetmask();
+    addressHelper.SetBase (onuIpbase.c_str(), onuNetmask.c_str());
+    lastMileInterfaces[i] = addressHelper.Assign (lastMileDevices[i]);
+  }
+
+
+  //////////////////////////////////////////////CONFIGURE THE XGPON CONNECTIONS (ONE T-CONT AND ONE DOWNSTREAM CONNECTION PER ONU)
+  for(int i=0; i< nOnus; i++)
+  {
+    Address addr = lastMileInterfaces[i].GetAddress(1); //address of the ONU
+    Ptr<XgponOnuNetDevice> onuDevice = DynamicCast<XgponOnuNetDevice, NetDevice> (xgponDevices.Get(i+1));
+
+    xgponHelper.AddOneDownstreamConnectionForOnu (onuDevice, oltDevice, addr);
+    uint16_t allocId = xgponHelper.AddOneTcontForOnu (onuDevice, oltDevice, XgponQosParameters::XGPON_TCONT_TYPE_1);
+    xgponHelper.AddOneUpstreamConnectionForOnu (onuDevice, oltDevice, allocId, addr);
+  }
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+
+  ////////////////////////////////////////////////////CONFIGURE APPLICATION TRAFFIC (ONLY ON THE NODES OWNED BY THIS RANK)
+  uint16_t dsPort = 9000, usPort = 9001;
+  for (int i=0; i<nOnus; i++)
+  {
+    Address userAddr = InetSocketAddress (edgeInterfaces[i].GetAddress(0), dsPort);
+    Address serverAddr = InetSocketAddress (coreInterfaces[i].GetAddress(0), usPort);
+
+    OnOffHelper onOff ("ns3::UdpSocketFactory", Address ());
+    onOff.SetAttribute ("OnTime",  StringValue ("ns3::ConstantRandomVariable[Constant=1]"));
+    onOff.SetAttribute ("OffTime",  StringValue ("ns3::ConstantRandomVariable[Constant=0]"));
+    onOff.SetAttribute ("DataRate", StringValue (per_app_rate));
+    onOff.SetAttribute ("PacketSize", UintegerValue (1400));
+
+    if(systemId == 0)
+    {
+      //downstream source and upstream sink
+      onOff.SetAttribute ("Remote", AddressValue (userAddr));
+      ApplicationContainer sourceApp = onOff.Install (serverNodes.Get(i));
+      sourceApp.Start (Seconds (0.5 + 0.001*i));
+      sourceApp.Stop (Seconds (APP_STOP));
+
+      PacketSinkHelper sink ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), usPort));
+      ApplicationContainer sinkApp = sink.Install (serverNodes.Get(i));
+      sinkApp.Start (Seconds (0.05));
+      sinkApp.Stop (Seconds (SIM_STOP));
+    }
+    if(systemId == onuSystemIds[i])
+    {
+      //upstream source and downstream sink
+      onOff.SetAttribute ("Remote", AddressValue (serverAddr));
+      ApplicationContainer sourceApp = onOff.Install (userNodes.Get(i));
+      sourceApp.Start (Seconds (0.5 + 0.001*i));
+      sourceApp.Stop (Seconds (APP_STOP));
+
+      PacketSinkHelper sink ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), dsPort));
+      ApplicationContainer sinkApp = sink.Install (userNodes.Get(i));
+      sinkApp.Start (Seconds (0.05));
+      sinkApp.Stop (Seconds (SIM_STOP));
+    }
+  }
+
+
+  Simulator::Stop (Seconds (SIM_STOP));
+  Simulator::Run ();
+
+  //the received bytes of the sinks owned by this rank
+  for (int i=0; i<nOnus; i++)
+  {
+    Ptr<Node> node = (systemId == 0) ? serverNodes.Get(i) : userNodes.Get(i);
+    if(node->GetSystemId () != systemId) continue;
+
+    Ptr<PacketSink> sink = DynamicCast<PacketSink> (node->GetApplication (1));
+    std::cout << "rank," << systemId << ",onu," << i << "," << ((systemId == 0) ? "upstream" : "downstream")
+              << ",received," << sink->GetTotalRx () << ",Bytes" << std::endl;
+  }
+
+  Simulator::Destroy ();
+  MpiInterface::Disable ();
+  return 0;
+}
@@ -58,6 +58,7 @@
 
 #include "xgpon-helper.h"
 #include "ns3/uinteger.h"
+#include "ns3/random-variable-stream.h"
 
 NS_LOG_COMPONENT_DEFINE("XgponHelper");
 
@@ -147,11 +148,34 @@ XgponHelper::SetQosParametersAttribute (std::string n1, const AttributeValue &v1
   m_qosParametersFactory.Set (n1, v1);
 }
 
+void 
+XgponHelper::SetOnuBitErrorRate (Ptr<XgponOnuNetDevice> onuDevice, double ber)
+{
+  //the ONU uses its XgponLinkInfo for the downstream; the OLT uses its own copy (made by AddOnuToOlt) for the upstream.
+  (onuDevice->GetPloamEngine ()->GetLinkInfo ())->SetBitErrorRate (ber);
+
+  Ptr<XgponChannel> channel = DynamicCast<XgponChannel, Channel> (onuDevice->GetChannel ());
+  NS_ASSERT_MSG((channel != nullptr), "The ONU has not been attached to one XG-PON channel!!!");
+  Ptr<XgponOltNetDevice> oltDevice = DynamicCast<XgponOltNetDevice, PonNetDevice> (channel->GetOlt ());
+  (oltDevice->GetPloamEngine ()->GetLinkInfo (onuDevice->GetOnuId ()))->SetBitErrorRate (ber);
+}
+
 
 
 
 
 NetDeviceContainer XgponHelper::Install (NodeContainer nodes)
+{
+  NetDeviceContainer deviceContainer = CreateDevices (nodes.GetN() - 1);
+
+  //the first node acts as the OLT
+  for(uint32_t i=0; i<nodes.GetN(); i++) nodes.Get(i)->AddDevice(deviceContainer.Get(i));
+
+  return deviceContainer;
+}
+
+
+NetDeviceContainer XgponHelper::CreateDevices (uint16_t nOnus)
 {
   NetDeviceContainer deviceContainer;
 
@@ -159,18 +183,16 @@ NetDeviceContainer XgponHelper::Install (NodeContainer nodes)
   Ptr<XgponChannel> xgponChannel = CreateXgponChannel ( );
 
   
-  //Create olt device and add it to the node and channel
+  //Create olt device and add it to the channel
   Ptr<XgponOltNetDevice> oltDevice = CreateXgponOltNetDeviceAndEngines ( );
-  nodes.Get(0)->AddDevice(oltDevice); 
   AttachOltToPonChannel (xgponChannel, oltDevice);
 
   deviceContainer.Add (oltDevice);
   
-  //Create onu devices and add them to nodes and channel.
-  for(uint32_t i=1; i<nodes.GetN(); i++)
+  //Create onu devices and add them to the channel.
+  for(uint16_t i=0; i<nOnus; i++)
   {
     Ptr<XgponOnuNetDevice> onuDevice = CreateXgponOnuNetDeviceAndEngines ( );
-    nodes.Get(i)->AddDevice(onuDevice);
 
     AttachOnuToPonChannel (xgponChannel, onuDevice);
     AddOnuToOlt (onuDevice, oltDevice);
@@ -318,6 +340,19 @@ XgponHelper::AddOneDownstreamConnectionForOnu (Ptr<XgponOnuNetDevice> onuDevice,
   return portId;
 }
 
+uint16_t 
+XgponHelper::AddOneClassDownstreamConnectionForOnu (Ptr<XgponOnuNetDevice> onuDevice, Ptr<XgponOltNetDevice> oltDevice, const Address& addr, uint8_t trafficClass)
+{
+  NS_ASSERT_MSG((trafficClass > 0), "Traffic class 0 is carried by the default downstream xgem-port!!!");
+
+  uint16_t onuId = onuDevice->GetOnuId ( );
+  uint16_t portId = m_idAllocator->GetOneNewDownstreamPortId (onuId, addr);
+
+  AddOneDownstreamConnectionForOnu (onuDevice, oltDevice, addr, portId, trafficClass);
+
+  return portId;
+}
+
 uint16_t 
 XgponHelper::AddOneBroadcastDownstreamConnection (Ptr<XgponOltNetDevice> oltDevice, const Address& addr)
 {
@@ -335,6 +370,7 @@ XgponHelper::AddOneBroadcastDownstreamConnection (Ptr<XgponOltNetDevice> oltDevi
   connSender->SetXgemPort (portId);
   connSender->SetUpperLayerAddr (addr);
   connSender->SetXgponQueue (txQueue);
+  connSender->SetQosParameters (qosParameters);
 
   oltDevice->SetQosParameters(qosParameters); //jerome
   Ptr<XgponOltConnManager> connManager = oltDevice->GetConnManager ( );
@@ -601,6 +637,17 @@ XgponHelper::CreateXgponOnuNetDeviceAndEngines (void)
 
   Ptr<XgponKey> key1 = CreateObject<XgponKey>();
   Ptr<XgponKey> key2 = CreateObject<XgponKey>();
+  //random per-ONU keys, only drawn when XGEM payloads are encrypted: the random variable takes one stream,
+  //which would shift the streams of the random variables created later when encryption is disabled.
+  if(XgponAesCtr::IsEnabled ())
+  {
+    Ptr<UniformRandomVariable> keyRng = CreateObject<UniformRandomVariable> ();
+    uint8_t keyData[XgponAesCtr::XGPON_AES_KEY_SIZE];
+    for(uint32_t i = 0; i < XgponAesCtr::XGPON_AES_KEY_SIZE; i++) { keyData[i] = keyRng->GetInteger (0, 255); }
+    key1->SetKeyData (keyData);
+    for(uint32_t i = 0; i < XgponAesCtr::XGPON_AES_KEY_SIZE; i++) { keyData[i] = keyRng->GetInteger (0, 255); }
+    key2->SetKeyData (keyData);
+  }
   linkInfo->AddNewDsKey (key1, 0);
   linkInfo->AddNewUsKey (key2, 0);  
   linkInfo->SetCurrentDsKeyIndex (0);
@@ -768,7 +815,7 @@ XgponHelper::AddOneUpstreamConnectionForOnu (Ptr<XgponOnuNetDevice> onuDevice, P
 }
 
 void
-XgponHelper::AddOneDownstreamConnectionForOnu (Ptr<XgponOnuNetDevice> onuDevice, Ptr<XgponOltNetDevice> oltDevice, const Address& addr, uint16_t portId)
+XgponHelper::AddOneDownstreamConnectionForOnu (Ptr<XgponOnuNetDevice> onuDevice, Ptr<XgponOltNetDevice> oltDevice, const Address& addr, uint16_t portId, uint8_t trafficClass)
 {
   uint16_t onuId = onuDevice->GetOnuId ( );
 
@@ -787,9 +834,12 @@ XgponHelper::AddOneDownstreamConnectionForOnu (Ptr<XgponOnuNetDevice> onuDevice,
   connSender->SetOnuId (onuId);
   connSender->SetUpperLayerAddr (addr);
   connSender->SetXgponQueue (txQueue);
+  connSender->SetQosParameters (qosParameters);
+  connSender->SetTrafficClass (trafficClass);
 
   Ptr<XgponOltConnManager> connManager = oltDevice->GetConnManager ( );
   connManager->AddOneDsConn (connSender, false, onuId);
+  if(trafficClass > 0) connManager->AddOneDsClassConn (connSender);
 
   Ptr<XgponOltDsScheduler> dsScheduler = oltDevice->GetDsScheduler ( );
   dsScheduler->AddConnToScheduler (connSender);
@@ -83,6 +83,14 @@ public:
    */
   NetDeviceContainer Install (NodeContainer nodes);
 
+  /**
+   * \brief create the xgpon network devices (and the channel) without installing them on nodes.
+   *        These devices are never started. They are used to drive one engine directly (e.g., benchmarking DBA engines offline).
+   * \return the container that holds the xgpon network devices. The first one is XgponOltNetDevice.
+   * \param nOnus the number of ONUs in this Xgpon network
+   */
+  NetDeviceContainer CreateDevices (uint16_t nOnus);
+
 
 
   //produce Ip address netmask based on netmask length.
@@ -108,6 +116,11 @@ public:
   //Set attributes of the per xgem-port qos parameters 
   void SetQosParametersAttribute (std::string n1, const AttributeValue &v1);
 
+  //Set the bit error rate of the link between the OLT and one ONU (e.g., a distant ONU) in both directions. 
+  //It is used by the analytic error model of XgponChannel ("AnalyticErrorModel"); a negative value restores the rate of the channel.
+  //The ONU must have been added to the OLT (CreateDevices or Install).
+  void SetOnuBitErrorRate (Ptr<XgponOnuNetDevice> onuDevice, double ber);
+
 
   ///////////////////////////////////////////////////////////////////////////
   // Before calling the following functions to add alloc-id and xgem port, 
@@ -144,6 +157,18 @@ public:
   uint16_t AddOneDownstreamConnectionForOnu (Ptr<XgponOnuNetDevice> onuDevice, Ptr<XgponOltNetDevice> oltDevice, const Address& addr);
 
 
+  /**
+   * \brief Add one downstream xgem-port that carries only one traffic class (TOS >> 2, i.e., 1-4 as the upstream T-CONT types) for one computer.
+   *        The default downstream xgem-port of this computer must be added before. The flexible ID allocation must be used.
+   * \return ID of the just added xgem-port
+   * \param onuDevice the ONU that this computer is connected
+   * \param oltDevice the OLT
+   * \param addr IP address of this computer
+   * \param trafficClass the traffic class carried by this xgem-port (larger than 0)
+   */
+  uint16_t AddOneClassDownstreamConnectionForOnu (Ptr<XgponOnuNetDevice> onuDevice, Ptr<XgponOltNetDevice> oltDevice, const Address& addr, uint8_t trafficClass);
+
+
   /**
    * \brief Add one broadcast downstream xgem-port between the OLT and all ONUs. 
    *        Note that broadcast connections must be added after all onus have been added to the network.
@@ -228,8 +253,8 @@ private:
   //add one upstream xgem-port for the computer that connects to one ONU. allocId is from previous call for adding T-CONT and portId is from XgponIdAllocator.
   void AddOneUpstreamConnectionForOnu (Ptr<XgponOnuNetDevice> onuDevice, Ptr<XgponOltNetDevice> oltDevice, uint16_t allocId, const Address& addr, uint16_t portId);
 
-  //add one downstream xgem-port for the computer that connects to one ONU. portId is from XgponIdAllocator.
-  void AddOneDownstreamConnectionForOnu (Ptr<XgponOnuNetDevice> onuDevice, Ptr<XgponOltNetDevice> oltDevice, const Address& addr, uint16_t portId);  
+  //add one downstream xgem-port for the computer that connects to one ONU. portId is from XgponIdAllocator. trafficClass 0: the default xgem-port
+  void AddOneDownstreamConnectionForOnu (Ptr<XgponOnuNetDevice> onuDevice, Ptr<XgponOltNetDevice> oltDevice, const Address& addr, uint16_t portId, uint8_t trafficClass = 0);  
 
 
 private:
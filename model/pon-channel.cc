@@ -19,8 +19,12 @@
  * Author: Pedro Alvarez <pinheirp@tcd.ie>
  */
 
+#include <map>
+
 #include "ns3/simulator.h"
 #include "ns3/log.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
 
 #include "pon-channel.h"
 
@@ -36,6 +40,21 @@ PonChannel::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::PonChannel")
     .SetParent<Channel> ()
+    .AddAttribute ("BatchedDownstream", 
+                   "Whether one downstream frame is passed to ONUs through one simulator event per group of ONUs with the same propagation delay (true) or through one event per ONU (false). In batched mode, the ONUs of one group are served under the context (node id) of the first ONU in the group.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PonChannel::m_batchedDsDelivery),
+                   MakeBooleanChecker ())
+    .AddAttribute ("DsDelayGranularity", 
+                   "Used in batched downstream mode. ONUs whose propagation delays fall into the same bucket of this size (unit: nanosecond) are grouped together and receive the frame at the smallest delay of the group. 1 keeps the exact delays; a value larger than the maximal delay gives one equalized arrival time for all ONUs.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&PonChannel::m_dsDelayGranularity),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("DsDeliveryFilter", 
+                   "Whether one downstream frame is only passed to the ONUs that have something (unicast data, grant, PLOAM or broadcast content) in it.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PonChannel::m_dsDeliveryFilter),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -46,7 +65,9 @@ PonChannel::GetInstanceTypeId (void) const
 }
 
 
-PonChannel::PonChannel () : Channel(),  m_oltDevice(0)
+PonChannel::PonChannel () : Channel(),  m_oltDevice(0), 
+  m_batchedDsDelivery(false), m_dsDelayGranularity(1), m_dsGroupsValid(false), 
+  m_dsDeliveryFilter(false), m_remoteDelivery(false)
 {
 }
 PonChannel::~PonChannel ()
@@ -61,9 +82,14 @@ PonChannel::SendUpstream (const Ptr<PonFrame>& frame, uint16_t index)
 {
   NS_LOG_INFO ("Schedule to Send One Upstream Burst to the OLT"); 
 
-  uint32_t delay = GetOnuPropagationDelay(index);
-
   const Ptr<PonNetDevice>& oltDevice = GetOlt();
+  if(m_remoteDelivery && IsRemoteDevice(oltDevice))
+  {
+    SendUpstreamToRemoteOlt (frame, index);
+    return;
+  }
+
+  uint32_t delay = GetOnuPropagationDelay(index);
   Simulator::ScheduleWithContext (oltDevice->GetNode ()->GetId (), NanoSeconds (delay), &PonNetDevice::ReceivePonFrameFromChannel, oltDevice, frame);
 
 }
@@ -74,15 +100,137 @@ PonChannel::SendDownstream (const Ptr<PonFrame>& frame)
 {
   NS_LOG_INFO ("Schedule to Send One Downstream Frame to all ONUs");
 
+  if(m_batchedDsDelivery)
+  {
+    if(!m_dsGroupsValid) { BuildDsDeliveryGroups ( ); }
+
+    ScheduleDownstreamToGroups (frame, 0);
+  }
+  else
+  {
+    for (int i = 0; i < GetNOnuDevices(); i++)
+    {
+      uint32_t delay = GetOnuPropagationDelay(i);
+
+      const Ptr<PonNetDevice>& onuDevice = GetOnuByIndex(i);   
+      if(m_remoteDelivery && IsRemoteDevice(onuDevice)) continue;
+      if(m_dsDeliveryFilter && !onuDevice->IsDownstreamFrameRequired(frame)) continue;
+
+      Simulator::ScheduleWithContext (onuDevice->GetNode ()->GetId (), NanoSeconds (delay), &PonNetDevice::ReceivePonFrameFromChannel, onuDevice, frame);
+    }
+  }
+
+  if(m_remoteDelivery) { SendDownstreamToRemoteOnus (frame); }
+}
+
+
+void
+PonChannel::DeliverDownstreamFromRemote (const Ptr<PonFrame>& frame, uint32_t elapsedDelay)
+{
+  NS_LOG_INFO ("Schedule to Send One Downstream Frame (from another rank) to local ONUs");
+
+  if(m_batchedDsDelivery)
+  {
+    //the groups only hold the local ONUs, since remote delivery is enabled on this rank.
+    if(!m_dsGroupsValid) { BuildDsDeliveryGroups ( ); }
+    ScheduleDownstreamToGroups (frame, elapsedDelay);
+    return;
+  }
+
   for (int i = 0; i < GetNOnuDevices(); i++)
   {
+    const Ptr<PonNetDevice>& onuDevice = GetOnuByIndex(i);   
+    if(IsRemoteDevice(onuDevice)) continue;
+    if(m_dsDeliveryFilter && !onuDevice->IsDownstreamFrameRequired(frame)) continue;
+
     uint32_t delay = GetOnuPropagationDelay(i);
+    NS_ASSERT_MSG((delay >= elapsedDelay), "The downstream frame reaches this rank later than one of its ONUs!!!");
 
-    const Ptr<PonNetDevice>& onuDevice = GetOnuByIndex(i);   
-    Simulator::ScheduleWithContext (onuDevice->GetNode ()->GetId (), NanoSeconds (delay), &PonNetDevice::ReceivePonFrameFromChannel, onuDevice, frame);
+    Simulator::ScheduleWithContext (onuDevice->GetNode ()->GetId (), NanoSeconds (delay - elapsedDelay), &PonNetDevice::ReceivePonFrameFromChannel, onuDevice, frame);
+  }
+}
+
+
+bool
+PonChannel::IsRemoteDevice (const Ptr<PonNetDevice>& device) const
+{
+  return device->GetNode ()->GetSystemId () != Simulator::GetSystemId ();
+}
+
+
+void
+PonChannel::SendDownstreamToRemoteOnus (const Ptr<PonFrame>& frame)
+{
+  NS_FATAL_ERROR ("This channel does not support distributed simulation!!!");
+}
+
+void
+PonChannel::SendUpstreamToRemoteOlt (const Ptr<PonFrame>& frame, uint16_t index)
+{
+  NS_FATAL_ERROR ("This channel does not support distributed simulation!!!");
+}
+
+
+void
+PonChannel::ScheduleDownstreamToGroups (const Ptr<PonFrame>& frame, uint32_t elapsedDelay)
+{
+  //one event per group. The context is the node of the first ONU in the group: the simulator cannot change it within one event,
+  //so Simulator::GetContext () (e.g., in log prefixes) gives this node for all ONUs of the group. Disable batching if it matters.
+  for (uint32_t i = 0; i < m_dsGroups.size(); i++)
+  {
+    const Ptr<DsDeliveryGroup>& group = m_dsGroups[i];
+    NS_ASSERT_MSG((group->m_delay >= elapsedDelay), "The downstream frame reaches this rank later than one of its ONUs!!!");
+
+    const Ptr<PonNetDevice>& firstDevice = GetOnuByIndex(group->m_onuIndexes[0]);
+    Simulator::ScheduleWithContext (firstDevice->GetNode ()->GetId (), NanoSeconds (group->m_delay - elapsedDelay), &PonChannel::DeliverDownstreamToGroup, this, frame, group);
   }
 }
 
+void
+PonChannel::DeliverDownstreamToGroup (const Ptr<PonFrame>& frame, const Ptr<DsDeliveryGroup>& group)
+{
+  const std::vector<uint16_t>& onuIndexes = group->m_onuIndexes;
+  for (uint32_t i = 0; i < onuIndexes.size(); i++)
+  {
+    const Ptr<PonNetDevice>& onuDevice = GetOnuByIndex(onuIndexes[i]);
+    if(m_dsDeliveryFilter && !onuDevice->IsDownstreamFrameRequired(frame)) continue;
+
+    onuDevice->ReceivePonFrameFromChannel (frame);
+  }
+}
+
+
+void
+PonChannel::BuildDsDeliveryGroups (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  //key: delay bucket; ONUs are visited in index order, so that each group is sorted too.
+  std::map<uint32_t, Ptr<DsDeliveryGroup> > buckets;
+  for (uint16_t i = 0; i < GetNOnuDevices(); i++)
+  {
+    //ONUs simulated by other ranks are served through SendDownstreamToRemoteOnus.
+    if(m_remoteDelivery && IsRemoteDevice(GetOnuByIndex(i))) continue;
+
+    uint32_t delay = GetOnuPropagationDelay(i);
+    Ptr<DsDeliveryGroup>& group = buckets[delay / m_dsDelayGranularity];
+
+    if(group == nullptr) { group = Create<DsDeliveryGroup> (); group->m_delay = delay; }
+    else if(delay < group->m_delay) { group->m_delay = delay; }
+    group->m_onuIndexes.push_back(i);
+  }
+
+  //new groups are created: the events already scheduled keep the old ones.
+  m_dsGroups.clear();
+  for (std::map<uint32_t, Ptr<DsDeliveryGroup> >::iterator it = buckets.begin(); it != buckets.end(); it++)
+  {
+    m_dsGroups.push_back(it->second);
+  }
+  m_dsGroupsValid = true;
+
+  NS_LOG_INFO ("Downstream delivery: " << GetNOnuDevices() << " ONUs in " << m_dsGroups.size() << " delay groups");
+}
+
 
 
 
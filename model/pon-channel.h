@@ -21,7 +21,10 @@
 #ifndef PON_CHANNEL_H
 #define PON_CHANNEL_H
 
+#include <vector>
+
 #include <ns3/ptr.h>
+#include "ns3/simple-ref-count.h"
 #include "ns3/channel.h"
 
 #include "pon-net-device.h"
@@ -62,12 +65,35 @@ public:
   void SendUpstream (const Ptr<PonFrame>& frame, uint16_t index);
 
   /**
-   * \brief send the downstream frame from OLT to all ONUs
+   * \brief send the downstream frame from OLT to all ONUs (or only to those that need it when the delivery filter is enabled)
    * \param frame the frame to be transfered from the OLT to all ONUs.
    */
   void SendDownstream (const Ptr<PonFrame>& frame);
 
 
+  /**
+   * \brief drop the cached delay groups used by the batched downstream delivery.
+   *        Subclasses must call it whenever an ONU is added or its propagation delay is changed.
+   */
+  void InvalidateDsDeliveryGroups (void);
+
+  /**
+   * \brief whether ONUs that have nothing in one downstream frame are skipped (attribute "DsDeliveryFilter").
+   */
+  bool IsDsDeliveryFilterEnabled (void) const;
+
+
+  /**
+   * \brief pass one downstream frame, received from the simulator instance (MPI rank) that simulates the OLT, 
+   *        to the ONUs simulated locally. It is called when the frame reaches this rank.
+   * \param frame the downstream frame.
+   * \param elapsedDelay the propagation delay (unit: nanosecond) that has already elapsed when the frame reaches this rank.
+   *                     It must not be larger than the delay of any local ONU.
+   *        Like SendDownstream, it uses one event per delay group when the batched downstream delivery is enabled.
+   */
+  void DeliverDownstreamFromRemote (const Ptr<PonFrame>& frame, uint32_t elapsedDelay);
+
+
 
 
   ///////////////////////////////////////////////////////////////////////////////////Operations related with ONUs. 
@@ -139,8 +165,63 @@ public:
 
 
 protected:
+  /**
+   * \brief used in distributed (MPI) simulations: whether this device is simulated by another simulator instance (rank).
+   */
+  bool IsRemoteDevice (const Ptr<PonNetDevice>& device) const;
+
+  /**
+   * \brief used in distributed simulations: some devices attached to this channel are simulated by other ranks.
+   *        Once enabled, the frames to such devices are passed to the following two functions instead of being scheduled locally.
+   */
+  void SetRemoteDelivery (bool remote);
+
+  /**
+   * \brief send one downstream frame to the ONUs simulated by other ranks. 
+   *        The subclass that supports distributed simulation should override it.
+   */
+  virtual void SendDownstreamToRemoteOnus (const Ptr<PonFrame>& frame);
+
+  /**
+   * \brief send one upstream burst to the OLT simulated by another rank.
+   *        The subclass that supports distributed simulation should override it.
+   */
+  virtual void SendUpstreamToRemoteOlt (const Ptr<PonFrame>& frame, uint16_t index);
+
+
   Ptr<PonNetDevice> m_oltDevice;           //the OLT network device attached to this channel.
 
+
+private:
+  /**
+   * \brief the ONUs that receive one downstream frame at the same time (one simulator event per group).
+   *        The event holds the group itself, so rebuilding the groups does not affect the frames in flight.
+   */
+  struct DsDeliveryGroup : public SimpleRefCount<DsDeliveryGroup>
+  {
+    uint32_t m_delay;                      //the propagation delay used for this group. unit: nanosecond
+    std::vector<uint16_t> m_onuIndexes;    //indexes of the ONUs in this group (ascending order)
+  };
+
+  //group the ONUs according to their propagation delays (quantized by m_dsDelayGranularity)
+  void BuildDsDeliveryGroups (void);
+
+  //schedule one event per group; elapsedDelay (unit: nanosecond) is subtracted from the delay of each group
+  void ScheduleDownstreamToGroups (const Ptr<PonFrame>& frame, uint32_t elapsedDelay);
+
+  //the event scheduled for one group: pass the frame to all ONUs of this group
+  void DeliverDownstreamToGroup (const Ptr<PonFrame>& frame, const Ptr<DsDeliveryGroup>& group);
+
+
+  bool m_batchedDsDelivery;                       //true: one event per delay group; false: one event per ONU.
+  uint32_t m_dsDelayGranularity;                  //unit: nanosecond; ONUs whose delays fall into the same bucket share one group.
+  std::vector<Ptr<DsDeliveryGroup> > m_dsGroups;  //cached delay groups; rebuilt lazily
+  bool m_dsGroupsValid;                           //whether m_dsGroups reflects the current ONUs and delays
+
+  bool m_dsDeliveryFilter;                        //true: ONUs that have nothing in one downstream frame do not receive it.
+
+  bool m_remoteDelivery;                          //true: some devices are simulated by other ranks (distributed simulation).
+
 };
 
 
@@ -161,6 +242,28 @@ PonChannel::GetOlt ( ) const
 
 
 
+inline void
+PonChannel::InvalidateDsDeliveryGroups (void)
+{
+  m_dsGroupsValid = false;
+}
+
+
+inline bool
+PonChannel::IsDsDeliveryFilterEnabled (void) const
+{
+  return m_dsDeliveryFilter;
+}
+
+inline void
+PonChannel::SetRemoteDelivery (bool remote)
+{
+  m_remoteDelivery = remote;
+  InvalidateDsDeliveryGroups ( );
+}
+
+
+
 inline std::size_t //ja:update:ns-3.35 uint32_t changed to std::size_t to match ns3/channel.h
 PonChannel::GetNDevices (void) const
 {
@@ -60,6 +60,14 @@ public:
    */
   virtual void ReceivePonFrameFromChannel (const Ptr<PonFrame>& frame)=0;
 
+  /**
+   * \brief used by the delivery filter of the channel to skip devices that have nothing in one downstream frame.
+   *        The default implementation receives every frame.
+   * \param frame the downstream frame to be delivered.
+   * \return whether this device must receive the frame. 
+   */
+  virtual bool IsDownstreamFrameRequired (const Ptr<PonFrame>& frame) const;
+
 
 
 
@@ -169,6 +177,12 @@ protected:
 
 
 ////////////////////////////////////////////INLINE Functions
+inline bool
+PonNetDevice::IsDownstreamFrameRequired (const Ptr<PonFrame>& frame) const
+{
+  return true;
+}
+
 inline void 
 PonNetDevice::SetChannelIndex (uint16_t index)
 {
@@ -0,0 +1,281 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2012 University College Cork (UCC), Ireland
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jerome Arokkiam <jerome.arokkia@bt.com>
+ */
+
+#include <cstring>
+
+#include "ns3/global-value.h"
+#include "ns3/boolean.h"
+
+#if defined(__AES__)
+#include <wmmintrin.h>
+#endif
+
+#include "xgpon-aes-ctr.h"
+
+
+
+namespace ns3 {
+
+static GlobalValue g_xgponEncryptionEnabled ("XgponEncryptionEnabled",
+                                             "Whether the payloads of XGEM frames are encrypted with AES-128 in counter mode",
+                                             BooleanValue (false),
+                                             MakeBooleanChecker ());
+
+
+namespace {
+
+uint8_t
+XgponAesXtime (uint8_t x)
+{
+  return (x << 1) ^ ((x & 0x80) ? 0x1B : 0x00);
+}
+
+//the S-box and the combined SubBytes/ShiftRows/MixColumns tables (one column per entry).
+struct XgponAesTables
+{
+  uint8_t m_sbox[256];
+  uint32_t m_te[4][256];
+
+  XgponAesTables ()
+  {
+    //the S-box is derived from the multiplicative inverse in GF(2^8) followed by the affine transformation.
+    uint8_t p = 1, q = 1;
+    do
+    {
+      p = p ^ XgponAesXtime (p);                 //p *= 3
+      q ^= q << 1;                               //q /= 3
+      q ^= q << 2;
+      q ^= q << 4;
+      if(q & 0x80) q ^= 0x09;
+
+      uint8_t x = q ^ (uint8_t) ((q << 1) | (q >> 7)) ^ (uint8_t) ((q << 2) | (q >> 6))
+                    ^ (uint8_t) ((q << 3) | (q >> 5)) ^ (uint8_t) ((q << 4) | (q >> 4));
+      m_sbox[p] = x ^ 0x63;
+    } while(p != 1);
+    m_sbox[0] = 0x63;
+
+    for(uint32_t i = 0; i < 256; i++)
+    {
+      uint8_t s = m_sbox[i];
+      uint8_t s2 = XgponAesXtime (s);
+      uint32_t t = ((uint32_t) s2 << 24) | ((uint32_t) s << 16) | ((uint32_t) s << 8) | (uint32_t) (s2 ^ s);
+      for(int j = 0; j < 4; j++)
+      {
+        m_te[j][i] = t;
+        t = (t >> 8) | (t << 24);
+      }
+    }
+  }
+};
+
+const XgponAesTables g_aesTables;
+
+
+inline uint32_t
+XgponAesLoadU32 (const uint8_t* p)
+{
+  return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | (uint32_t) p[3];
+}
+
+inline void
+XgponAesStoreU32 (uint8_t* p, uint32_t v)
+{
+  p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v;
+}
+
+} // anonymous namespace
+
+
+
+bool
+XgponAesCtr::IsEnabled (void)
+{
+  static bool s_enabled = false;
+  static bool s_initialized = false;
+
+  if(!s_initialized)
+  {
+    BooleanValue value;
+    g_xgponEncryptionEnabled.GetValue (value);
+    s_enabled = value.Get ();
+    s_initialized = true;
+  }
+  return s_enabled;
+}
+
+
+bool
+XgponAesCtr::IsAesNiUsed (void)
+{
+#if defined(__AES__)
+  return true;
+#else
+  return false;
+#endif
+}
+
+
+
+void
+XgponAesCtr::ExpandKey (const uint8_t* key, uint8_t* roundKeys)
+{
+  //the key schedule is run once per key; it is kept simple (one word at a time).
+  const uint8_t* sbox = g_aesTables.m_sbox;
+  uint8_t rcon = 0x01;
+
+  memcpy (roundKeys, key, XGPON_AES_KEY_SIZE);
+  for(uint32_t i = 4; i < XGPON_AES_ROUND_KEYS_SIZE / 4; i++)
+  {
+    uint32_t t = XgponAesLoadU32 (roundKeys + (i - 1) * 4);
+    if(i % 4 == 0)
+    {
+      t = ((uint32_t) sbox[(t >> 16) & 0xFF] << 24) | ((uint32_t) sbox[(t >> 8) & 0xFF] << 16)
+        | ((uint32_t) sbox[t & 0xFF] << 8) | (uint32_t) sbox[t >> 24];
+      t ^= (uint32_t) rcon << 24;
+      rcon = XgponAesXtime (rcon);
+    }
+    XgponAesStoreU32 (roundKeys + i * 4, XgponAesLoadU32 (roundKeys + (i - 4) * 4) ^ t);
+  }
+}
+
+
+
+
+void
+XgponAesCtr::GenerateKeystreamPortable (const uint8_t* roundKeys, uint64_t nonce, uint64_t counter, uint8_t* keystream, uint32_t nBlocks)
+{
+  const uint32_t (*te)[256] = g_aesTables.m_te;
+  const uint8_t* sbox = g_aesTables.m_sbox;
+
+  uint32_t rk[XGPON_AES_ROUND_KEYS_SIZE / 4];
+  for(uint32_t i = 0; i < XGPON_AES_ROUND_KEYS_SIZE / 4; i++) rk[i] = XgponAesLoadU32 (roundKeys + i * 4);
+
+  //the nonce is the same for all blocks: its round-0 words are calculated once.
+  uint32_t n0 = (uint32_t) (nonce >> 32) ^ rk[0];
+  uint32_t n1 = (uint32_t) nonce ^ rk[1];
+
+  for(uint32_t b = 0; b < nBlocks; b++, counter++)
+  {
+    uint32_t s0 = n0, s1 = n1;
+    uint32_t s2 = (uint32_t) (counter >> 32) ^ rk[2];
+    uint32_t s3 = (uint32_t) counter ^ rk[3];
+
+    for(uint32_t r = 1; r < 10; r++)
+    {
+      const uint32_t* k = rk + r * 4;
+      uint32_t t0 = te[0][s0 >> 24] ^ te[1][(s1 >> 16) & 0xFF] ^ te[2][(s2 >> 8) & 0xFF] ^ te[3][s3 & 0xFF] ^ k[0];
+      uint32_t t1 = te[0][s1 >> 24] ^ te[1][(s2 >> 16) & 0xFF] ^ te[2][(s3 >> 8) & 0xFF] ^ te[3][s0 & 0xFF] ^ k[1];
+      uint32_t t2 = te[0][s2 >> 24] ^ te[1][(s3 >> 16) & 0xFF] ^ te[2][(s0 >> 8) & 0xFF] ^ te[3][s1 & 0xFF] ^ k[2];
+      uint32_t t3 = te[0][s3 >> 24] ^ te[1][(s0 >> 16) & 0xFF] ^ te[2][(s1 >> 8) & 0xFF] ^ te[3][s2 & 0xFF] ^ k[3];
+      s0 = t0; s1 = t1; s2 = t2; s3 = t3;
+    }
+
+    //the last round has no MixColumns.
+    const uint32_t* k = rk + 40;
+    uint8_t* out = keystream + b * XGPON_AES_BLOCK_SIZE;
+    XgponAesStoreU32 (out, (((uint32_t) sbox[s0 >> 24] << 24) | ((uint32_t) sbox[(s1 >> 16) & 0xFF] << 16)
+                            | ((uint32_t) sbox[(s2 >> 8) & 0xFF] << 8) | (uint32_t) sbox[s3 & 0xFF]) ^ k[0]);
+    XgponAesStoreU32 (out + 4, (((uint32_t) sbox[s1 >> 24] << 24) | ((uint32_t) sbox[(s2 >> 16) & 0xFF] << 16)
+                                | ((uint32_t) sbox[(s3 >> 8) & 0xFF] << 8) | (uint32_t) sbox[s0 & 0xFF]) ^ k[1]);
+    XgponAesStoreU32 (out + 8, (((uint32_t) sbox[s2 >> 24] << 24) | ((uint32_t) sbox[(s3 >> 16) & 0xFF] << 16)
+                                | ((uint32_t) sbox[(s0 >> 8) & 0xFF] << 8) | (uint32_t) sbox[s1 & 0xFF]) ^ k[2]);
+    XgponAesStoreU32 (out + 12, (((uint32_t) sbox[s3 >> 24] << 24) | ((uint32_t) sbox[(s0 >> 16) & 0xFF] << 16)
+                                 | ((uint32_t) sbox[(s1 >> 8) & 0xFF] << 8) | (uint32_t) sbox[s2 & 0xFF]) ^ k[3]);
+  }
+}
+
+
+void
+XgponAesCtr::GenerateKeystream (const uint8_t* roundKeys, uint64_t nonce, uint64_t counter, uint8_t* keystream, uint32_t nBlocks)
+{
+#if defined(__AES__)
+  __m128i k[11];
+  for(int r = 0; r < 11; r++) k[r] = _mm_loadu_si128 ((const __m128i*) (roundKeys + r * XGPON_AES_BLOCK_SIZE));
+
+  //the bytes of one counter block in memory order, loaded as two little-endian 64-bit lanes.
+  long long lo = (long long) __builtin_bswap64 (nonce);
+
+  uint32_t b = 0;
+  for(; b + 4 <= nBlocks; b += 4, counter += 4)
+  {
+    __m128i s0 = _mm_xor_si128 (_mm_set_epi64x ((long long) __builtin_bswap64 (counter), lo), k[0]);
+    __m128i s1 = _mm_xor_si128 (_mm_set_epi64x ((long long) __builtin_bswap64 (counter + 1), lo), k[0]);
+    __m128i s2 = _mm_xor_si128 (_mm_set_epi64x ((long long) __builtin_bswap64 (counter + 2), lo), k[0]);
+    __m128i s3 = _mm_xor_si128 (_mm_set_epi64x ((long long) __builtin_bswap64 (counter + 3), lo), k[0]);
+    for(int r = 1; r < 10; r++)
+    {
+      s0 = _mm_aesenc_si128 (s0, k[r]);
+      s1 = _mm_aesenc_si128 (s1, k[r]);
+      s2 = _mm_aesenc_si128 (s2, k[r]);
+      s3 = _mm_aesenc_si128 (s3, k[r]);
+    }
+    uint8_t* out = keystream + b * XGPON_AES_BLOCK_SIZE;
+    _mm_storeu_si128 ((__m128i*) out, _mm_aesenclast_si128 (s0, k[10]));
+    _mm_storeu_si128 ((__m128i*) (out + 16), _mm_aesenclast_si128 (s1, k[10]));
+    _mm_storeu_si128 ((__m128i*) (out + 32), _mm_aesenclast_si128 (s2, k[10]));
+    _mm_storeu_si128 ((__m128i*) (out + 48), _mm_aesenclast_si128 (s3, k[10]));
+  }
+  for(; b < nBlocks; b++, counter++)
+  {
+    __m128i s = _mm_xor_si128 (_mm_set_epi64x ((long long) __builtin_bswap64 (counter), lo), k[0]);
+    for(int r = 1; r < 10; r++) s = _mm_aesenc_si128 (s, k[r]);
+    _mm_storeu_si128 ((__m128i*) (keystream + b * XGPON_AES_BLOCK_SIZE), _mm_aesenclast_si128 (s, k[10]));
+  }
+#else
+  GenerateKeystreamPortable (roundKeys, nonce, counter, keystream, nBlocks);
+#endif
+}
+
+
+
+
+void
+XgponAesCtr::Crypt (const uint8_t* roundKeys, uint64_t nonce, uint64_t counter, uint8_t* data, uint32_t size)
+{
+  uint8_t keystream[XGPON_AES_BATCH_BLOCKS * XGPON_AES_BLOCK_SIZE];
+
+  uint32_t pos = 0;
+  while(pos < size)
+  {
+    uint32_t nBlocks = GetNumberOfBlocks (size - pos);
+    if(nBlocks > XGPON_AES_BATCH_BLOCKS) nBlocks = XGPON_AES_BATCH_BLOCKS;
+    GenerateKeystream (roundKeys, nonce, counter, keystream, nBlocks);
+    counter += nBlocks;
+
+    uint32_t len = nBlocks * XGPON_AES_BLOCK_SIZE;
+    if(len > size - pos) len = size - pos;
+
+    uint32_t i = 0;
+    for(; i + 8 <= len; i += 8)
+    {
+      uint64_t d, k;
+      memcpy (&d, data + pos + i, 8);
+      memcpy (&k, keystream + i, 8);
+      d ^= k;
+      memcpy (data + pos + i, &d, 8);
+    }
+    for(; i < len; i++) data[pos + i] ^= keystream[i];
+
+    pos += len;
+  }
+}
+
+
+}; // namespace ns3
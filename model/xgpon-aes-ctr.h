@@ -0,0 +1,104 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2012 University College Cork (UCC), Ireland
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jerome Arokkiam <jerome.arokkia@bt.com>
+ */
+
+#ifndef XGPON_AES_CTR_H
+#define XGPON_AES_CTR_H
+
+#include <stdint.h>
+
+
+
+namespace ns3 {
+
+/**
+ * \ingroup xgpon
+ * \brief The routines of AES-128 in counter mode, used to encrypt/decrypt the payloads of XGEM frames (ITU-T G.987.3).
+ *
+ * One counter block is the 64-bit nonce followed by the 64-bit counter (both in network byte order).
+ * The XGEM engines use the superframe counter of the downstream frame (or of the frame carrying the BWmap for upstream)
+ * as the nonce and lay the counters of all XGEM frames in one downstream frame (or one upstream allocation) one after another.
+ *
+ * Keystream is generated in batches of XGPON_AES_BATCH_BLOCKS blocks. When the compiler targets AES-NI (__AES__),
+ * four blocks are encrypted in parallel with the AES instructions; otherwise, a portable table-driven implementation is used.
+ * The XGEM engines call Crypt once per XGEM frame, so one batch never spans two XGEM frames.
+ * For simulation speed, XGEM payloads are not encrypted unless the global value "XgponEncryptionEnabled" is true.
+ * It is read once (at the first call of IsEnabled), so it should be configured before the simulation starts.
+ */
+class XgponAesCtr
+{
+public:
+  const static uint32_t XGPON_AES_KEY_SIZE = 16;              //AES-128. unit: byte
+  const static uint32_t XGPON_AES_BLOCK_SIZE = 16;            //unit: byte
+  const static uint32_t XGPON_AES_ROUND_KEYS_SIZE = 176;      //11 round keys. unit: byte
+  const static uint32_t XGPON_AES_BATCH_BLOCKS = 64;          //the number of keystream blocks generated in one batch
+
+  /**
+   * \brief whether the payloads of XGEM frames should be encrypted.
+   */
+  static bool IsEnabled (void);
+
+  /**
+   * \brief whether the AES instructions are used to generate keystream.
+   */
+  static bool IsAesNiUsed (void);
+
+  /**
+   * \brief expand one 128-bit key into the round keys (the first byte of one round key is the first byte of the AES state).
+   */
+  static void ExpandKey (const uint8_t* key, uint8_t* roundKeys);
+
+  /**
+   * \brief generate keystream for nBlocks consecutive counter blocks.
+   * \param roundKeys the expanded key
+   * \param nonce the first 64 bits of the counter blocks
+   * \param counter the last 64 bits of the first counter block
+   * \param keystream the output (nBlocks * 16 bytes)
+   */
+  static void GenerateKeystream (const uint8_t* roundKeys, uint64_t nonce, uint64_t counter, uint8_t* keystream, uint32_t nBlocks);
+
+  /**
+   * \brief generate keystream with the portable implementation. It is used to check the one with AES instructions.
+   */
+  static void GenerateKeystreamPortable (const uint8_t* roundKeys, uint64_t nonce, uint64_t counter, uint8_t* keystream, uint32_t nBlocks);
+
+  /**
+   * \brief encrypt (or decrypt) a byte array in place. The keystream starts from the block (nonce, counter).
+   */
+  static void Crypt (const uint8_t* roundKeys, uint64_t nonce, uint64_t counter, uint8_t* data, uint32_t size);
+
+  /**
+   * \return the number of counter blocks consumed by size bytes.
+   */
+  static uint32_t GetNumberOfBlocks (uint32_t size);
+};
+
+
+
+////////////////////////////////////////////////////INLINE Functions
+inline uint32_t
+XgponAesCtr::GetNumberOfBlocks (uint32_t size)
+{
+  return (size + XGPON_AES_BLOCK_SIZE - 1) / XGPON_AES_BLOCK_SIZE;
+}
+
+
+}; // namespace ns3
+
+#endif // XGPON_AES_CTR_H
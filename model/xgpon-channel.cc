@@ -19,10 +19,16 @@
  * Author: Pedro Alvarez <pinheirp@tcd.ie>
  */
 
+#include <algorithm>
+#include <cmath>
+
 #include "ns3/log.h"
 #include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
 
 #include "xgpon-channel.h"
+#include "xgpon-remote-channel-proxy.h"
 
 
 NS_LOG_COMPONENT_DEFINE ("XgponChannel");
@@ -42,7 +48,21 @@ XgponChannel::GetTypeId (void)
                    UintegerValue (XgponChannel::DEFAULT_LOGIC_ONE_WAY_DELAY),
                    MakeUintegerAccessor (&XgponChannel::m_logicOneWayDelay),
                    MakeUintegerChecker<uint32_t> ())
-
+    .AddAttribute ("BitErrorRate", 
+                   "The average bit error rate of this channel. It is used only when the bytes of frames are simulated (e.g., XgponFecEnabled); 0 means no errors.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&XgponChannel::m_bitErrorRate),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("MeanErrorBurstLength", 
+                   "The mean number of consecutive bits flipped by one error burst (1: independent bit errors).",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&XgponChannel::m_meanErrorBurstLength),
+                   MakeDoubleChecker<double> (1.0))
+    .AddAttribute ("AnalyticErrorModel", 
+                   "Whether the XGEM frames lost after FEC decoding are sampled from the bit error rates (of the channel or the ONUs) instead of simulating the bytes. It is much faster for large simulations.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&XgponChannel::m_analyticErrorModel),
+                   MakeBooleanChecker ())
 
   ;
   return tid;
@@ -54,13 +74,108 @@ XgponChannel::GetInstanceTypeId (void) const
 }
 
 
-XgponChannel::XgponChannel () : PonChannel(), m_onuDevices(0), m_onuPropDelays(0)
+XgponChannel::XgponChannel () : PonChannel(), m_onuDevices(0), m_onuPropDelays(0), m_remoteProxy(0), 
+                                   m_bitErrorRate(0), m_meanErrorBurstLength(1), m_bitsToNextError(-1), 
+                                   m_analyticErrorModel(false)
 {
 }
 XgponChannel::~XgponChannel ()
 {
 }
 
+void
+XgponChannel::DoDispose (void)
+{
+  //break the reference cycle between the channel and the proxy.
+  if(m_remoteProxy != nullptr) { m_remoteProxy->Dispose (); }
+  m_remoteProxy = 0;
+  m_errorRng = 0;
+  PonChannel::DoDispose ();
+}
+
+
+
+
+uint32_t
+XgponChannel::AddBitErrors (uint8_t* data, uint32_t size)
+{
+  if(m_bitErrorRate <= 0) return 0;
+  if(m_errorRng == nullptr) m_errorRng = CreateObject<UniformRandomVariable> ();
+
+  //a burst starts at one bit with the probability BER/L, so that BER of the bits are flipped on average.
+  double startLog = std::log (1.0 - std::min (1.0 - 1e-12, m_bitErrorRate / m_meanErrorBurstLength));
+  double continueLog = std::log (1.0 - 1.0 / m_meanErrorBurstLength);
+
+  uint64_t totalBits = ((uint64_t) size) * 8;
+  uint64_t pos = 0;
+  uint32_t flipped = 0;
+  while(true)
+  {
+    if(m_bitsToNextError < 0) m_bitsToNextError = std::floor (std::log (1.0 - m_errorRng->GetValue ()) / startLog);
+    if(m_bitsToNextError >= (double) (totalBits - pos))
+    {
+      m_bitsToNextError -= (totalBits - pos);
+      return flipped;
+    }
+    pos += (uint64_t) m_bitsToNextError;
+    m_bitsToNextError = -1;
+
+    uint64_t burst = 1;
+    if(m_meanErrorBurstLength > 1) burst += (uint64_t) std::floor (std::log (1.0 - m_errorRng->GetValue ()) / continueLog);
+    uint64_t end = std::min (totalBits, pos + burst);
+    for(; pos < end; pos++, flipped++) data[pos >> 3] ^= (0x80 >> (pos & 7));
+  }
+}
+
+
+
+void
+XgponChannel::SampleLostBlocks (double probability, uint32_t nBlocks, std::vector<uint32_t>& lostBlocks)
+{
+  if(probability <= 0) return;
+  if(m_errorRng == nullptr) m_errorRng = CreateObject<UniformRandomVariable> ();
+
+  if(probability >= 1)
+  {
+    for(uint32_t i = 0; i < nBlocks; i++) lostBlocks.push_back (i);
+    return;
+  }
+
+  double goodLog = std::log1p (-probability);
+  double block = std::floor (std::log (1.0 - m_errorRng->GetValue ()) / goodLog);
+  while(block < nBlocks)
+  {
+    lostBlocks.push_back ((uint32_t) block);
+    block += 1 + std::floor (std::log (1.0 - m_errorRng->GetValue ()) / goodLog);
+  }
+}
+
+
+
+
+void
+XgponChannel::EnableDistributedSimulation (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_remoteProxy = CreateObject<XgponRemoteChannelProxy> ();
+  m_remoteProxy->Setup (this);
+  SetRemoteDelivery (true);
+}
+
+
+void
+XgponChannel::SendDownstreamToRemoteOnus (const Ptr<PonFrame>& frame)
+{
+  m_remoteProxy->SendDownstream (DynamicCast<XgponDsFrame, PonFrame> (frame));
+}
+
+void
+XgponChannel::SendUpstreamToRemoteOlt (const Ptr<PonFrame>& frame, uint16_t index)
+{
+  m_remoteProxy->SendUpstream (DynamicCast<XgponUsBurst, PonFrame> (frame), index);
+}
+
 
 
 
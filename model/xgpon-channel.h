@@ -24,6 +24,8 @@
 
 #include <vector>
 
+#include "ns3/random-variable-stream.h"
+
 #include "pon-channel.h"
 #include "xgpon-phy.h"
 
@@ -31,6 +33,8 @@
 
 namespace ns3 {
 
+class XgponRemoteChannelProxy;
+
 /**
  * \ingroup xgpon
  * \brief A simple XG-PON instance of PON channel.
@@ -105,6 +109,54 @@ public:
 
 
 
+  ///////////////////////////////////////////////////Bit errors (only used when the bytes of frames are simulated)
+  /**
+   * \return whether bit errors are added to the bytes of frames (i.e., "BitErrorRate" is larger than 0 and the analytic model is not used).
+   */
+  bool IsBitErrorEnabled (void) const;
+
+  /**
+   * \return whether the losses after FEC decoding are sampled analytically (attribute "AnalyticErrorModel") instead of simulating the bytes.
+   */
+  bool IsAnalyticErrorModelUsed (void) const;
+
+  /**
+   * \return the bit error rate of the channel (the default of all ONUs).
+   */
+  double GetBitErrorRate (void) const;
+
+  /**
+   * \brief flip the bits of one received byte array according to "BitErrorRate" and "MeanErrorBurstLength".
+   *        The error-free gaps are geometrically distributed and carried across calls; every error burst flips
+   *        consecutive bits and its length is also geometrically distributed (1 bit when the mean length is 1).
+   * \param data the bytes received by one device
+   * \param size the number of bytes
+   * \return the number of flipped bits
+   */
+  uint32_t AddBitErrors (uint8_t* data, uint32_t size);
+
+  /**
+   * \brief analytic error model: sample the codewords that cannot be corrected, each of them independently with the same probability.
+   *        Only one random number is drawn per lost codeword (the gaps between them are geometrically distributed).
+   * \param probability the probability that one codeword cannot be corrected (see XgponFec::GetUncorrectableProbability)
+   * \param nBlocks the number of codewords of the frame
+   * \param lostBlocks the indexes of the lost codewords are appended here (ascending order)
+   */
+  void SampleLostBlocks (double probability, uint32_t nBlocks, std::vector<uint32_t>& lostBlocks);
+
+
+
+
+  ///////////////////////////////////////////////////Distributed (MPI) simulation
+  /**
+   * \brief let the OLT and ONUs be simulated by different ranks (according to the system id of their nodes).
+   *        It should be called in all ranks after all devices are attached to this channel and their propagation delays are set.
+   */
+  void EnableDistributedSimulation (void);
+
+
+
+
 
 
 
@@ -113,6 +165,11 @@ public:
   virtual TypeId GetInstanceTypeId (void) const;
 
 
+protected:
+  //pass the frames to/from the devices simulated by other ranks to the proxy.
+  virtual void SendDownstreamToRemoteOnus (const Ptr<PonFrame>& frame);
+  virtual void SendUpstreamToRemoteOlt (const Ptr<PonFrame>& frame, uint16_t index);
+
 
 private:
 
@@ -123,6 +180,18 @@ private:
 
   uint32_t m_logicOneWayDelay;                      //the logic one way delay agreed/observed by OLT and all ONUs to avoid upstream collision.
                                                     //Unit: nanosecond; Note that EPON has no such concept.
+
+  Ptr<XgponRemoteChannelProxy> m_remoteProxy;       //used in distributed simulations to exchange frames with other ranks.
+
+
+  double m_bitErrorRate;                            //the average fraction of bits that are flipped; 0 disables bit errors.
+  double m_meanErrorBurstLength;                    //the mean number of consecutive bits flipped by one error burst. unit: bit
+  Ptr<UniformRandomVariable> m_errorRng;            //used to sample the error gaps and the burst lengths
+  double m_bitsToNextError;                         //the error-free bits before the next error burst (negative: not sampled yet)
+  bool m_analyticErrorModel;                        //true: the lost codewords are sampled from the bit error rates (of ONUs) without simulating the bytes
+
+
+  virtual void DoDispose (void);
 };
 
 
@@ -137,6 +206,7 @@ XgponChannel::AddOnu (const Ptr<PonNetDevice>& device)
 
   //The delay is initialized to 0. It will be set later through "SetOnuPropagationDelay".
   m_onuPropDelays.push_back (0);  
+  InvalidateDsDeliveryGroups ( );
 
   return m_onuDevices.size () - 1;
 }
@@ -159,6 +229,7 @@ inline void
 XgponChannel::SetOnuPropagationDelay (uint16_t onuIndex, uint32_t delay)
 {
   m_onuPropDelays[onuIndex] = delay;
+  InvalidateDsDeliveryGroups ( );
 }
 inline uint32_t 
 XgponChannel::GetOnuPropagationDelay (uint16_t onuIndex) const
@@ -171,6 +242,26 @@ XgponChannel::GetOnuPropagationDelay (uint16_t onuIndex) const
 
 
 
+inline bool
+XgponChannel::IsBitErrorEnabled (void) const
+{
+  return (m_bitErrorRate > 0 && !m_analyticErrorModel);
+}
+
+inline bool
+XgponChannel::IsAnalyticErrorModelUsed (void) const
+{
+  return m_analyticErrorModel;
+}
+
+inline double
+XgponChannel::GetBitErrorRate (void) const
+{
+  return m_bitErrorRate;
+}
+
+
+
 inline uint32_t 
 XgponChannel::GetLogicOneWayDelay (void) const
 {
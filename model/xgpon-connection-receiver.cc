@@ -46,7 +46,8 @@ XgponConnectionReceiver::GetInstanceTypeId (void) const
 
 
 XgponConnectionReceiver::XgponConnectionReceiver () : XgponConnection(),
-  m_pkt4Reassemble(0)
+  m_fragments4Reassemble(0),
+  m_sduDiscarded(false)
 {
 }
 XgponConnectionReceiver::~XgponConnectionReceiver ()
@@ -21,6 +21,8 @@
 #ifndef XGPON_CONNECTION_RECEIVER_H
 #define XGPON_CONNECTION_RECEIVER_H
 
+#include <vector>
+
 #include "ns3/packet.h"
 
 #include "xgpon-connection.h"
@@ -48,17 +50,26 @@ public:
   //////////////////////////////////////////////Member variable accessors
 
   /**
-   * \brief put back the received fragments for further reassemble. 
+   * \brief keep one received segment (not the last one) for further reassemble. 
    */  
-  void SetPacket4Reassemble (const Ptr<Packet>& pkt);
+  void AddFragment4Reassemble (const Ptr<Packet>& pkt);
 
   /**
-   * \brief    get the received segments to carry out reassemble. 
-   * \return   the segments received previously. 0: have not received any segment.
-   *           Note that we cannot return one reference since m_pkt4Reassemble need be set to null
-   *           since the received segment has been passed to the caller.
+   * \brief    get the segments received previously (empty: no SDU is being reassembled).
+   *           They are cleared by XgponXgemRoutines::ReassembleSdu when the last segment arrives.
    */  
-  const Ptr<Packet> GetPacket4Reassemble ( );
+  std::vector< Ptr<Packet> >& GetFragments4Reassemble ( );
+
+  /**
+   * \brief one segment of the SDU being received was lost: the segments received before are discarded.
+   * \param restDiscarded whether the lost segment was not the last one of its SDU (the following segments, up to the last one, are discarded too)
+   */
+  void DiscardFragments4Reassemble (bool restDiscarded);
+
+  /**
+   * \return whether the segments of the current SDU are discarded (one of them was lost)
+   */
+  bool IsSduDiscarded ( ) const;
 
 
 
@@ -68,7 +79,8 @@ public:
 
 
 private:
-  Ptr<Packet> m_pkt4Reassemble;  //used to hold the packet to be reassembled further.
+  std::vector< Ptr<Packet> > m_fragments4Reassemble;  //used to hold the segments to be reassembled further.
+  bool m_sduDiscarded;                                 //one segment of the current SDU was lost
 
 };
 
@@ -78,18 +90,26 @@ private:
 
 ////////////////////////////////////////////////INLINE Functions
 inline void 
-XgponConnectionReceiver::SetPacket4Reassemble (const Ptr<Packet>& pkt)
+XgponConnectionReceiver::AddFragment4Reassemble (const Ptr<Packet>& pkt)
 {
   NS_ASSERT_MSG((pkt!=nullptr), "The segment to be reassembled later is NULL!!!");
-  m_pkt4Reassemble = pkt;
+  m_fragments4Reassemble.push_back (pkt);
 }
-inline const Ptr<Packet>
-XgponConnectionReceiver::GetPacket4Reassemble () 
+inline std::vector< Ptr<Packet> >&
+XgponConnectionReceiver::GetFragments4Reassemble () 
 {
-  Ptr<Packet> pkt = m_pkt4Reassemble;
-  m_pkt4Reassemble = 0;
-
-  return pkt;
+  return m_fragments4Reassemble;
+}
+inline void
+XgponConnectionReceiver::DiscardFragments4Reassemble (bool restDiscarded)
+{
+  m_fragments4Reassemble.clear ();
+  m_sduDiscarded = restDiscarded;
+}
+inline bool
+XgponConnectionReceiver::IsSduDiscarded () const
+{
+  return m_sduDiscarded;
 }
 
 
@@ -47,7 +47,7 @@ XgponConnectionSender::GetInstanceTypeId (void) const
 
 
 XgponConnectionSender::XgponConnectionSender ()  : XgponConnection(),
-  m_txQueue (0), m_serviceRecords(0)
+  m_txQueue (0), m_qosParameters (0), m_trafficClass (0), m_serviceRecords(0), m_inActiveList(false)
 {
 }
 XgponConnectionSender::~XgponConnectionSender ()
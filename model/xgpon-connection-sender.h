@@ -24,10 +24,12 @@
 #include <deque>
 
 #include "ns3/packet.h"
+#include "ns3/callback.h"
 
 #include "xgpon-connection.h"
 #include "xgpon-queue.h"
 #include "xgpon-service-record.h"
+#include "xgpon-qos-parameters.h"
 
 
 namespace ns3 {
@@ -120,6 +122,14 @@ public:
   void SetXgponQueue (const Ptr<XgponQueue>& queue);
   const Ptr<XgponQueue>& GetXgponQueue ( ) const;
 
+  //the QoS parameters of this connection (used by the downstream schedulers that consider the service level agreement).
+  void SetQosParameters (const Ptr<XgponQosParameters>& qosParameters);
+  const Ptr<XgponQosParameters>& GetQosParameters ( ) const;
+
+  //the traffic class (derived from the TOS field of IP header) carried by this connection. 0: the default connection for all classes.
+  void SetTrafficClass (uint8_t trafficClass);
+  uint8_t GetTrafficClass ( ) const;
+
 
   /**
    * \brief add one service record to the scheduling history
@@ -132,6 +142,19 @@ public:
   const std::deque< Ptr<XgponServiceRecord> >& GetAllServiceRecords () const;
 
 
+  /**
+   * \brief set the callback invoked when one packet from upper layer is put into the queue of a connection out of the active list.
+   *        It is used by the downstream scheduler to keep the list of connections that have data to send.
+   */
+  void SetBackloggedCallback (Callback<void, Ptr<XgponConnectionSender> > cb);
+
+  /**
+   * \brief whether this connection is in the active list of the scheduler (maintained by the scheduler).
+   */
+  void SetInActiveList (bool inList);
+  bool IsInActiveList ( ) const;
+
+
   /////////////////////////////////////////////////////////////Functions required by NS-3
   static TypeId GetTypeId (void);
   virtual TypeId GetInstanceTypeId (void) const;
@@ -143,8 +166,15 @@ private:
   Ptr<XgponQueue> m_txQueue;                //the queue for holding the packets to be transmitted.
                                             //we should use the helper to configure the queue (type, queue size, etc.) for each connection 
 
+  Ptr<XgponQosParameters> m_qosParameters;  //null if not configured
+  uint8_t m_trafficClass;                   //0: default connection
+
   //a list of service records (at most 8) for this connection. used for scheduling purpose
   std::deque< Ptr<XgponServiceRecord> > m_serviceRecords;   
+
+  //used by the downstream scheduler to track the connections with data to send.
+  Callback<void, Ptr<XgponConnectionSender> > m_backloggedCallback;
+  bool m_inActiveList;
 };
 
 
@@ -156,7 +186,9 @@ private:
 inline bool 
 XgponConnectionSender::ReceiveUpperLayerSdu (const Ptr<Packet>& pkt)
 {
-  return m_txQueue->Enqueue (pkt);
+  bool enqueued = m_txQueue->Enqueue (pkt);
+  if(enqueued && !m_inActiveList && !m_backloggedCallback.IsNull ()) m_backloggedCallback (this);
+  return enqueued;
 }
 
 inline const Ptr<Packet> 
@@ -214,6 +246,28 @@ XgponConnectionSender::GetXgponQueue ( ) const
   return m_txQueue;
 }
 
+inline void 
+XgponConnectionSender::SetQosParameters (const Ptr<XgponQosParameters>& qosParameters)
+{
+  m_qosParameters = qosParameters;
+}
+inline const Ptr<XgponQosParameters>& 
+XgponConnectionSender::GetQosParameters ( ) const
+{
+  return m_qosParameters;
+}
+
+inline void 
+XgponConnectionSender::SetTrafficClass (uint8_t trafficClass)
+{
+  m_trafficClass = trafficClass;
+}
+inline uint8_t 
+XgponConnectionSender::GetTrafficClass ( ) const
+{
+  return m_trafficClass;
+}
+
 
 
 
@@ -233,6 +287,26 @@ XgponConnectionSender::GetAllServiceRecords () const
 
 
 
+inline void 
+XgponConnectionSender::SetBackloggedCallback (Callback<void, Ptr<XgponConnectionSender> > cb)
+{
+  m_backloggedCallback = cb;
+}
+
+inline void 
+XgponConnectionSender::SetInActiveList (bool inList)
+{
+  m_inActiveList = inList;
+}
+inline bool 
+XgponConnectionSender::IsInActiveList ( ) const
+{
+  return m_inActiveList;
+}
+
+
+
+
 }; // namespace ns3
 
 #endif // XGPON_CONNECTION_SENDER_H
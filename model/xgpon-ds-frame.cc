@@ -131,14 +131,25 @@ uint32_t XgponDsFrame::GetSerializedSize (void) const
 
 void XgponDsFrame::Serialize (Buffer::Iterator start) const
 {
-  //TODO: serialization;
+  Buffer::Iterator i = start;
+
+  m_psbd.Serialize(i);
+  i.Next(m_psbd.GetSerializedSize());
+
+  m_xgtcDsFrame.Serialize(i);
   return;
 }
 
 uint32_t XgponDsFrame::Deserialize (Buffer::Iterator start)
 {
-  //TODO: deserialization;
-  return GetSerializedSize ();
+  //the burst size and the number of broadcast xgem frames of m_xgtcDsFrame must be set before this call.
+  Buffer::Iterator i = start;
+
+  uint32_t len = m_psbd.Deserialize(i);
+  i.Next(len);
+
+  len += m_xgtcDsFrame.Deserialize(i);
+  return len;
 }
 
 }; // namespace ns3
@@ -23,6 +23,7 @@
 
 #include <cstdlib>
 #include <stack>
+#include <vector>
 
 #include "pon-frame.h"
 #include "xgpon-psbd.h"
@@ -68,6 +69,12 @@ public:
    */
   XgponXgtcDsFrame& GetXgtcDsFrame ();
 
+  /**
+   * \brief get the FEC codewords of the XGTC frame. They are only filled by the transmitter when the bytes are simulated
+   *        (FEC or bit errors enabled) and they are not serialized (the receiver encodes the frame again if empty).
+   */
+  std::vector<uint8_t>& GetCodewords ();
+
 
 
   ///////////////////////////////////////////Override new and delete to use a pool for avoiding to call malloc/free too many times.
@@ -92,6 +99,8 @@ private:
   XgponPsbd m_psbd;
   XgponXgtcDsFrame m_xgtcDsFrame;
 
+  std::vector<uint8_t> meta_codewords;   //the codewords sent over the channel; used for simulating bit errors and FEC decoding
+
 
 
   //disable users to call new[] and delete[].
@@ -128,6 +137,14 @@ XgponDsFrame::GetXgtcDsFrame ()
 
 
 
+inline std::vector<uint8_t>&
+XgponDsFrame::GetCodewords ()
+{
+  return meta_codewords;
+}
+
+
+
 }; // namespace ns3
 
 #endif // XGPON_DS_FRAME_H
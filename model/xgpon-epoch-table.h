@@ -0,0 +1,144 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2012 University College Cork (UCC), Ireland
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jerome Arokkiam <jerome.arokkia@bt.com>
+ */
+
+#ifndef XGPON_EPOCH_TABLE_H
+#define XGPON_EPOCH_TABLE_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "ns3/assert.h"
+
+
+
+namespace ns3 {
+
+/**
+ * \ingroup xgpon
+ * \brief A table of per-frame (or per-cycle) values that is cleared in constant time.
+ *
+ * Each entry is stamped with the epoch in which it was set. Clear only starts a new epoch, so the entries set in earlier epochs
+ * read as the default value. It replaces std::fill/assign over large tables (e.g., one flag per alloc-id) that are cleared
+ * for each BWMAP while only a few entries are touched.
+ */
+template <typename T>
+class XgponEpochTable
+{
+public:
+  /**
+   * \brief Constructor
+   * \param size the number of entries
+   * \param defaultValue the value of entries that have not been set in the current epoch
+   */
+  XgponEpochTable (uint32_t size = 0, const T& defaultValue = T ());
+
+  /**
+   * \brief change the number of entries. The new entries have the default value.
+   */
+  void Resize (uint32_t size);
+  uint32_t GetSize (void) const;
+
+  /**
+   * \brief set all entries to the default value (by starting a new epoch).
+   */
+  void Clear (void);
+
+  /**
+   * \return whether the entry has been set in the current epoch.
+   */
+  bool IsSet (uint32_t index) const;
+
+  T Get (uint32_t index) const;
+  void Set (uint32_t index, const T& value);
+
+private:
+  std::vector<uint32_t> m_epochs;    //the epoch in which each entry was set
+  std::vector<T> m_values;
+  uint32_t m_epoch;                  //the current epoch (starting from 1; 0 marks the entries never set)
+  T m_defaultValue;
+};
+
+
+
+
+////////////////////////////////////////////////////INLINE Functions
+template <typename T>
+XgponEpochTable<T>::XgponEpochTable (uint32_t size, const T& defaultValue)
+  : m_epochs(size, 0), m_values(size, defaultValue), m_epoch(1), m_defaultValue(defaultValue)
+{
+}
+
+template <typename T>
+inline void
+XgponEpochTable<T>::Resize (uint32_t size)
+{
+  m_epochs.resize (size, 0);
+  m_values.resize (size, m_defaultValue);
+}
+
+template <typename T>
+inline uint32_t
+XgponEpochTable<T>::GetSize (void) const
+{
+  return m_epochs.size ();
+}
+
+template <typename T>
+inline void
+XgponEpochTable<T>::Clear (void)
+{
+  m_epoch++;
+  if(m_epoch == 0)
+  {
+    //the epoch wrapped around (after 2^32 clears): the old stamps have to be removed once.
+    m_epochs.assign (m_epochs.size (), 0);
+    m_epoch = 1;
+  }
+}
+
+template <typename T>
+inline bool
+XgponEpochTable<T>::IsSet (uint32_t index) const
+{
+  NS_ASSERT_MSG((index < m_epochs.size ()), "The index is out of the range of the table!!!");
+  return (m_epochs[index] == m_epoch);
+}
+
+template <typename T>
+inline T
+XgponEpochTable<T>::Get (uint32_t index) const
+{
+  if(IsSet (index)) return m_values[index];
+  else return m_defaultValue;
+}
+
+template <typename T>
+inline void
+XgponEpochTable<T>::Set (uint32_t index, const T& value)
+{
+  NS_ASSERT_MSG((index < m_epochs.size ()), "The index is out of the range of the table!!!");
+  m_epochs[index] = m_epoch;
+  m_values[index] = value;
+}
+
+
+} // namespace ns3
+
+#endif /* XGPON_EPOCH_TABLE_H */
@@ -0,0 +1,431 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2012 University College Cork (UCC), Ireland
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jerome Arokkiam <jerome.arokkia@bt.com>
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+
+#include "ns3/assert.h"
+#include "ns3/global-value.h"
+#include "ns3/boolean.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+#include "xgpon-fec.h"
+#include "xgpon-phy.h"
+
+
+
+namespace ns3 {
+
+static GlobalValue g_xgponFecEnabled ("XgponFecEnabled",
+                                      "Whether the XG-PON frames are really encoded and decoded with Reed-Solomon FEC",
+                                      BooleanValue (false),
+                                      MakeBooleanChecker ());
+
+
+namespace {
+
+//log/exp tables of GF(2^8) and the products of each byte with all low/high nibbles.
+struct XgponGfTables
+{
+  uint8_t m_exp[512];
+  uint8_t m_log[256];
+  uint8_t m_mulLo[256][16] __attribute__ ((aligned (16)));
+  uint8_t m_mulHi[256][16] __attribute__ ((aligned (16)));
+
+  XgponGfTables ()
+  {
+    uint16_t x = 1;
+    for(uint32_t i = 0; i < 255; i++)
+    {
+      m_exp[i] = x;
+      m_log[x] = i;
+      x <<= 1;
+      if(x & 0x100) x ^= XgponFec::XGPON_GF_PRIMITIVE_POLYNOMIAL;
+    }
+    for(uint32_t i = 255; i < 512; i++) m_exp[i] = m_exp[i - 255];
+    m_log[0] = 0;   //never used
+
+    for(uint32_t c = 0; c < 256; c++)
+    {
+      for(uint32_t n = 0; n < 16; n++)
+      {
+        m_mulLo[c][n] = Multiply (c, n);
+        m_mulHi[c][n] = Multiply (c, n << 4);
+      }
+    }
+  }
+
+  uint8_t Multiply (uint8_t a, uint8_t b) const
+  {
+    if(a == 0 || b == 0) return 0;
+    return m_exp[m_log[a] + m_log[b]];
+  }
+
+  uint8_t Divide (uint8_t a, uint8_t b) const
+  {
+    if(a == 0) return 0;
+    return m_exp[m_log[a] + 255 - m_log[b]];
+  }
+};
+
+const XgponGfTables g_gf;
+
+
+//acc[i] ^= c * v[i]: the split-nibble products are looked up with PSHUFB (32 or 16 bytes at a time).
+inline void
+XgponGfMultiplyAdd (uint8_t* acc, uint8_t c, const uint8_t* v, uint32_t size)
+{
+  if(c == 0) return;
+
+  const uint8_t* lo = g_gf.m_mulLo[c];
+  const uint8_t* hi = g_gf.m_mulHi[c];
+  uint32_t i = 0;
+
+#if defined(__AVX2__)
+  if(size >= 32)
+  {
+    __m256i tableLo = _mm256_broadcastsi128_si256 (_mm_load_si128 ((const __m128i*) lo));
+    __m256i tableHi = _mm256_broadcastsi128_si256 (_mm_load_si128 ((const __m128i*) hi));
+    __m256i mask = _mm256_set1_epi8 (0x0F);
+    for(; i + 32 <= size; i += 32)
+    {
+      __m256i x = _mm256_loadu_si256 ((const __m256i*) (v + i));
+      __m256i p = _mm256_xor_si256 (_mm256_shuffle_epi8 (tableLo, _mm256_and_si256 (x, mask)),
+                                    _mm256_shuffle_epi8 (tableHi, _mm256_and_si256 (_mm256_srli_epi64 (x, 4), mask)));
+      _mm256_storeu_si256 ((__m256i*) (acc + i), _mm256_xor_si256 (_mm256_loadu_si256 ((const __m256i*) (acc + i)), p));
+    }
+  }
+#endif
+
+#if defined(__SSSE3__)
+  __m128i tableLo16 = _mm_load_si128 ((const __m128i*) lo);
+  __m128i tableHi16 = _mm_load_si128 ((const __m128i*) hi);
+  __m128i mask16 = _mm_set1_epi8 (0x0F);
+  for(; i + 16 <= size; i += 16)
+  {
+    __m128i x = _mm_loadu_si128 ((const __m128i*) (v + i));
+    __m128i p = _mm_xor_si128 (_mm_shuffle_epi8 (tableLo16, _mm_and_si128 (x, mask16)),
+                               _mm_shuffle_epi8 (tableHi16, _mm_and_si128 (_mm_srli_epi64 (x, 4), mask16)));
+    _mm_storeu_si128 ((__m128i*) (acc + i), _mm_xor_si128 (_mm_loadu_si128 ((const __m128i*) (acc + i)), p));
+  }
+#endif
+
+  for(; i < size; i++) acc[i] ^= lo[v[i] & 0x0F] ^ hi[v[i] >> 4];
+}
+
+} // anonymous namespace
+
+
+
+
+XgponFec::XgponFec (uint16_t blockSize, uint16_t dataSize) 
+  : m_blockSize(blockSize), m_dataSize(dataSize), m_paritySize(blockSize - dataSize)
+{
+  NS_ASSERT_MSG((dataSize > 0 && blockSize >= dataSize && blockSize <= 255), "Unlawful parameters of Reed-Solomon code!!!");
+  if(m_paritySize == 0) return;
+
+  //generator polynomial (highest degree first): (x - alpha^0) ... (x - alpha^(2t-1))
+  std::vector<uint8_t> gen (m_paritySize + 1, 0);
+  gen[0] = 1;
+  for(uint32_t i = 0; i < m_paritySize; i++)
+  {
+    for(uint32_t j = i + 1; j > 0; j--)
+    {
+      gen[j] ^= g_gf.Multiply (gen[j - 1], g_gf.m_exp[i]);
+    }
+  }
+
+  //encode the unit blocks with a shift register (only once).
+  m_encodeMatrix.assign (m_dataSize * m_paritySize, 0);
+  std::vector<uint8_t> reg (m_paritySize);
+  for(uint32_t row = 0; row < m_dataSize; row++)
+  {
+    std::fill (reg.begin (), reg.end (), 0);
+    for(uint32_t j = 0; j < m_dataSize; j++)
+    {
+      uint8_t feedback = (j == row ? 1 : 0) ^ reg[0];
+      for(uint32_t i = 0; i + 1 < m_paritySize; i++) reg[i] = reg[i + 1] ^ g_gf.Multiply (feedback, gen[i + 1]);
+      reg[m_paritySize - 1] = g_gf.Multiply (feedback, gen[m_paritySize]);
+    }
+    memcpy (&m_encodeMatrix[row * m_paritySize], &reg[0], m_paritySize);
+  }
+
+  m_syndromeMatrix.resize (m_blockSize * m_paritySize);
+  for(uint32_t p = 0; p < m_blockSize; p++)
+  {
+    for(uint32_t i = 0; i < m_paritySize; i++) m_syndromeMatrix[p * m_paritySize + i] = g_gf.m_exp[(i * p) % 255];
+  }
+}
+XgponFec::~XgponFec ()
+{
+}
+
+
+
+bool
+XgponFec::IsEnabled (void)
+{
+  static bool s_enabled = false;
+  static bool s_initialized = false;
+
+  if(!s_initialized)
+  {
+    BooleanValue value;
+    g_xgponFecEnabled.GetValue (value);
+    s_enabled = value.Get ();
+    s_initialized = true;
+  }
+  return s_enabled;
+}
+
+
+const XgponFec&
+XgponFec::GetCode (uint16_t blockSize, uint16_t dataSize)
+{
+  static std::map<uint32_t, XgponFec> s_codes;
+
+  uint32_t key = (blockSize << 16) | dataSize;
+  std::map<uint32_t, XgponFec>::iterator it = s_codes.find (key);
+  if(it == s_codes.end ()) it = s_codes.insert (std::make_pair (key, XgponFec (blockSize, dataSize))).first;
+  return it->second;
+}
+
+const XgponFec&
+XgponFec::GetDsCode (const Ptr<XgponPhy>& phy, bool fec)
+{
+  if(fec) return GetCode (phy->GetDsFecBlockSize (), phy->GetDsFecBlockDataSize ());
+  else return GetCode (phy->GetDsFecBlockDataSize (), phy->GetDsFecBlockDataSize ());
+}
+
+const XgponFec&
+XgponFec::GetUsCode (const Ptr<XgponPhy>& phy, bool fec)
+{
+  if(fec) return GetCode (phy->GetUsFecBlockSize (), phy->GetUsFecBlockDataSize ());
+  else return GetCode (phy->GetUsFecBlockDataSize (), phy->GetUsFecBlockDataSize ());
+}
+
+
+
+
+void
+XgponFec::Encode (const uint8_t* data, uint32_t size, uint8_t* parity) const
+{
+  NS_ASSERT_MSG((size <= m_dataSize), "The data is too long for one codeword!!!");
+
+  memset (parity, 0, m_paritySize);
+  const uint8_t* row = &m_encodeMatrix[(m_dataSize - size) * m_paritySize];   //a shortened block starts with virtual zeros
+  for(uint32_t j = 0; j < size; j++, row += m_paritySize)
+  {
+    XgponGfMultiplyAdd (parity, data[j], row, m_paritySize);
+  }
+}
+
+
+int32_t
+XgponFec::Decode (uint8_t* codeword, uint32_t size) const
+{
+  NS_ASSERT_MSG((size > m_paritySize && size <= m_blockSize), "Unlawful size of one codeword!!!");
+  if(m_paritySize == 0) return 0;
+
+  //syndromes: the byte at position j has the degree size-1-j.
+  uint8_t syndromes[256];
+  memset (syndromes, 0, m_paritySize);
+  const uint8_t* row = &m_syndromeMatrix[(size - 1) * m_paritySize];
+  for(uint32_t j = 0; j < size; j++, row -= m_paritySize)
+  {
+    XgponGfMultiplyAdd (syndromes, codeword[j], row, m_paritySize);
+  }
+
+  bool error = false;
+  for(uint32_t i = 0; i < m_paritySize; i++) error |= (syndromes[i] != 0);
+  if(!error) return 0;
+
+
+  //Berlekamp-Massey: the error locator polynomial (lowest degree first).
+  uint8_t locator[256], previous[256], tmp[256];
+  memset (locator, 0, m_paritySize + 1);
+  memset (previous, 0, m_paritySize + 1);
+  locator[0] = previous[0] = 1;
+  uint32_t degree = 0, shift = 1;
+  uint8_t lastDiscrepancy = 1;
+
+  for(uint32_t n = 0; n < m_paritySize; n++)
+  {
+    uint8_t d = syndromes[n];
+    for(uint32_t i = 1; i <= degree; i++) d ^= g_gf.Multiply (locator[i], syndromes[n - i]);
+
+    if(d == 0) { shift++; continue; }
+
+    uint8_t coef = g_gf.Divide (d, lastDiscrepancy);
+    memcpy (tmp, locator, m_paritySize + 1);
+    for(uint32_t i = 0; i + shift <= m_paritySize; i++) locator[i + shift] ^= g_gf.Multiply (coef, previous[i]);
+
+    if(2 * degree <= n)
+    {
+      degree = n + 1 - degree;
+      memcpy (previous, tmp, m_paritySize + 1);
+      lastDiscrepancy = d;
+      shift = 1;
+    }
+    else shift++;
+  }
+  if(degree > m_paritySize / 2u) return -1;
+
+
+  //error evaluator: S(x) * locator(x) mod x^(2t)
+  uint8_t evaluator[256];
+  memset (evaluator, 0, m_paritySize);
+  for(uint32_t i = 0; i < m_paritySize; i++)
+  {
+    for(uint32_t j = 0; j <= degree && j <= i; j++) evaluator[i] ^= g_gf.Multiply (syndromes[i - j], locator[j]);
+  }
+
+
+  //Chien search over the degrees of this (shortened) codeword and Forney's formula.
+  uint32_t found = 0;
+  for(uint32_t p = 0; p < size && found < degree; p++)
+  {
+    uint32_t inverse = (255 - p) % 255;      //log of X^-1, where X = alpha^p
+    uint8_t value = 0;
+    for(uint32_t i = 0; i <= degree; i++)
+    {
+      if(locator[i] != 0) value ^= g_gf.m_exp[(g_gf.m_log[locator[i]] + i * inverse) % 255];
+    }
+    if(value != 0) continue;
+
+    uint8_t omega = 0, derivative = 0;
+    for(uint32_t i = 0; i < m_paritySize; i++)
+    {
+      if(evaluator[i] != 0) omega ^= g_gf.m_exp[(g_gf.m_log[evaluator[i]] + i * inverse) % 255];
+    }
+    for(uint32_t i = 1; i <= degree; i += 2)   //formal derivative: only the odd terms are left
+    {
+      if(locator[i] != 0) derivative ^= g_gf.m_exp[(g_gf.m_log[locator[i]] + (i - 1) * inverse) % 255];
+    }
+    if(derivative == 0) return -1;
+
+    codeword[size - 1 - p] ^= g_gf.Multiply (g_gf.m_exp[p % 255], g_gf.Divide (omega, derivative));
+    found++;
+  }
+
+  if(found != degree) return -1;    //the errors are beyond the correction capability
+  return found;
+}
+
+
+
+
+void
+XgponFec::EncodeBlocks (const uint8_t* data, uint32_t size, std::vector<uint8_t>& codewords) const
+{
+  codewords.resize (GetEncodedSize (size));
+
+  uint8_t* out = &codewords[0];
+  for(uint32_t pos = 0; pos < size; pos += m_dataSize)
+  {
+    uint32_t len = std::min<uint32_t> (m_dataSize, size - pos);
+    memcpy (out, data + pos, len);
+    if(m_paritySize > 0) Encode (data + pos, len, out + len);
+    out += len + m_paritySize;
+  }
+}
+
+
+void
+XgponFec::DecodeBlocks (uint8_t* received, const uint8_t* sent, uint32_t size, std::vector<uint32_t>& lostBlocks) const
+{
+  uint32_t offset = 0;
+  for(uint32_t pos = 0, block = 0; pos < size; pos += m_dataSize, block++)
+  {
+    uint32_t len = std::min<uint32_t> (m_dataSize, size - pos);
+    if(m_paritySize > 0) Decode (received + offset, len + m_paritySize);
+
+    //a miscorrected codeword is also detected here (by the upper layers in reality: HEC, etc.).
+    if(memcmp (received + offset, sent + offset, len) != 0) lostBlocks.push_back (block);
+    offset += len + m_paritySize;
+  }
+}
+
+
+bool
+XgponFec::IsRangeLost (const std::vector<uint32_t>& lostBlocks, uint32_t start, uint32_t end) const
+{
+  if(lostBlocks.empty () || end <= start) return false;
+
+  std::vector<uint32_t>::const_iterator it = std::lower_bound (lostBlocks.begin (), lostBlocks.end (), start / m_dataSize);
+  return (it != lostBlocks.end ()) && (*it <= (end - 1) / m_dataSize);
+}
+
+
+
+double
+XgponFec::GetUncorrectableProbability (double ber) const
+{
+  std::map<double, double>::const_iterator it = m_uncorrectableProbabilities.find (ber);
+  if(it != m_uncorrectableProbabilities.end ()) return it->second;
+
+  double probability;
+  if(ber <= 0) probability = 0;
+  else if(ber >= 1) probability = 1;
+  else
+  {
+    //binomial tail over the symbols: sum of C(n,i) ps^i (1-ps)^(n-i) for i > t. 
+    //It is summed directly (not 1 - the head) since it is far below the precision of 1 for low error rates.
+    double symbolLog = std::log (-std::expm1 (8 * std::log1p (-ber)));   //log(ps), ps = 1 - (1-ber)^8
+    double correctLog = 8 * std::log1p (-ber);                            //log(1-ps)
+    uint32_t n = m_blockSize, t = m_paritySize / 2;
+
+    probability = 0;
+    for(uint32_t i = t + 1; i <= n; i++)
+    {
+      probability += std::exp (std::lgamma (n + 1.0) - std::lgamma (i + 1.0) - std::lgamma (n - i + 1.0)
+                               + i * symbolLog + (n - i) * correctLog);
+    }
+    probability = std::min (1.0, probability);
+  }
+
+  m_uncorrectableProbabilities[ber] = probability;
+  return probability;
+}
+
+
+
+
+void
+XgponFec::MultiplyAdd (uint8_t* acc, uint8_t c, const uint8_t* v, uint32_t size)
+{
+  XgponGfMultiplyAdd (acc, c, v, size);
+}
+
+uint8_t
+XgponFec::Multiply (uint8_t a, uint8_t b)
+{
+  return g_gf.Multiply (a, b);
+}
+
+
+}; // namespace ns3
@@ -0,0 +1,212 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2012 University College Cork (UCC), Ireland
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jerome Arokkiam <jerome.arokkia@bt.com>
+ */
+
+#ifndef XGPON_FEC_H
+#define XGPON_FEC_H
+
+#include <stdint.h>
+#include <map>
+#include <vector>
+
+#include "ns3/ptr.h"
+
+
+
+namespace ns3 {
+
+class XgponPhy;
+
+/**
+ * \ingroup xgpon
+ * \brief Reed-Solomon codec of XG-PON FEC (ITU-T G.987.2), i.e., RS(248,216) in downstream and RS(248,232) in upstream.
+ *
+ * Both codes are shortened from RS(255,255-2t) over GF(2^8) with the primitive polynomial x^8 + x^4 + x^3 + x^2 + 1.
+ * The roots of the generator polynomial are alpha^0, ..., alpha^(2t-1).
+ *
+ * Parity and syndromes are calculated as matrix products: for each byte of the codeword, one constant row (2t bytes)
+ * multiplied by this byte is added to the accumulator. The GF(2^8) multiplication of one row by one byte uses
+ * two lookups in 16-entry tables (low and high nibble), i.e., PSHUFB with SSSE3/AVX2 when the compiler targets them.
+ * Errors are only located (Berlekamp-Massey, Chien search and Forney) when one syndrome is not zero.
+ *
+ * A code without parity (blockSize == dataSize) is allowed; it is used for the bursts transmitted without FEC.
+ *
+ * For simulation speed, the codewords are not calculated unless the global value "XgponFecEnabled" is true
+ * or bit errors are configured on XgponChannel. It is read once (at the first call of IsEnabled).
+ * The analytic error model of XgponChannel only uses the probability that one codeword cannot be corrected.
+ */
+class XgponFec
+{
+public:
+  const static uint16_t XGPON_GF_PRIMITIVE_POLYNOMIAL = 0x11D;    //x^8 + x^4 + x^3 + x^2 + 1
+
+  /**
+   * \brief Constructor
+   * \param blockSize the size of one codeword. unit: byte
+   * \param dataSize the size of the data in one codeword. unit: byte
+   */
+  XgponFec (uint16_t blockSize, uint16_t dataSize);
+  virtual ~XgponFec ();
+
+
+  /**
+   * \brief whether the payloads are really FEC-encoded and decoded.
+   */
+  static bool IsEnabled (void);
+
+  /**
+   * \return the codec shared by all devices with the given parameters.
+   */
+  static const XgponFec& GetCode (uint16_t blockSize, uint16_t dataSize);
+
+  /**
+   * \return the code of the downstream frames. Without FEC, it has no parity and its blocks only locate the errors.
+   */
+  static const XgponFec& GetDsCode (const Ptr<XgponPhy>& phy, bool fec);
+
+  /**
+   * \return the code of the upstream bursts. Without FEC, it has no parity and its blocks only locate the errors.
+   */
+  static const XgponFec& GetUsCode (const Ptr<XgponPhy>& phy, bool fec);
+
+
+  uint16_t GetBlockSize ( ) const;
+  uint16_t GetDataSize ( ) const;
+  uint16_t GetParitySize ( ) const;
+
+
+  /**
+   * \brief calculate the parity bytes of one codeword.
+   * \param data the data bytes (at most dataSize bytes; a shorter block is one shortened codeword)
+   * \param size the number of data bytes
+   * \param parity the output (GetParitySize () bytes)
+   */
+  void Encode (const uint8_t* data, uint32_t size, uint8_t* parity) const;
+
+  /**
+   * \brief correct one codeword in place.
+   * \return the number of corrected bytes; -1 if the codeword cannot be corrected.
+   * \param codeword the data bytes followed by the parity bytes
+   * \param size the size of this codeword (data and parity)
+   */
+  int32_t Decode (uint8_t* codeword, uint32_t size) const;
+
+
+  /**
+   * \brief split a byte array into codewords (the last one may be shortened) and encode them.
+   * \param data the byte array
+   * \param size the size of the byte array
+   * \param codewords the output (resized to GetEncodedSize (size))
+   */
+  void EncodeBlocks (const uint8_t* data, uint32_t size, std::vector<uint8_t>& codewords) const;
+
+  /**
+   * \brief decode the received codewords in place and find the blocks whose data is still different from the transmitted one.
+   * \param received the received codewords (corrected in place)
+   * \param sent the transmitted codewords
+   * \param size the size of the data (before encoding)
+   * \param lostBlocks the indexes of the damaged blocks are appended here (ascending order)
+   */
+  void DecodeBlocks (uint8_t* received, const uint8_t* sent, uint32_t size, std::vector<uint32_t>& lostBlocks) const;
+
+  /**
+   * \return whether the data bytes [start, end) overlap one of the damaged blocks.
+   */
+  bool IsRangeLost (const std::vector<uint32_t>& lostBlocks, uint32_t start, uint32_t end) const;
+
+  /**
+   * \return the probability that one codeword cannot be corrected when bits are flipped independently,
+   *         i.e., more than t of its symbols are wrong (any wrong symbol without parity).
+   *         It is used by the analytic error model and cached per bit error rate.
+   * \param ber the bit error rate
+   */
+  double GetUncorrectableProbability (double ber) const;
+
+  /**
+   * \return the number of codewords (blocks) of size data bytes.
+   */
+  uint32_t GetNumberOfBlocks (uint32_t size) const;
+
+  /**
+   * \return the size of the codewords of size data bytes.
+   */
+  uint32_t GetEncodedSize (uint32_t size) const;
+
+
+  /**
+   * \brief GF(2^8) kernel: acc[i] ^= c * v[i] for all i.
+   */
+  static void MultiplyAdd (uint8_t* acc, uint8_t c, const uint8_t* v, uint32_t size);
+
+  /**
+   * \return a * b in GF(2^8)
+   */
+  static uint8_t Multiply (uint8_t a, uint8_t b);
+
+
+private:
+  uint16_t m_blockSize;
+  uint16_t m_dataSize;
+  uint16_t m_paritySize;
+
+  //row j: the parity of the data block whose only non-zero byte is 1 at position j (dataSize rows of paritySize bytes).
+  std::vector<uint8_t> m_encodeMatrix;
+
+  //row p: alpha^(i*p) for i = 0 .. paritySize-1, i.e., the contribution of the byte of degree p to the syndromes (blockSize rows).
+  std::vector<uint8_t> m_syndromeMatrix;
+
+  mutable std::map<double, double> m_uncorrectableProbabilities;   //bit error rate -> probability that one codeword is lost
+};
+
+
+
+
+////////////////////////////////////////////////////INLINE Functions
+inline uint16_t
+XgponFec::GetBlockSize ( ) const
+{
+  return m_blockSize;
+}
+inline uint16_t
+XgponFec::GetDataSize ( ) const
+{
+  return m_dataSize;
+}
+inline uint16_t
+XgponFec::GetParitySize ( ) const
+{
+  return m_paritySize;
+}
+
+inline uint32_t
+XgponFec::GetNumberOfBlocks (uint32_t size) const
+{
+  return (size + m_dataSize - 1) / m_dataSize;
+}
+
+inline uint32_t
+XgponFec::GetEncodedSize (uint32_t size) const
+{
+  return size + GetNumberOfBlocks (size) * m_paritySize;
+}
+
+
+}; // namespace ns3
+
+#endif // XGPON_FEC_H
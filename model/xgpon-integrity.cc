@@ -0,0 +1,164 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2012 University College Cork (UCC), Ireland
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jerome Arokkiam <jerome.arokkia@bt.com>
+ */
+
+#include <cstring>
+
+#include "ns3/global-value.h"
+#include "ns3/boolean.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "xgpon-integrity.h"
+
+
+
+namespace ns3 {
+
+static GlobalValue g_xgponIntegrityEnabled ("XgponIntegrityEnabled",
+                                            "Whether HEC of XG-PON headers and BIP-32 of upstream bursts are calculated and verified",
+                                            BooleanValue (false),
+                                            MakeBooleanChecker ());
+
+
+namespace {
+
+//the remainders of (i * x^12) mod g(x) for all bytes i.
+struct XgponBchTable
+{
+  uint16_t m_remainders[256];
+
+  XgponBchTable ()
+  {
+    for(uint32_t i = 0; i < 256; i++)
+    {
+      uint16_t r = i << 4;
+      for(int bit = 0; bit < 8; bit++)
+      {
+        r = (r & 0x800) ? ((r << 1) ^ XgponIntegrity::XGPON_BCH_GENERATOR) : (r << 1);
+      }
+      m_remainders[i] = r & 0x0FFF;
+    }
+  }
+};
+
+const XgponBchTable g_bchTable;
+
+} // anonymous namespace
+
+
+
+bool
+XgponIntegrity::IsEnabled (void)
+{
+  static bool s_enabled = false;
+  static bool s_initialized = false;
+
+  if(!s_initialized)
+  {
+    BooleanValue value;
+    g_xgponIntegrityEnabled.GetValue (value);
+    s_enabled = value.Get ();
+    s_initialized = true;
+  }
+  return s_enabled;
+}
+
+
+
+uint16_t
+XgponIntegrity::CalculateHec (uint64_t data, uint8_t nBits)
+{
+  //leading zeros do not change the remainder. Thus, the bits are processed as whole bytes (most significant first).
+  uint16_t r = 0;
+  for(int shift = ((nBits + 7) / 8 - 1) * 8; shift >= 0; shift -= 8)
+  {
+    uint8_t byte = (data >> shift) & 0xFF;
+    r = ((r << 8) ^ g_bchTable.m_remainders[((r >> 4) ^ byte) & 0xFF]) & 0x0FFF;
+  }
+
+  return (r << 1) | ParityBit (data, r);
+}
+
+
+uint16_t
+XgponIntegrity::CalculateHecBitwise (uint64_t data, uint8_t nBits)
+{
+  uint16_t r = 0;
+  for(int bit = nBits - 1; bit >= 0; bit--)
+  {
+    uint16_t in = (data >> bit) & 0x01;
+    uint16_t msb = (r >> 11) & 0x01;
+    r = (r << 1) & 0x0FFF;
+    if(msb ^ in) r ^= (XGPON_BCH_GENERATOR & 0x0FFF);
+  }
+
+  return (r << 1) | ParityBit (data, r);
+}
+
+
+uint16_t
+XgponIntegrity::ParityBit (uint64_t data, uint16_t remainder)
+{
+  return (__builtin_popcountll (data) + __builtin_popcount (remainder)) & 0x01;
+}
+
+
+
+
+uint32_t
+XgponIntegrity::CalculateBip32 (const uint8_t* data, uint32_t size)
+{
+  uint8_t acc[32];
+  memset (acc, 0, sizeof (acc));
+  uint32_t pos = 0;
+
+#if defined(__AVX2__)
+  __m256i acc256 = _mm256_setzero_si256 ();
+  for(; pos + 32 <= size; pos += 32)
+  {
+    acc256 = _mm256_xor_si256 (acc256, _mm256_loadu_si256 ((const __m256i*) (data + pos)));
+  }
+  _mm256_storeu_si256 ((__m256i*) acc, acc256);
+#endif
+
+  uint64_t acc64 = 0;
+  for(; pos + 8 <= size; pos += 8)
+  {
+    uint64_t word;
+    memcpy (&word, data + pos, 8);
+    acc64 ^= word;
+  }
+  uint8_t tmp[8];
+  memcpy (tmp, &acc64, 8);
+  for(int k = 0; k < 8; k++) acc[k] ^= tmp[k];   //the positions of the bytes are kept (pos is a multiple of 8).
+
+  for(; pos < size; pos++) acc[pos % 8] ^= data[pos];
+
+  //fold the bytes into one word (byte k belongs to the (k % 4)th byte of a word).
+  uint8_t bip[4] = {0, 0, 0, 0};
+  for(int k = 0; k < 32; k++) bip[k % 4] ^= acc[k];
+
+  return ((uint32_t) bip[0] << 24) | ((uint32_t) bip[1] << 16) | ((uint32_t) bip[2] << 8) | bip[3];
+}
+
+
+}; // namespace ns3
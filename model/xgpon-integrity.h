@@ -0,0 +1,77 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2012 University College Cork (UCC), Ireland
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jerome Arokkiam <jerome.arokkia@bt.com>
+ */
+
+#ifndef XGPON_INTEGRITY_H
+#define XGPON_INTEGRITY_H
+
+#include <stdint.h>
+
+
+
+namespace ns3 {
+
+/**
+ * \ingroup xgpon
+ * \brief The routines used to calculate the integrity fields of XG-PON headers and trailers (ITU-T G.987.3).
+ *
+ * HEC: 13 bits, i.e., the 12-bit remainder of one BCH(63,12) code with the generator polynomial
+ *      x^12 + x^10 + x^8 + x^5 + x^4 + x^3 + 1, followed by one bit for even parity over the whole field.
+ * BIP-32: the exclusive OR of all 32-bit words of the protected bytes.
+ *
+ * For simulation speed, these fields are not calculated unless the global value "XgponIntegrityEnabled" is true.
+ * It is read once (at the first call of IsEnabled), so it should be configured before the simulation starts.
+ * HEC is calculated one byte at a time through a table; BIP-32 is calculated eight (or 32 with AVX2) bytes at a time.
+ */
+class XgponIntegrity
+{
+public:
+  const static uint16_t XGPON_BCH_GENERATOR = 0x1539;     //x^12 + x^10 + x^8 + x^5 + x^4 + x^3 + 1
+
+  /**
+   * \brief whether the integrity fields should be calculated and verified.
+   */
+  static bool IsEnabled (void);
+
+  /**
+   * \brief calculate the 13-bit HEC of one header field.
+   * \param data the protected bits (right-aligned)
+   * \param nBits the number of protected bits (at most 51)
+   */
+  static uint16_t CalculateHec (uint64_t data, uint8_t nBits);
+
+  /**
+   * \brief calculate the 13-bit HEC one bit at a time. It is used to check the table-driven one.
+   */
+  static uint16_t CalculateHecBitwise (uint64_t data, uint8_t nBits);
+
+  /**
+   * \brief calculate BIP-32 over a byte array. When size is not a multiple of 4, the last word is padded with 0.
+   * \return the BIP-32 value (the first byte of one word is the most significant byte)
+   */
+  static uint32_t CalculateBip32 (const uint8_t* data, uint32_t size);
+
+private:
+  static uint16_t ParityBit (uint64_t data, uint16_t remainder);
+};
+
+
+}; // namespace ns3
+
+#endif // XGPON_INTEGRITY_H
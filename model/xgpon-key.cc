@@ -18,6 +18,8 @@
  * Author: Xiuchao Wu <xw2@cs.ucc.ie>
  */
 
+#include <cstring>
+
 #include "ns3/log.h"
 
 #include "xgpon-key.h"
@@ -46,7 +48,7 @@ XgponKey::GetInstanceTypeId (void) const
 
 
 
-XgponKey::XgponKey ()
+XgponKey::XgponKey () : m_hasKeyData(false)
 {
 }
 XgponKey::~XgponKey ()
@@ -57,6 +59,18 @@ XgponKey::~XgponKey ()
 void 
 XgponKey::DeepCopy(const Ptr<XgponKey>& key)
 {
+  m_hasKeyData = key->m_hasKeyData;
+  memcpy (m_keyData, key->m_keyData, sizeof (m_keyData));
+  memcpy (m_roundKeys, key->m_roundKeys, sizeof (m_roundKeys));
+}
+
+
+void
+XgponKey::SetKeyData (const uint8_t* data)
+{
+  memcpy (m_keyData, data, sizeof (m_keyData));
+  XgponAesCtr::ExpandKey (m_keyData, m_roundKeys);
+  m_hasKeyData = true;
 }
 
 
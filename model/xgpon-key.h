@@ -23,6 +23,8 @@
 
 #include "ns3/object.h"
 
+#include "xgpon-aes-ctr.h"
+
 
 
 namespace ns3 {
@@ -30,8 +32,8 @@ namespace ns3 {
 /**
  * \ingroup xgpon
  * \brief The key used by XG-PON to encrypt downstream (or upstream) traffic.
- *        It's a stub class for designing the interactions/interfaces.
- *        Data encryption won't be carried for saving CPU.
+ *        It holds one AES-128 key and its round keys (expanded once when the key is set).
+ *        Data encryption is only carried out when XgponAesCtr is enabled (for saving CPU).
  */
 
 class XgponKey : public Object
@@ -47,12 +49,49 @@ public:
   void DeepCopy(const Ptr<XgponKey>& key);
 
 
+  /**
+   * \brief set the 128-bit key and expand its round keys.
+   * \param data XgponAesCtr::XGPON_AES_KEY_SIZE bytes
+   */
+  void SetKeyData (const uint8_t* data);
+  bool HasKeyData ( ) const;
+
+  const uint8_t* GetKeyData ( ) const;
+  const uint8_t* GetRoundKeys ( ) const;
+
+
   ///////////////////////////////////////////////required by NS-3
   static TypeId GetTypeId (void);
   virtual TypeId GetInstanceTypeId (void) const;
+
+private:
+  bool m_hasKeyData;
+  uint8_t m_keyData[XgponAesCtr::XGPON_AES_KEY_SIZE];
+  uint8_t m_roundKeys[XgponAesCtr::XGPON_AES_ROUND_KEYS_SIZE];
 };
 
 
+
+
+//////////////////////////////////////////////////INLINE Functions
+inline bool
+XgponKey::HasKeyData ( ) const
+{
+  return m_hasKeyData;
+}
+inline const uint8_t*
+XgponKey::GetKeyData ( ) const
+{
+  return m_keyData;
+}
+inline const uint8_t*
+XgponKey::GetRoundKeys ( ) const
+{
+  NS_ASSERT_MSG(m_hasKeyData, "The key data has not been set!!!");
+  return m_roundKeys;
+}
+
+
 }; // namespace ns3
 
 #endif // XGPON_KEY_H
@@ -55,6 +55,7 @@ XgponLinkInfo::XgponLinkInfo ():
   m_eqDelay(0),
   m_ploamMsgQueue(),
   m_dyingGasp(false),
+  m_bitErrorRate(-1),
   m_ploamExistAtOnu(false)
 {
 }
@@ -142,6 +143,8 @@ void XgponLinkInfo::DeepCopy(const Ptr<XgponLinkInfo>& linkInfo)
 
   m_dyingGasp = linkInfo->m_dyingGasp;         
 
+  m_bitErrorRate = linkInfo->m_bitErrorRate;
+
   m_ploamExistAtOnu = linkInfo->m_ploamExistAtOnu;   
 }
 
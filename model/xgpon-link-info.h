@@ -93,6 +93,11 @@ public:
   void SetDyingGasp(bool state);
   bool GetDyingGasp(void) const;
 
+  //bit error rate of the link between OLT and this ONU (used by the analytic error model of XgponChannel).
+  //negative: the "BitErrorRate" of the channel is used.
+  void SetBitErrorRate (double ber);
+  double GetBitErrorRate (void) const;
+
   //ploam message queue
   void AddPloam2TxQueue (const Ptr<XgponXgtcPloam>& msg);
   const Ptr<XgponXgtcPloam> GetPloam2Transmit(void);
@@ -135,6 +140,8 @@ private:
 
   bool m_dyingGasp;         //Dying Gasp state at ONU side; maintained at both side
 
+  double m_bitErrorRate;    //the bit error rate specific to this ONU (e.g., a distant ONU); negative: the one of the channel is used.
+
   bool m_ploamExistAtOnu;   //whether this ONU has PLOAM message to be sent to the OLT; maintained at OLT side based on burst headers from ONU
 
   /* more variables may be needed, such as activation/registration/ranging state, etc. */
@@ -290,6 +297,19 @@ XgponLinkInfo::GetDyingGasp(void) const
   return m_dyingGasp;
 }
 
+
+inline void 
+XgponLinkInfo::SetBitErrorRate (double ber)
+{
+  NS_ASSERT_MSG((ber <= 1.0), "The bit error rate is larger than 1.");
+  m_bitErrorRate = ber;
+}
+inline double 
+XgponLinkInfo::GetBitErrorRate (void) const
+{
+  return m_bitErrorRate;
+}
+
 }; // namespace ns3
 
 #endif // XGPON_LINK_INFO_H
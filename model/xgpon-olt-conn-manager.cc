@@ -119,6 +119,25 @@ XgponOltConnManager::AddOneUsConn (const Ptr<XgponConnectionReceiver>& conn, uin
 
 
 
+void 
+XgponOltConnManager::AddOneDsClassConn (const Ptr<XgponConnectionSender>& conn)
+{
+  NS_LOG_FUNCTION(this);
+
+  uint8_t trafficClass = conn->GetTrafficClass ();
+  NS_ASSERT_MSG((trafficClass > 0 && !conn->IsBroadcast()), "Only unicast connections with non-zero traffic class can be registered per class!!!");
+
+  const Ptr<XgponConnectionSender>& defaultConn = FindDsConnByAddress (conn->GetUpperLayerAddr());
+  NS_ASSERT_MSG((defaultConn != nullptr && defaultConn != conn), 
+                "Per-class connection needs one distinct XGEM-port (flexible ID allocation) and must be added after the default connection!!!");
+
+  std::vector< Ptr<XgponConnectionSender> >& conns = m_dsClassConnsAddressIndex[conn->GetUpperLayerAddr()];
+  if(conns.size() <= trafficClass) conns.resize (trafficClass + 1);
+  conns[trafficClass] = conn;
+}
+
+
+
 
 
 
@@ -21,6 +21,8 @@
 #ifndef XGPON_OLT_CONN_MANAGER_H
 #define XGPON_OLT_CONN_MANAGER_H
 
+#include <map>
+
 #include "ns3/address.h"
 
 #include "xgpon-olt-engine.h"
@@ -106,6 +108,19 @@ public:
   virtual const Ptr<XgponConnectionSender>& FindBroadcastConnByAddress (const Address& addr) = 0;
 
 
+  /**
+   * \brief Register one downstream connection that carries only one traffic class for its address.
+   *        It must have been added through AddOneDsConn after the default connection of the same address.
+   */
+  void AddOneDsClassConn (const Ptr<XgponConnectionSender>& conn);
+
+  /**
+   * \brief Find one downstream connection based on the destination address and the traffic class of the packet (inline function).
+   * \return the connection of this traffic class if it exists; otherwise, the default connection of this address. 0: no found
+   */
+  const Ptr<XgponConnectionSender>& FindDsConnByAddressAndClass (const Address& addr, uint8_t trafficClass);
+
+
   /**
    * \brief Find the downstream omci connection based on onu-id (inline function). 
    * \return the corresponding XgponConnectionSender; 0: no found
@@ -145,6 +160,10 @@ protected:
   //In XgponOltConnManagerSpeed, it is also used to map ip address of the upper-layer packet to the corresponding connection (for per-onu connections).
   std::vector< Ptr<XgponConnectionSender> > m_dsConnsPortIndex;             //index == xgemPort;
 
+  //used when mapping ip address and traffic class of the upper-layer packet to the per-class connection.
+  //key = address, value = connections indexed by traffic class. Empty if no per-class connection is configured.
+  std::map< Address, std::vector< Ptr<XgponConnectionSender> > > m_dsClassConnsAddressIndex;
+
 
   void AddOneBroadcastDsConnection (const Ptr<XgponConnectionSender>& conn);
   std::vector< Ptr<XgponConnectionSender> >& GetAllBroadcastDsConnections ();  
@@ -209,6 +228,20 @@ XgponOltConnManager::GetTcontTypeById(uint16_t allocId) const
 }
 
 
+inline const Ptr<XgponConnectionSender>& 
+XgponOltConnManager::FindDsConnByAddressAndClass (const Address& addr, uint8_t trafficClass)
+{
+  if(trafficClass == 0 || m_dsClassConnsAddressIndex.empty()) return FindDsConnByAddress (addr);
+
+  std::map< Address, std::vector< Ptr<XgponConnectionSender> > >::const_iterator it = m_dsClassConnsAddressIndex.find (addr);
+  if(it != m_dsClassConnsAddressIndex.end() && trafficClass < it->second.size() && it->second[trafficClass] != nullptr) 
+  {
+    return it->second[trafficClass];
+  }
+  return FindDsConnByAddress (addr);
+}
+
+
 inline const Ptr<XgponConnectionSender>& 
 XgponOltConnManager::FindDsOmciConnByOnuId (const uint16_t onuId) const 
 {
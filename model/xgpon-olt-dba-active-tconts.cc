@@ -0,0 +1,200 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2012 University College Cork (UCC), Ireland
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jerome Arokkiam <jerome.arokkia@bt.com>
+ */
+
+#include "ns3/log.h"
+
+#include "xgpon-olt-dba-active-tconts.h"
+
+
+
+NS_LOG_COMPONENT_DEFINE ("XgponOltDbaActiveTconts");
+
+namespace ns3 {
+
+const uint32_t XgponOltDbaActiveTconts::NO_INDEX;   //std::vector::resize takes it by reference
+
+XgponOltDbaActiveTconts::XgponOltDbaActiveTconts () : m_numCandidates(0), m_currentFrame(0)
+{
+}
+XgponOltDbaActiveTconts::~XgponOltDbaActiveTconts ()
+{
+}
+
+
+
+uint32_t
+XgponOltDbaActiveTconts::AddTcont (const Ptr<XgponTcontOlt>& tcont)
+{
+  NS_ASSERT_MSG((tcont!=nullptr), "The T-CONT to be added is NULL!!!");
+
+  uint32_t index = GetIndex (tcont);
+  if(index != NO_INDEX) return index;
+
+  return AddTcont (tcont, m_tconts.size ());
+}
+
+
+uint32_t
+XgponOltDbaActiveTconts::AddTcont (const Ptr<XgponTcontOlt>& tcont, uint32_t index)
+{
+  NS_ASSERT_MSG((tcont!=nullptr), "The T-CONT to be added is NULL!!!");
+  NS_ASSERT_MSG((GetIndex (tcont) == NO_INDEX), "The T-CONT has been added into the active index before!!!");
+  NS_ASSERT_MSG((index >= m_tconts.size () || !m_tconts[index].m_added), "The index has been given to another T-CONT!!!");
+
+  uint16_t allocId = tcont->GetAllocId ();
+  if(allocId >= m_indexes.size ()) m_indexes.resize (allocId + 1, NO_INDEX);
+  m_indexes[allocId] = index;
+
+  if(index >= m_tconts.size ())
+  {
+    TcontEntry entry;
+    entry.m_dueFrame = 0;
+    entry.m_idle = false;
+    entry.m_added = false;
+    m_tconts.resize (index + 1, entry);
+    m_candidates.resize ((m_tconts.size () + 63) >> 6, 0);
+  }
+  m_tconts[index].m_added = true;
+  SetCandidate (index);   //poll it until its first report arrives
+
+  return index;
+}
+
+
+
+void
+XgponOltDbaActiveTconts::ReceiveStatusReport (const Ptr<XgponTcontOlt>& tcont, uint32_t bufOcc, uint64_t frame)
+{
+  NS_LOG_FUNCTION(this);
+
+  uint32_t index = AddTcont (tcont);
+
+  //type-1 T-CONTs get the fixed bandwidth no matter what they report.
+  if(bufOcc > 0 || tcont->GetTcontType () == XgponQosParameters::XGPON_TCONT_TYPE_1)
+  {
+    m_tconts[index].m_idle = false;   //its entries in the wheel become stale
+    SetCandidate (index);
+  }
+  else SetIdle (tcont, index, frame);
+}
+
+
+void
+XgponOltDbaActiveTconts::SetPolled (const Ptr<XgponTcontOlt>& tcont, uint64_t frame)
+{
+  uint32_t index = GetIndex (tcont);
+  if(index == NO_INDEX) return;
+
+  //the grant also works as a time-out: if the report is lost, the T-CONT is polled again one interval later.
+  if(m_tconts[index].m_idle || tcont->GetLatestBufOccupancyReport () == nullptr) SetIdle (tcont, index, frame);
+}
+
+
+void
+XgponOltDbaActiveTconts::SetIdle (const Ptr<XgponTcontOlt>& tcont, uint32_t index, uint64_t frame)
+{
+  uint16_t interval = tcont->GetServiceInterval ();
+  if(interval == 0) interval = 1;
+
+  TcontEntry& entry = m_tconts[index];
+  entry.m_idle = true;
+  entry.m_dueFrame = frame + interval;
+  ClearCandidate (index);
+
+  WheelEntry wheelEntry;
+  wheelEntry.m_index = index;
+  wheelEntry.m_dueFrame = entry.m_dueFrame;
+  m_wheel[entry.m_dueFrame & (WHEEL_SIZE - 1)].push_back (wheelEntry);
+}
+
+
+void
+XgponOltDbaActiveTconts::Advance (uint64_t frame)
+{
+  NS_LOG_FUNCTION(this);
+
+  if(frame <= m_currentFrame) return;
+
+  //every slot is visited at most once, even if the DBA engine skipped many frames.
+  uint64_t first = m_currentFrame + 1;
+  if(frame - m_currentFrame > WHEEL_SIZE) first = frame - WHEEL_SIZE + 1;
+  m_currentFrame = frame;
+
+  for(uint64_t f = first; f <= frame; f++)
+  {
+    std::vector<WheelEntry>& slot = m_wheel[f & (WHEEL_SIZE - 1)];
+
+    uint32_t kept = 0;
+    for(uint32_t i = 0; i < slot.size (); i++)
+    {
+      const WheelEntry& wheelEntry = slot[i];
+      TcontEntry& entry = m_tconts[wheelEntry.m_index];
+      if(!entry.m_idle || entry.m_dueFrame != wheelEntry.m_dueFrame) continue;   //stale
+
+      if(wheelEntry.m_dueFrame <= frame) SetCandidate (wheelEntry.m_index);   //due: keep it idle so that SetPolled re-schedules it
+      else slot[kept++] = wheelEntry;   //due in a later round of the wheel
+    }
+    slot.resize (kept);
+  }
+}
+
+
+
+uint32_t
+XgponOltDbaActiveTconts::FindFirstCandidate (uint32_t from, uint32_t to, uint64_t lanes) const
+{
+  while(from < to)
+  {
+    uint64_t word = (m_candidates[from >> 6] & lanes) >> (from & 63);
+    if(word != 0)
+    {
+      uint32_t found = from + __builtin_ctzll (word);
+      return (found < to) ? found : to;
+    }
+    from = (from | 63) + 1;   //the beginning of the next word
+  }
+  return to;
+}
+
+
+uint32_t
+XgponOltDbaActiveTconts::FindNextCandidate (uint32_t cur, uint32_t stop, uint32_t stride) const
+{
+  uint32_t num = m_tconts.size ();
+  NS_ASSERT_MSG((stop < num), "The index to stop the search is out of range!!!");
+  NS_ASSERT_MSG((stride > 0 && stride <= 64 && (stride & (stride - 1)) == 0), "The stride of the search should be a power of 2 (at most 64)!!!");
+  NS_ASSERT_MSG(((cur & (stride - 1)) == (stop & (stride - 1))), "The search should start and stop in the same lane!!!");
+
+  uint32_t lane = stop & (stride - 1);
+  uint64_t lanes = 0;
+  for(uint32_t bit = lane; bit < 64; bit += stride) lanes |= ((uint64_t) 1) << bit;
+
+  uint32_t next = cur + stride;
+  if(next >= num) next = lane;
+
+  if(next <= stop) return FindFirstCandidate (next, stop, lanes);
+
+  uint32_t found = FindFirstCandidate (next, num, lanes);
+  if(found < num) return found;
+  return FindFirstCandidate (lane, stop, lanes);
+}
+
+
+} // namespace ns3
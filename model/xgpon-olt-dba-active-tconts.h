@@ -0,0 +1,201 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2012 University College Cork (UCC), Ireland
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jerome Arokkiam <jerome.arokkia@bt.com>
+ */
+
+#ifndef XGPON_OLT_DBA_ACTIVE_TCONTS_H
+#define XGPON_OLT_DBA_ACTIVE_TCONTS_H
+
+#include <vector>
+
+#include "xgpon-tcont-olt.h"
+
+
+
+namespace ns3 {
+
+/**
+ * \ingroup xgpon
+ * \brief The index of T-CONTs that the DBA engine has to consider when producing one BWMAP.
+ *
+ * A T-CONT whose latest DBRu reports a non-zero buffer occupancy (and any type-1 T-CONT) is active.
+ * A T-CONT that reported an empty buffer is idle until it is due to be polled again, i.e., one service interval
+ * (XgponTcont::GetServiceInterval, unit: downstream frame) after its latest report or polling grant.
+ * The interval is read when the T-CONT becomes idle, since the QoS parameters may be calculated after the T-CONT is added.
+ * Idle T-CONTs are kept in a timer wheel that is keyed on this due frame, so that the work per BWMAP
+ * depends on the active T-CONTs, not on the provisioned ones.
+ *
+ * T-CONTs get dense indexes in the order they are added, unless the DBA engine lays out the indexes itself
+ * (the GIANT family interleaves the lists of the four T-CONT types). The candidates (active or due) are kept in a bitset over these indexes.
+ */
+class XgponOltDbaActiveTconts
+{
+public:
+  const static uint32_t WHEEL_SIZE = 256;                //the number of slots of the timer wheel (power of 2)
+  const static uint32_t NO_INDEX = 0xFFFFFFFF;           //the index of the T-CONTs that have not been added
+
+  /**
+   * \brief Constructor
+   */
+  XgponOltDbaActiveTconts ();
+  virtual ~XgponOltDbaActiveTconts ();
+
+
+  /**
+   * \brief add one T-CONT into the index. Nothing changes if it has been added. 
+   *        It is a candidate (to be polled) until its first report is received.
+   * \return the index of this T-CONT
+   */
+  uint32_t AddTcont (const Ptr<XgponTcontOlt>& tcont);
+
+  /**
+   * \brief add one T-CONT into the index with the given index. The indexes skipped are never candidates.
+   * \return the index of this T-CONT
+   */
+  uint32_t AddTcont (const Ptr<XgponTcontOlt>& tcont, uint32_t index);
+
+
+  /**
+   * \brief update the state of the T-CONT based on one DBRu received from it.
+   * \param frame the index of the downstream frame in which the report is received.
+   */
+  void ReceiveStatusReport (const Ptr<XgponTcontOlt>& tcont, uint32_t bufOcc, uint64_t frame);
+
+  /**
+   * \brief one (polling) grant has been given to the T-CONT. If it is idle, it will not be polled again until one service interval later.
+   * \param frame the index of the downstream frame in which the BWMAP is produced.
+   */
+  void SetPolled (const Ptr<XgponTcontOlt>& tcont, uint64_t frame);
+
+  /**
+   * \brief move the timer wheel to the frame. The idle T-CONTs due in the frames up to this one become candidates.
+   */
+  void Advance (uint64_t frame);
+
+
+  /**
+   * \return whether the T-CONT is active or due to be polled. The T-CONTs that have not been added are candidates.
+   */
+  bool IsCandidate (const Ptr<XgponTcontOlt>& tcont) const;
+
+  /**
+   * \brief find the next candidate after the index cur in the cyclic order of indexes.
+   *        With stride > 1, only the indexes of the same lane (index % stride == cur % stride) are searched.
+   * \param stride a power of 2 (at most 64); cur and stop have to be in the same lane.
+   * \return the index of the candidate; stop if the search reaches the index stop first.
+   */
+  uint32_t FindNextCandidate (uint32_t cur, uint32_t stop, uint32_t stride = 1) const;
+
+
+  uint32_t GetNumberOfTconts (void) const;
+  uint32_t GetNumberOfCandidates (void) const;
+
+
+private:
+  struct TcontEntry
+  {
+    uint64_t m_dueFrame;       //the frame in which the idle T-CONT should be polled
+    bool m_idle;               //whether the T-CONT is waiting in the timer wheel
+    bool m_added;              //false: the index is skipped by the DBA engine
+  };
+
+  struct WheelEntry
+  {
+    uint32_t m_index;          //the index of the T-CONT
+    uint64_t m_dueFrame;       //stale if the T-CONT has been re-scheduled or becomes active
+  };
+
+  uint32_t GetIndex (const Ptr<XgponTcontOlt>& tcont) const;
+
+  //put the T-CONT into the timer wheel, due one service interval after the frame
+  void SetIdle (const Ptr<XgponTcontOlt>& tcont, uint32_t index, uint64_t frame);
+
+  void SetCandidate (uint32_t index);
+  void ClearCandidate (uint32_t index);
+
+  //return the first candidate in [from, to) whose bit is set in lanes (the same 64-bit pattern for every word); to if there is no such candidate.
+  uint32_t FindFirstCandidate (uint32_t from, uint32_t to, uint64_t lanes) const;
+
+
+  std::vector<uint32_t> m_indexes;                 //indexed by alloc-id
+  std::vector<TcontEntry> m_tconts;                //indexed by the index of T-CONT
+  std::vector<uint64_t> m_candidates;              //one bit per T-CONT
+  uint32_t m_numCandidates;
+
+  std::vector<WheelEntry> m_wheel[WHEEL_SIZE];     //indexed by the due frame
+  uint64_t m_currentFrame;                         //the latest frame that the wheel has been advanced to
+};
+
+
+
+
+////////////////////////////////////////////////////INLINE Functions
+inline uint32_t
+XgponOltDbaActiveTconts::GetIndex (const Ptr<XgponTcontOlt>& tcont) const
+{
+  uint16_t allocId = tcont->GetAllocId ();
+  if(allocId < m_indexes.size ()) return m_indexes[allocId];
+  else return NO_INDEX;
+}
+
+inline bool
+XgponOltDbaActiveTconts::IsCandidate (const Ptr<XgponTcontOlt>& tcont) const
+{
+  uint32_t index = GetIndex (tcont);
+  if(index == NO_INDEX) return true;
+  return (m_candidates[index >> 6] >> (index & 63)) & 1;
+}
+
+inline void
+XgponOltDbaActiveTconts::SetCandidate (uint32_t index)
+{
+  uint64_t mask = ((uint64_t) 1) << (index & 63);
+  if((m_candidates[index >> 6] & mask) == 0)
+  {
+    m_candidates[index >> 6] |= mask;
+    m_numCandidates++;
+  }
+}
+
+inline void
+XgponOltDbaActiveTconts::ClearCandidate (uint32_t index)
+{
+  uint64_t mask = ((uint64_t) 1) << (index & 63);
+  if((m_candidates[index >> 6] & mask) != 0)
+  {
+    m_candidates[index >> 6] &= ~mask;
+    m_numCandidates--;
+  }
+}
+
+inline uint32_t
+XgponOltDbaActiveTconts::GetNumberOfTconts (void) const
+{
+  return m_tconts.size ();
+}
+
+inline uint32_t
+XgponOltDbaActiveTconts::GetNumberOfCandidates (void) const
+{
+  return m_numCandidates;
+}
+
+
+} // namespace ns3
+
+#endif /* XGPON_OLT_DBA_ACTIVE_TCONTS_H */
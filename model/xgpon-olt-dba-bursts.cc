@@ -18,6 +18,8 @@
  * Author: Xiuchao Wu <xw2@cs.ucc.ie>
  */
 
+#include <algorithm>
+
 #include "ns3/log.h"
 
 #include "xgpon-olt-dba-bursts.h"
@@ -28,9 +30,20 @@ NS_LOG_COMPONENT_DEFINE ("XgponOltDbaBursts");
 
 namespace ns3{
 
+//order the indexes of bursts by the time that the bursts were modified last.
+struct LastModifiedBefore
+{
+  LastModifiedBefore (const std::vector<uint32_t>& lastModified) : m_lastModified(lastModified) { }
+  bool operator() (uint16_t a, uint16_t b) const { return m_lastModified[a] < m_lastModified[b]; }
+  const std::vector<uint32_t>& m_lastModified;
+};
+
 
-XgponOltDbaBursts::XgponOltDbaBursts (): m_dbaPerBurstInfos(0), m_servedTconts(16384, false), m_nullPerBurstInfo(0)
+XgponOltDbaBursts::XgponOltDbaBursts (): m_dbaPerBurstInfos(0), m_modifyCounter(0),
+  m_perOnuBursts(1024), m_generation(1), m_servedTconts(16384, false), m_nullPerBurstInfo(0)
 {
+  //generation 0 marks the entries that have never been used.
+  for(uint32_t i = 0; i < m_perOnuBursts.size(); i++) m_perOnuBursts[i].m_generation = 0;
 }
 XgponOltDbaBursts::~XgponOltDbaBursts ()
 {
@@ -43,33 +56,50 @@ XgponOltDbaBursts::ClearBurstInfoList( )
 {
   NS_LOG_FUNCTION(this);
   m_dbaPerBurstInfos.clear();
-  std::fill(m_servedTconts.begin(), m_servedTconts.end(), false);
+  m_lastModified.clear();
+  m_modifyCounter = 0;
+  m_generation++;
+  m_servedTconts.Clear();
 }
 
 
-bool
-XgponOltDbaBursts::IsNewBurstNecessary(const Ptr<XgponTcontOlt>& tcont)
+XgponOltDbaBursts::PerOnuBursts&
+XgponOltDbaBursts::GetPerOnuBursts (uint16_t onuId)
 {
-  NS_LOG_FUNCTION(this);
-
-  uint16_t onuId = tcont->GetOnuId();
+  if(onuId >= m_perOnuBursts.size())
+  {
+    PerOnuBursts unused;
+    unused.m_generation = 0;
+    m_perOnuBursts.resize (onuId + 1, unused);
+  }
 
-  std::list< Ptr<XgponOltDbaPerBurstInfo> >::iterator it, end;
-  it = m_dbaPerBurstInfos.begin();
-  end = m_dbaPerBurstInfos.end();
-  while(it!=end)
+  PerOnuBursts& onuBursts = m_perOnuBursts[onuId];
+  if(onuBursts.m_generation != m_generation)
   {
-    Ptr<XgponOltDbaPerBurstInfo> perBurstInfo = *it;
-    if(perBurstInfo->GetOnuId()==onuId)
+    onuBursts.m_generation = m_generation;
+    onuBursts.m_openBurst = NO_BURST;
+    onuBursts.m_numInFullBursts = 0;
+  }
+  else if(onuBursts.m_openBurst != NO_BURST)
+  {
+    //the burst may have been filled up since the last lookup.
+    uint32_t num = m_dbaPerBurstInfos[onuBursts.m_openBurst]->GetBwAllocNumber();
+    if(num >= XgponOltDbaPerBurstInfo::MAX_TCONT_PER_BURST)
     {
-      if(perBurstInfo->GetBwAllocNumber() < XgponOltDbaPerBurstInfo::MAX_TCONT_PER_BURST)
-      {
-        return false;
-      }
+      onuBursts.m_numInFullBursts += num;
+      onuBursts.m_openBurst = NO_BURST;
     }
-    it++;
   }
-  return true;
+  return onuBursts;
+}
+
+
+bool
+XgponOltDbaBursts::IsNewBurstNecessary(const Ptr<XgponTcontOlt>& tcont)
+{
+  NS_LOG_FUNCTION(this);
+
+  return (GetPerOnuBursts (tcont->GetOnuId()).m_openBurst == NO_BURST);
 }
 
 
@@ -81,33 +111,20 @@ XgponOltDbaBursts::GetBurstInfo4TcontOlt(const Ptr<XgponTcontOlt>& tcont)
 {
   NS_LOG_FUNCTION(this);
 
-  uint16_t onuId = tcont->GetOnuId();
-  uint32_t num4Onu=0;
+  PerOnuBursts& onuBursts = GetPerOnuBursts (tcont->GetOnuId());
 
-  std::list< Ptr<XgponOltDbaPerBurstInfo> >::iterator it, end;
-  it = m_dbaPerBurstInfos.begin();
-  end = m_dbaPerBurstInfos.end();
-  while(it!=end)
+  if(onuBursts.m_openBurst != NO_BURST)
   {
-    Ptr<XgponOltDbaPerBurstInfo> perBurstInfo = *it;
-    if(perBurstInfo->GetOnuId()==onuId)
-    {
-      if(perBurstInfo->GetBwAllocNumber() < XgponOltDbaPerBurstInfo::MAX_TCONT_PER_BURST)
-      {
-        m_dbaPerBurstInfos.erase(it);
-        m_dbaPerBurstInfos.push_front(perBurstInfo);
-        return perBurstInfo;
-      }
-      else num4Onu += perBurstInfo->GetBwAllocNumber();
-    }
-    it++;
+    m_lastModified[onuBursts.m_openBurst] = ++m_modifyCounter;
+    return m_dbaPerBurstInfos[onuBursts.m_openBurst];
   }
 
-  if(num4Onu < MAX_TCONT_PER_ONU)
+  if(onuBursts.m_numInFullBursts < MAX_TCONT_PER_ONU)
   {
-    Ptr<XgponOltDbaPerBurstInfo> perBurstInfo = Create<XgponOltDbaPerBurstInfo> ();
-    m_dbaPerBurstInfos.push_front(perBurstInfo);
-    return perBurstInfo;
+    onuBursts.m_openBurst = m_dbaPerBurstInfos.size();
+    m_dbaPerBurstInfos.push_back(Create<XgponOltDbaPerBurstInfo> ());
+    m_lastModified.push_back(++m_modifyCounter);
+    return m_dbaPerBurstInfos.back();
   } else return m_nullPerBurstInfo;  //no more bandwidth allocation for this ONU
 }
 
@@ -115,6 +132,26 @@ XgponOltDbaBursts::GetBurstInfo4TcontOlt(const Ptr<XgponTcontOlt>& tcont)
 
 
 
+uint16_t
+XgponOltDbaBursts::OptimiseBursts(uint16_t freeSpace, uint64_t rtt, uint64_t slotSize, uint8_t baseGrantSize)
+{
+  NS_LOG_FUNCTION(this);
+
+  m_burstOrder.resize(m_dbaPerBurstInfos.size());
+  for(uint16_t i = 0; i < m_burstOrder.size(); i++) m_burstOrder[i] = i;
+  std::sort(m_burstOrder.begin(), m_burstOrder.end(), LastModifiedBefore(m_lastModified));
+
+  //the padding is within the last FEC codeword of each burst. Thus, the final burst size grows exactly by the padding.
+  uint16_t addedSize = 0;
+  for(uint16_t i = m_burstOrder.size(); i > 0 && addedSize < freeSpace; i--)
+  {
+    const Ptr<XgponOltDbaPerBurstInfo>& perBurstInfo = m_dbaPerBurstInfos[m_burstOrder[i-1]];
+    addedSize += perBurstInfo->PadLastFecCodeword(freeSpace - addedSize, rtt, slotSize, baseGrantSize);
+  }
+  return addedSize;
+}
+
+
 const Ptr<XgponXgtcBwmap>
 XgponOltDbaBursts::ProduceBwmapFromBursts(uint64_t now, uint16_t extraAllocationInLastBwmap, uint16_t usFrameSize, uint8_t baseGrantSize)
 {
@@ -142,25 +179,24 @@ XgponOltDbaBursts::ProduceBwmapFromBursts(uint64_t now, uint16_t extraAllocation
   } else{
     uint16_t startTime = extraAllocationInLastBwmap;
 
-    //When added bwalloc into the bursts, we maintain the last modified burst as the head of the list.
-    //Thus, we should process the list from the tail to the head so that the last modified burst will be the last one in the BWMAP.
+    //The bursts are put into the BWMAP in the order that they were modified last, so that the last modified burst will be the last one in the BWMAP.
     //Otherwise, if the last modified one has over-allocated the upstream frame, 
     //some short bursts that are behind the last modified one in bwmap may be in trouble.
     //their starttime might be larger than usFrameSize and the corresponding bursts cannot be received correctly by the OLT.
-    std::list< Ptr<XgponOltDbaPerBurstInfo> >::reverse_iterator rit, rend;
-    rit = m_dbaPerBurstInfos.rbegin();
-    rend = m_dbaPerBurstInfos.rend();
-    while(rit!=rend)
+    m_burstOrder.resize(m_dbaPerBurstInfos.size());
+    for(uint16_t i = 0; i < m_burstOrder.size(); i++) m_burstOrder[i] = i;
+    std::sort(m_burstOrder.begin(), m_burstOrder.end(), LastModifiedBefore(m_lastModified));
+
+    for(uint16_t i = 0; i < m_burstOrder.size(); i++)
     {
-			//std::cout << "startTime," << startTime << ",usFrameSize," << usFrameSize << ",phyOverhead: " << (*rit)->GetGapPhyOverhead( ) << ",Bytes,inBlocks," << ((*rit)->GetGapPhyOverhead( )/baseGrantSize) << std::endl;
-      startTime += ((*rit)->GetGapPhyOverhead( ))/baseGrantSize;
+      const Ptr<XgponOltDbaPerBurstInfo>& perBurstInfo = m_dbaPerBurstInfos[m_burstOrder[i]];
+			//std::cout << "startTime," << startTime << ",usFrameSize," << usFrameSize << ",phyOverhead: " << perBurstInfo->GetGapPhyOverhead( ) << ",Bytes,inBlocks," << (perBurstInfo->GetGapPhyOverhead( )/baseGrantSize) << std::endl;
+      startTime += (perBurstInfo->GetGapPhyOverhead( ))/baseGrantSize;
       NS_ASSERT_MSG((startTime<usFrameSize), "StartTime in the BWMAP to be generated is large than the upstream frame size!!!");
     
-      (*rit)->PutAllBwAllocIntoBwmap(map, startTime, now);
-      startTime -= ((*rit)->GetGapPhyOverhead( ))/baseGrantSize;
-      startTime += ((*rit)->GetFinalBurstSize( ))/baseGrantSize;
-
-      rit++;
+      perBurstInfo->PutAllBwAllocIntoBwmap(map, startTime, now);
+      startTime -= (perBurstInfo->GetGapPhyOverhead( ))/baseGrantSize;
+      startTime += (perBurstInfo->GetFinalBurstSize( ))/baseGrantSize;
     }
 
     return map;
@@ -170,13 +206,13 @@ XgponOltDbaBursts::ProduceBwmapFromBursts(uint64_t now, uint16_t extraAllocation
 bool
 XgponOltDbaBursts::CheckServedTcont(uint64_t allocId)
 {
-  return m_servedTconts[allocId];
+  return m_servedTconts.IsSet(allocId);
 }
 
 void
 XgponOltDbaBursts::SetServedTcont(uint64_t allocId)
 {
-  m_servedTconts[allocId]=true;
+  m_servedTconts.Set(allocId, true);
 }
 
 
@@ -21,9 +21,10 @@
 #ifndef XGPON_OLT_DBA_BURSTS_H
 #define XGPON_OLT_DBA_BURSTS_H
 
-#include <list>
+#include <vector>
 
 #include "xgpon-olt-dba-per-burst-info.h"
+#include "xgpon-epoch-table.h"
 
 
 
@@ -32,10 +33,15 @@ namespace ns3 {
 /**
  * \ingroup xgpon
  * \brief The class used to maintain the bursts for producing BWMAP. Note that one onu may have multiple bursts.
+ *
+ * The bursts are kept in an array in the order they are created. Each ONU has an entry (indexed by ONU-ID) that points to
+ * its burst that still has room for more bandwidth allocations; the entries are invalidated for a new BWMAP by increasing a generation number.
+ * The order of bursts in the BWMAP is decided by the time that they are modified last (see ProduceBwmapFromBursts).
  */
 class XgponOltDbaBursts
 {
   const static uint32_t MAX_TCONT_PER_ONU=64;            //at most, 64 T-CONTs of one ONU can be scheduled in the bwmap, i.e., 4 bursts.
+  const static uint16_t NO_BURST=0xFFFF;                 //the ONU has no burst with room for more bandwidth allocations.
 
 public:
 
@@ -65,6 +71,17 @@ public:
 
 
 
+  /**
+   * \brief optimisation stage before producing the bwmap: the space left at the end of the upstream frame is used to pad 
+   *        the grants of the bursts up to the boundaries of their last (shortened) FEC codewords, which needs no extra parity.
+   *        The bursts are visited from the last modified one, as the grants cut by the end of the frame are in these bursts.
+   *        Note that the T-CONTs of one ONU have been put into one burst (see GetBurstInfo4TcontOlt) when producing the bwmap.
+   * \return the size added into the bursts (unit: blocks)
+   * \param freeSpace the space left at the end of the upstream frame (unit: blocks)
+   * \param rtt, slotSize used to calculate the data that the T-CONTs still have
+   */
+  uint16_t OptimiseBursts(uint16_t freeSpace, uint64_t rtt, uint64_t slotSize, uint8_t baseGrantSize);
+
   /**
    * \brief produce the final bwmap based on the info of the burst list. the bwmap is also stored for receiving the bursts in the future.
    * \return the generated BWmap
@@ -91,8 +108,29 @@ public:
 
 
 private:
-  std::list< Ptr<XgponOltDbaPerBurstInfo> > m_dbaPerBurstInfos;
-  std::vector<bool> m_servedTconts;
+  /**
+   * \brief the bursts of one ONU in the BWMAP being produced.
+   */
+  struct PerOnuBursts
+  {
+    uint32_t m_generation;        //the entry is valid only when it equals m_generation of this class
+    uint16_t m_openBurst;         //the index of the burst that may still have room. NO_BURST: no such burst.
+    uint16_t m_numInFullBursts;   //the number of bandwidth allocations in the full bursts of this ONU
+  };
+
+  //return the entry of the ONU (reset if it was used for the last BWMAP)
+  PerOnuBursts& GetPerOnuBursts (uint16_t onuId);
+
+
+  std::vector< Ptr<XgponOltDbaPerBurstInfo> > m_dbaPerBurstInfos;   //in the order that the bursts are created
+  std::vector<uint32_t> m_lastModified;                           //when each burst was returned by GetBurstInfo4TcontOlt (a counter)
+  std::vector<uint16_t> m_burstOrder;                             //indexes of bursts in the BWMAP (kept to reuse the memory)
+  uint32_t m_modifyCounter;
+
+  std::vector<PerOnuBursts> m_perOnuBursts;                       //indexed by ONU-ID
+  uint32_t m_generation;                                          //increased for each BWMAP
+
+  XgponEpochTable<bool> m_servedTconts;                           //indexed by alloc-id; cleared for each BWMAP
 
   //used to return one null perburstinfo
   Ptr<XgponOltDbaPerBurstInfo> m_nullPerBurstInfo;
@@ -0,0 +1,272 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2012 University College Cork (UCC), Ireland
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jerome Arokkiam <jerome.arokkia@bt.com>
+ */
+
+#ifndef XGPON_OLT_DBA_ENGINE_GIANT_CORE_H
+#define XGPON_OLT_DBA_ENGINE_GIANT_CORE_H
+
+#include <stdint.h>
+
+#include "ns3/assert.h"
+#include "ns3/ptr.h"
+
+#include "xgpon-olt-dba-engine.h"
+#include "xgpon-olt-dba-giant-cycle.h"
+#include "xgpon-qos-parameters.h"
+#include "xgpon-tcont-olt.h"
+
+
+
+namespace ns3 {
+
+/**
+ * \ingroup xgpon
+ * \brief The code shared by the DBA engines of the GIANT family (GIANT, XGIANT, XGIANT-deficit, XGIANT-prop) and EBU.
+ *
+ * The engine (Engine) derives from this class with itself as the first template parameter; Cycle is the order
+ * in which its T-CONTs are visited (XgponOltDbaGiantCycle or XgponOltDbaEbuCycle).
+ * The T-CONTs of one frame are served by XgponOltDbaEngine::ServeTcontsInOrder with this class as the walker, which calls
+ * Cycle and Engine::CalculateAmountData2Upload directly: there is no virtual call per T-CONT.
+ * With ActiveTcontIndex, the cursor steps with XgponOltDbaActiveTconts::FindNextCandidate over the T-CONTs of each type,
+ * so the work per frame depends on the active T-CONTs, not on the provisioned ones.
+ *
+ * The engine may hide the following functions to keep its own state:
+ *   void OnTcontAdded (const Ptr<XgponTcontOlt>& tcont);   //after the T-CONT is added to the cycle
+ *   void OnCycleStep (XgponGiantStep step);               //after the cursor moved to the next T-CONT
+ * The engine has to declare this class as a friend, since these functions and CalculateAmountData2Upload are private.
+ */
+template <class Engine, class Cycle>
+class XgponOltDbaEngineGiantCore : public XgponOltDbaEngine
+{
+public:
+  const static uint32_t ALLOC_PER_SERVICE_MAX_SIZE=1000;    //1K words (4Kbytes). TODO: replace with one attribute
+  const static uint32_t MAX_POLLING_INTERVAL=10000000;      //10ms. Unit: nanosecond
+  const static uint32_t TIMER_EXPIRE_VALUE=0;               //Value at which the timer expires. Unit: frames.
+
+  /**
+   * \brief Constructor
+   */
+  XgponOltDbaEngineGiantCore ();
+  virtual ~XgponOltDbaEngineGiantCore ();
+
+  /**
+   * \brief calculate the QoS parameters and the allocation words of the T-CONT and add it to the cycle.
+   * \param tcont the T-CONT to be added to the engine
+   */
+  virtual void AddTcontToDbaEngine (Ptr<XgponTcontOlt>& tcont);
+
+  /**
+   * \brief nothing to be done after producing the BWmap (engines with timers override it).
+   */
+  virtual void FinalizeBwmapProduction ();
+
+  //move the cursor to the next T-CONT; return whether all T-CONTs were visited in this DBA cycle
+  virtual bool CheckAllTcontsServed ();
+
+protected:
+  //Get the allocation bytes using service rate and SI. return in unit:words
+  uint32_t GetAllocationBytesFromRateAndServiceInterval (uint32_t rate, uint16_t si);
+
+  //the default hooks (nothing to be done)
+  void OnTcontAdded (const Ptr<XgponTcontOlt>& tcont);
+  void OnCycleStep (XgponGiantStep step);
+
+  Cycle m_cycle;      //the T-CONTs (one list per type) and the cursor of the DBA cycle
+
+  //to store the total requested allocation in words, from the view of a single frame
+  uint32_t m_nonBestEffortAllocationInWords, m_totalAllocationInWords;
+
+private:
+  friend class XgponOltDbaEngine;   //ServeTcontsInOrder walks the T-CONTs through the functions below
+
+  virtual uint16_t ServeTcontsOfFrame (uint64_t nowNano, bool cycleStart, uint32_t usPhyFrameSize, uint16_t allocatedSize, uint32_t& numScheduledTconts);
+
+  virtual const Ptr<XgponTcontOlt>& GetNextTcontOlt ( );
+  virtual const Ptr<XgponTcontOlt>& GetCurrentTcontOlt ( );
+  virtual const Ptr<XgponTcontOlt>& GetFirstTcontOlt ( );
+  virtual void Prepare2ProduceBwmap ( );
+
+  //the walker of ServeTcontsInOrder
+  const Ptr<XgponTcontOlt>& FirstTcont (void);
+  const Ptr<XgponTcontOlt>& CurrentTcont (void);
+  const Ptr<XgponTcontOlt>& NextTcont (void);
+  uint32_t CalculateGrant (const Ptr<XgponTcontOlt>& tcontOlt, uint32_t allocatedSize, uint64_t nowNano);
+  bool AllTcontsServed (void);
+};
+
+
+
+
+////////////////////////////////////////////////////INLINE Functions
+template <class Engine, class Cycle>
+XgponOltDbaEngineGiantCore<Engine, Cycle>::XgponOltDbaEngineGiantCore ()
+  : XgponOltDbaEngine(),
+    m_cycle(),
+    m_nonBestEffortAllocationInWords(0),
+    m_totalAllocationInWords(0)
+{
+}
+
+template <class Engine, class Cycle>
+XgponOltDbaEngineGiantCore<Engine, Cycle>::~XgponOltDbaEngineGiantCore ()
+{
+}
+
+template <class Engine, class Cycle>
+inline void
+XgponOltDbaEngineGiantCore<Engine, Cycle>::AddTcontToDbaEngine (Ptr<XgponTcontOlt>& tcont)
+{
+  /* Each TCONT is updated with its respective service rates and service intervals (only min and max SI for GIANT).
+   * Instead of using 4 pairs of <XgponOltTcont,XgponOltDbaParametersGiant> for 4 TCONT types, the parameters are kept in XgponTcontOlt.
+   */
+
+  //initially, allocatedRate, sI are calculated
+  XgponQosParameters::XgponTcontType type = tcont->GetTcontType();
+  tcont->CalculateTcontQosParameters(type);
+  //then allocationWords is calculated.
+  tcont->SetAllocationWords (GetAllocationBytesFromRateAndServiceInterval(tcont->GetAllocatedRate(), tcont->GetServiceInterval()));
+  //sI timer is implemented as a parameter of tcont olt. One TCONT can have only one type...!!!
+
+  //TODO: these will be used to prevent BE starvation by reserving a portion of total US transmission opportunity.
+  if ( type != XgponQosParameters::XGPON_TCONT_TYPE_4 )
+    m_nonBestEffortAllocationInWords += tcont->GetAllocationWords(); 	//total BW requirement without BE
+  m_totalAllocationInWords += tcont->GetAllocationWords();	//total BW requirement including BE
+  //the cycle lays out the indexes of its T-CONTs, so that the cursor can jump over the idle ones (see AllTcontsServed).
+  m_activeTconts.AddTcont (tcont, m_cycle.AddTcont(tcont));
+
+  static_cast<Engine*> (this)->OnTcontAdded (tcont);
+}
+
+template <class Engine, class Cycle>
+inline void
+XgponOltDbaEngineGiantCore<Engine, Cycle>::FinalizeBwmapProduction ()
+{
+}
+
+template <class Engine, class Cycle>
+inline bool
+XgponOltDbaEngineGiantCore<Engine, Cycle>::CheckAllTcontsServed ()
+{
+  return AllTcontsServed ();
+}
+
+template <class Engine, class Cycle>
+inline uint32_t
+XgponOltDbaEngineGiantCore<Engine, Cycle>::GetAllocationBytesFromRateAndServiceInterval (uint32_t rate, uint16_t si)
+{
+  uint64_t tmp64;
+
+  tmp64=(uint64_t)rate*(uint64_t)GetFrameSlotSize(); 	//GetFrameSlotSize()=125us=125000ns
+  tmp64=tmp64*(uint64_t)si;  	//rate is in bps and frame slot size is in nanoseconds
+  tmp64=tmp64/1000000000;     	//Get value in bits
+  tmp64 = (tmp64/32)*32;        //Make the value a multiple of 32 (for unit:word)
+
+  return tmp64/32;			//unit:word
+}
+
+template <class Engine, class Cycle>
+inline void
+XgponOltDbaEngineGiantCore<Engine, Cycle>::OnTcontAdded (const Ptr<XgponTcontOlt>& tcont)
+{
+}
+
+template <class Engine, class Cycle>
+inline void
+XgponOltDbaEngineGiantCore<Engine, Cycle>::OnCycleStep (XgponGiantStep step)
+{
+}
+
+template <class Engine, class Cycle>
+inline uint16_t
+XgponOltDbaEngineGiantCore<Engine, Cycle>::ServeTcontsOfFrame (uint64_t nowNano, bool cycleStart, uint32_t usPhyFrameSize, uint16_t allocatedSize, uint32_t& numScheduledTconts)
+{
+  return ServeTcontsInOrder (*this, nowNano, cycleStart, usPhyFrameSize, allocatedSize, numScheduledTconts);
+}
+
+template <class Engine, class Cycle>
+inline const Ptr<XgponTcontOlt>&
+XgponOltDbaEngineGiantCore<Engine, Cycle>::GetNextTcontOlt ( )
+{
+  return NextTcont ();
+}
+
+template <class Engine, class Cycle>
+inline const Ptr<XgponTcontOlt>&
+XgponOltDbaEngineGiantCore<Engine, Cycle>::GetCurrentTcontOlt ( )
+{
+  return CurrentTcont ();
+}
+
+template <class Engine, class Cycle>
+inline const Ptr<XgponTcontOlt>&
+XgponOltDbaEngineGiantCore<Engine, Cycle>::GetFirstTcontOlt ( )
+{
+  return FirstTcont ();
+}
+
+template <class Engine, class Cycle>
+inline void
+XgponOltDbaEngineGiantCore<Engine, Cycle>::Prepare2ProduceBwmap ( )
+{
+}
+
+template <class Engine, class Cycle>
+inline const Ptr<XgponTcontOlt>&
+XgponOltDbaEngineGiantCore<Engine, Cycle>::FirstTcont (void)
+{
+  //T1 is always served first every DBA cycle; the end of the cycle (m_cycle.IsStopped()) is reset here.
+  return m_cycle.StartCycle ();
+}
+
+template <class Engine, class Cycle>
+inline const Ptr<XgponTcontOlt>&
+XgponOltDbaEngineGiantCore<Engine, Cycle>::CurrentTcont (void)
+{
+  return m_cycle.GetCurrent ();
+}
+
+template <class Engine, class Cycle>
+inline const Ptr<XgponTcontOlt>&
+XgponOltDbaEngineGiantCore<Engine, Cycle>::NextTcont (void)
+{
+  //the cursor is only moved by AllTcontsServed.
+  return m_cycle.GetCurrent ();
+}
+
+template <class Engine, class Cycle>
+inline uint32_t
+XgponOltDbaEngineGiantCore<Engine, Cycle>::CalculateGrant (const Ptr<XgponTcontOlt>& tcontOlt, uint32_t allocatedSize, uint64_t nowNano)
+{
+  //the qualified call is bound at compile time.
+  return static_cast<Engine*> (this)->Engine::CalculateAmountData2Upload (tcontOlt, allocatedSize, nowNano);
+}
+
+template <class Engine, class Cycle>
+inline bool
+XgponOltDbaEngineGiantCore<Engine, Cycle>::AllTcontsServed (void)
+{
+  //with ActiveTcontIndex, the idle T-CONTs that are not due to be polled are not visited at all.
+  static_cast<Engine*> (this)->OnCycleStep (m_cycle.Advance (m_activeTcontIndex ? &m_activeTconts : 0));
+  return m_cycle.IsStopped ();
+}
+
+
+} // namespace ns3
+
+#endif /* XGPON_OLT_DBA_ENGINE_GIANT_CORE_H */
@@ -0,0 +1,278 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2012 University College Cork (UCC), Ireland
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jerome Arokkiam <jerome.arokkia@bt.com>
+ */
+
+#include <algorithm>
+
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+
+#include "xgpon-olt-dba-engine-max-min.h"
+#include "xgpon-olt-net-device.h"
+
+
+
+
+NS_LOG_COMPONENT_DEFINE ("XgponOltDbaEngineMaxMin");
+
+namespace ns3{
+
+NS_OBJECT_ENSURE_REGISTERED (XgponOltDbaEngineMaxMin);
+
+TypeId 
+XgponOltDbaEngineMaxMin::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::XgponOltDbaEngineMaxMin")
+    .SetParent<XgponOltDbaEngine> ()
+    .AddConstructor<XgponOltDbaEngineMaxMin> ()
+    .AddAttribute ("MaxServiceSize", 
+                   "The maximal number of blocks that could be allocated to one T-CONT in a bandwidth allocation (Unit: block).",
+                   UintegerValue (9718),
+                   MakeUintegerAccessor (&XgponOltDbaEngineMaxMin::m_maxServiceSize),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+TypeId
+XgponOltDbaEngineMaxMin::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+
+
+
+XgponOltDbaEngineMaxMin::XgponOltDbaEngineMaxMin () : XgponOltDbaEngine(),
+  m_bwmapCounter(0),
+  m_firstIndex(0),
+  m_currentIndex(0),
+  m_nullTcont(0)
+{
+}
+XgponOltDbaEngineMaxMin::~XgponOltDbaEngineMaxMin ()
+{
+}
+
+
+
+
+void 
+XgponOltDbaEngineMaxMin::AddTcontToDbaEngine (Ptr<XgponTcontOlt>& tcont)
+{
+  NS_LOG_FUNCTION(this);
+
+  //the idle T-CONTs are polled once per service interval (not in every BWMAP), whatever ActiveTcontIndex is.
+  m_activeTcontIndex = true;
+
+  m_usAllTconts.push_back(tcont);
+  m_grants.push_back(0);
+  m_activeTconts.AddTcont(tcont);
+  return;
+} 
+
+
+
+uint32_t
+XgponOltDbaEngineMaxMin::GetSizePerFrameFromRate (uint32_t rate)
+{
+  //rate is in bps and frame slot size is in nanoseconds (the same as GIANT)
+  uint64_t bits = (uint64_t)rate * (uint64_t)GetFrameSlotSize() / 1000000000;
+  return bits / (8 * m_baseGrantSize);
+}
+
+
+uint32_t
+XgponOltDbaEngineMaxMin::GetBurstOverhead (uint16_t onuId)
+{
+  const Ptr<XgponBurstProfile>& profile = m_device->GetPloamEngine()->GetLinkInfo(onuId)->GetCurrentProfile();
+  uint16_t guardTime = (m_device->GetXgponPhy())->GetUsMinimumGuardTime ();
+
+  //unit: Bytes (as XgponOltDbaPerBurstInfo::Initialize); the XGTC header and trailer are one block each.
+  uint32_t overhead = guardTime * m_baseGrantSize + profile->GetPreambleLen () + profile->GetDelimiterLen () + 2 * m_baseGrantSize;
+  return (overhead + m_baseGrantSize - 1) / m_baseGrantSize;
+}
+
+
+
+void 
+XgponOltDbaEngineMaxMin::Prepare2ProduceBwmap ( )
+{
+  NS_LOG_FUNCTION(this);
+
+  uint32_t num = m_usAllTconts.size();
+  if(num == 0) return;
+
+  const Ptr<XgponPhy>& phy = m_device->GetXgponPhy();
+  const Ptr<XgponOltPloamEngine>& ploamEngine = m_device->GetPloamEngine();
+
+  //the space of this frame, minus the over-allocation of the last frame and the same margin as GenerateBwMap.
+  int64_t capacity = (int64_t) phy->GetUsPhyFrameSizeInBlocks() - GetExtraInLastBwmap() - 10;
+
+  m_bwmapCounter++;
+  m_residualDemands.clear();
+  std::fill (m_grants.begin(), m_grants.end(), 0);
+
+  //first step: guaranteed shares and the fixed costs (bursts, DBRu, polling).
+  //The T-CONTs are visited in the order of ServeTcontsInOrder (from m_firstIndex), which stops once the frame is full
+  //or MAX_TCONT_PER_BWMAP T-CONTs are scheduled: the T-CONTs after that point get nothing in this BWMAP.
+  uint32_t numScheduled = 0;
+  for(uint32_t k = 0; k < num && capacity > 0 && numScheduled < MAX_TCONT_PER_BWMAP; k++)
+  {
+    uint32_t i = (m_firstIndex + k) % num;
+    const Ptr<XgponTcontOlt>& tcont = m_usAllTconts[i];
+    if(!m_activeTconts.IsCandidate (tcont)) continue;   //idle and not due to be polled: not visited in this BWMAP
+    numScheduled++;
+
+    uint16_t onuId = tcont->GetOnuId();
+    if(onuId >= m_onuStamps.size()) m_onuStamps.resize(onuId + 1, 0);
+    if(m_onuStamps[onuId] != m_bwmapCounter)
+    {
+      m_onuStamps[onuId] = m_bwmapCounter;
+      capacity -= GetBurstOverhead (onuId);
+    }
+    capacity -= 1;   //DBRu, or the polling grant
+
+    //the QoS parameters may be changed during the simulation; thus, the guaranteed size is calculated for each BWMAP.
+    const Ptr<XgponQosParameters>& qos = tcont->GetQosParameters();
+    uint32_t guaranteed = GetSizePerFrameFromRate(qos->GetFixedBw()) + GetSizePerFrameFromRate(qos->GetAssuredBw());
+    uint32_t demand = std::min (tcont->CalculateRemainingDataToServe(GetRtt(), GetFrameSlotSize()), m_maxServiceSize);
+
+    if(tcont->GetTcontType() == XgponQosParameters::XGPON_TCONT_TYPE_1)
+    {
+      m_grants[i] = std::min (guaranteed, m_maxServiceSize);   //fixed bandwidth is given no matter what is reported
+    }
+    else m_grants[i] = std::min (demand, guaranteed);
+    if(m_grants[i] > 0 && m_grants[i] < MIN_GRANT_SIZE) m_grants[i] = MIN_GRANT_SIZE;   //as CalculateAmountData2Upload does
+
+    if(demand > m_grants[i]) m_residualDemands.push_back (std::make_pair (demand - m_grants[i], (uint16_t) i));
+    capacity -= m_grants[i];
+  }
+
+  if(capacity <= 0 || m_residualDemands.empty()) return;
+
+
+  //second step: water-filling. The demands are sorted (ascending); each T-CONT gets the min of its demand and an equal share of what is left.
+  std::sort (m_residualDemands.begin(), m_residualDemands.end());
+
+  uint32_t remaining = m_residualDemands.size();
+  for(uint32_t k = 0; k < m_residualDemands.size(); k++, remaining--)
+  {
+    uint32_t share = capacity / remaining;
+    uint32_t index = m_residualDemands[k].second;
+    uint32_t demand = m_residualDemands[k].first;
+
+    //FEC parity: the grant takes more space in the frame than the data it carries.
+    const Ptr<XgponBurstProfile>& profile = ploamEngine->GetLinkInfo(m_usAllTconts[index]->GetOnuId())->GetCurrentProfile();
+    uint64_t space = GetFrameSpace (demand, profile->GetFec());
+
+    uint32_t extra = demand;
+    if(space > share)
+    {
+      space = share;
+      extra = profile->GetFec() ? (space * phy->GetUsFecBlockDataSize() / phy->GetUsFecBlockSize()) : space;
+    }
+
+    //one T-CONT that only has the polling grant gets the smallest allocation or nothing.
+    if(m_grants[index] == 0 && extra < MIN_GRANT_SIZE)
+    {
+      space = GetFrameSpace (MIN_GRANT_SIZE, profile->GetFec());
+      if(extra == 0 || (int64_t) space > capacity) continue;
+      extra = MIN_GRANT_SIZE;
+    }
+
+    m_grants[index] += extra;
+    capacity -= space;
+  }
+}
+
+
+uint64_t
+XgponOltDbaEngineMaxMin::GetFrameSpace (uint32_t size, bool fec)
+{
+  if(!fec) return size;
+
+  const Ptr<XgponPhy>& phy = m_device->GetXgponPhy();
+  return ((uint64_t) size * phy->GetUsFecBlockSize() + phy->GetUsFecBlockDataSize() - 1) / phy->GetUsFecBlockDataSize();
+}
+
+
+
+uint32_t 
+XgponOltDbaEngineMaxMin::CalculateAmountData2Upload (const Ptr<XgponTcontOlt>& tcontOlt, uint32_t allocatedSize, uint64_t nowNano)
+{
+  NS_LOG_FUNCTION(this);
+  NS_ASSERT_MSG((m_usAllTconts[m_currentIndex] == tcontOlt), "The T-CONT is not the one pointed by the cursor!!!");
+
+  uint32_t size2Assign = m_grants[m_currentIndex];
+  if(size2Assign > 0)
+  {
+    if(size2Assign > m_maxServiceSize) size2Assign = m_maxServiceSize;
+    if(size2Assign < MIN_GRANT_SIZE) size2Assign = MIN_GRANT_SIZE;   //smallest allocation for receiving data from ONU
+    if(!CheckServedTcont(tcontOlt->GetAllocId())) size2Assign += 1;   //one block for queue status report
+  }
+  else size2Assign = 1;   //poll the T-CONT
+
+  return size2Assign;
+}
+
+
+
+const Ptr<XgponTcontOlt>& 
+XgponOltDbaEngineMaxMin::GetNextTcontOlt ( )
+{
+  NS_LOG_FUNCTION(this);
+
+  m_currentIndex = m_activeTconts.FindNextCandidate (m_currentIndex, m_firstIndex);
+  return m_usAllTconts[m_currentIndex];
+}
+
+const Ptr<XgponTcontOlt>& 
+XgponOltDbaEngineMaxMin::GetCurrentTcontOlt ( ) 
+{
+  //every BWMAP considers all T-CONTs, even in the middle of a DBA cycle.
+  return GetFirstTcontOlt ( );
+}
+
+const Ptr<XgponTcontOlt>&
+XgponOltDbaEngineMaxMin::GetFirstTcontOlt ( )
+{
+  if(m_usAllTconts.empty()) return m_nullTcont;
+
+  m_currentIndex = m_firstIndex;
+  return m_usAllTconts[m_currentIndex];
+}
+
+bool
+XgponOltDbaEngineMaxMin::CheckAllTcontsServed ( )
+{
+  return (m_currentIndex == m_firstIndex);
+}
+
+
+void
+XgponOltDbaEngineMaxMin::FinalizeBwmapProduction ()
+{
+  if(m_usAllTconts.empty()) return;
+
+  m_firstIndex++;
+  if(m_firstIndex >= m_usAllTconts.size()) m_firstIndex = 0;
+}
+
+
+}//namespace ns3
@@ -0,0 +1,123 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2012 University College Cork (UCC), Ireland
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jerome Arokkiam <jerome.arokkia@bt.com>
+ */
+
+#ifndef XGPON_OLT_DBA_ENGINE_MAX_MIN_H
+#define XGPON_OLT_DBA_ENGINE_MAX_MIN_H
+
+#include <vector>
+#include <utility>
+
+#include "xgpon-olt-dba-engine.h"
+
+
+
+
+namespace ns3 {
+
+/**
+ * \ingroup xgpon
+ * \brief The class used to instantiate DBA functions of XG-PON at OLT side. 
+ *        A max-min fair (water-filling) scheme is implemented in this sub-class.
+ *
+ * Before each BWMAP, the demand of every T-CONT (CalculateRemainingDataToServe, at most MaxServiceSize) is collected once.
+ * Each T-CONT first gets its guaranteed share per frame (fixed bandwidth of type-1 T-CONTs is given even without demand;
+ * assured bandwidth is given up to the demand). The rest of the upstream frame is water-filled over the remaining demands:
+ * the demands are sorted, the small ones are served completely, and the large ones share the remaining space equally.
+ * It costs O(N log N) per frame, N being the active T-CONTs. T-CONTs that reported an empty buffer are polled once per
+ * service interval (through m_activeTconts; this engine always uses the index, whatever ActiveTcontIndex is), so that
+ * no T-CONT is starved and the idle ones do not cost one burst overhead in every frame.
+ * The calculation counts what CalculateAmountData2Upload and ServeTcontsInOrder add or cut: the smallest grant (MIN_GRANT_SIZE),
+ * the DBRu (or polling) block, the margin at the end of the frame and MAX_TCONT_PER_BWMAP.
+ *
+ * Every BWMAP considers all T-CONTs, i.e., FramesPerDBAcycle is not used by this engine.
+ * The T-CONT to start with is rotated between frames, so that the T-CONTs cut off by a full frame change.
+ */
+class XgponOltDbaEngineMaxMin : public XgponOltDbaEngine
+{
+public:
+  const static uint32_t MIN_GRANT_SIZE=4;     //the smallest grant for receiving data from one T-CONT. unit: block
+
+  /**
+   * \brief Constructor
+   */
+  XgponOltDbaEngineMaxMin ();
+  virtual ~XgponOltDbaEngineMaxMin ();
+
+
+  /**
+   * \brief Add Alloc-Id info into the DBA Engine
+   * \param the Alloc-Id to be added to the engine
+   */
+  virtual void  AddTcontToDbaEngine (Ptr<XgponTcontOlt>& tcont); 
+
+
+  ///////////////////////////////////////Functions required by NS-3
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+
+private:
+  virtual const Ptr<XgponTcontOlt>& GetNextTcontOlt ( ); 
+  virtual const Ptr<XgponTcontOlt>& GetFirstTcontOlt ( );
+  virtual const Ptr<XgponTcontOlt>& GetCurrentTcontOlt ( );
+
+  /**
+   * \brief return the grant calculated for the T-CONT in Prepare2ProduceBwmap. unit: block
+   */
+  virtual uint32_t CalculateAmountData2Upload (const Ptr<XgponTcontOlt>& tcontOlt, uint32_t allocatedSize,uint64_t nowNano);
+
+  virtual bool CheckAllTcontsServed();
+
+  /**
+   * \brief collect the demands and calculate the max-min fair grants of all T-CONTs for this BWMAP.
+   */
+  virtual void Prepare2ProduceBwmap ( );
+
+  /**
+   * \brief rotate the T-CONT to start with in the next BWMAP.
+   */
+  virtual void FinalizeBwmapProduction ();
+
+  //the guaranteed size per frame calculated from the rate. unit: block
+  uint32_t GetSizePerFrameFromRate (uint32_t rate);
+
+  //the overhead of one burst of the ONU (guard time, preamble, delimiter, XGTC header and trailer). unit: block
+  uint32_t GetBurstOverhead (uint16_t onuId);
+
+  //the space that size blocks of data take in the upstream frame (with FEC parity if fec is true). unit: block
+  uint64_t GetFrameSpace (uint32_t size, bool fec);
+
+
+private:
+  std::vector< Ptr<XgponTcontOlt> > m_usAllTconts;
+  std::vector<uint32_t> m_grants;             //the grants calculated for this BWMAP (0: poll only). unit: block
+  std::vector< std::pair<uint32_t, uint16_t> > m_residualDemands;   //(demand above the guaranteed size, index); sorted for water-filling
+  std::vector<uint32_t> m_onuStamps;          //indexed by ONU-ID: the BWMAP in which a burst of this ONU has been counted
+  uint32_t m_bwmapCounter;
+
+  uint16_t m_firstIndex;        //the T-CONT that this BWMAP starts with
+  uint16_t m_currentIndex;      //the cursor
+  uint32_t m_maxServiceSize;    //the largest grant to one T-CONT. unit: block
+
+  Ptr<XgponTcontOlt> m_nullTcont;
+};
+
+}; // namespace ns3
+
+#endif // XGPON_OLT_DBA_ENGINE_MAX_MIN_H
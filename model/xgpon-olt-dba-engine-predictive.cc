@@ -0,0 +1,157 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2012 University College Cork (UCC), Ireland
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jerome Arokkiam <jerome.arokkia@bt.com>
+ */
+
+#include <algorithm>
+
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+
+#include "xgpon-olt-dba-engine-predictive.h"
+
+
+
+
+NS_LOG_COMPONENT_DEFINE ("XgponOltDbaEnginePredictive");
+
+namespace ns3{
+
+NS_OBJECT_ENSURE_REGISTERED (XgponOltDbaEnginePredictive);
+
+TypeId 
+XgponOltDbaEnginePredictive::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::XgponOltDbaEnginePredictive")
+    .SetParent<XgponOltDbaEngineRoundRobin> ()
+    .AddConstructor<XgponOltDbaEnginePredictive> ()
+    .AddAttribute ("Alpha", 
+                   "The smoothing factor of the arrival rate (level) of Holt's method.",
+                   DoubleValue (0.25),
+                   MakeDoubleAccessor (&XgponOltDbaEnginePredictive::m_alpha),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("Beta", 
+                   "The smoothing factor of the trend of the arrival rate of Holt's method.",
+                   DoubleValue (0.1),
+                   MakeDoubleAccessor (&XgponOltDbaEnginePredictive::m_beta),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("MaxPredictedSize", 
+                   "The largest amount of predicted data added to one grant (Unit: block).",
+                   UintegerValue (2430),
+                   MakeUintegerAccessor (&XgponOltDbaEnginePredictive::m_maxPredictedSize),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+TypeId
+XgponOltDbaEnginePredictive::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+
+
+
+XgponOltDbaEnginePredictive::XgponOltDbaEnginePredictive () : XgponOltDbaEngineRoundRobin()
+{
+}
+XgponOltDbaEnginePredictive::~XgponOltDbaEnginePredictive ()
+{
+}
+
+
+
+XgponOltDbaEnginePredictive::ArrivalForecast&
+XgponOltDbaEnginePredictive::UpdateForecast (const Ptr<XgponTcontOlt>& tcontOlt)
+{
+  uint16_t allocId = tcontOlt->GetAllocId();
+  if(allocId >= m_forecasts.size())
+  {
+    ArrivalForecast unused;
+    unused.m_reportTime = 0;
+    unused.m_occupancy = 0;
+    unused.m_reported = 0;
+    unused.m_level = 0;
+    unused.m_trend = 0;
+    unused.m_confidence = 1;
+    unused.m_predicted = false;
+    m_forecasts.resize (allocId + 1, unused);
+  }
+
+  ArrivalForecast& forecast = m_forecasts[allocId];
+
+  const Ptr<XgponXgtcDbru>& dbru = tcontOlt->GetLatestBufOccupancyReport ();
+  if(dbru == nullptr || dbru->GetReceiveTime () == forecast.m_reportTime) return forecast;
+
+  uint64_t reportTime = dbru->GetReceiveTime ();
+  uint32_t occupancy = dbru->GetBufOcc ();
+  uint64_t reported = tcontOlt->GetAssignedSizeReported (GetRtt(), GetFrameSlotSize());
+
+  if(forecast.m_reportTime > 0 && reportTime > forecast.m_reportTime)
+  {
+    //the data arrived between the two reports: the change of occupancy plus the data sent in between.
+    double frames = (double) (reportTime - forecast.m_reportTime) / GetFrameSlotSize();
+    double arrivals = (double) occupancy + (double) (reported - forecast.m_reported) - (double) forecast.m_occupancy;
+    if(arrivals < 0) arrivals = 0;
+
+    double level = m_alpha * (arrivals / frames) + (1 - m_alpha) * (forecast.m_level + forecast.m_trend);
+    forecast.m_trend = m_beta * (level - forecast.m_level) + (1 - m_beta) * forecast.m_trend;
+    forecast.m_level = level;
+
+    //an empty queue after predicted grants means that (some of) them were wasted.
+    if(occupancy == 0 && forecast.m_predicted) forecast.m_confidence = std::max (forecast.m_confidence / 2, 1.0 / 1024);
+    else if(occupancy > 0) forecast.m_confidence = std::min (forecast.m_confidence * 2, 1.0);
+  }
+
+  forecast.m_reportTime = reportTime;
+  forecast.m_occupancy = occupancy;
+  forecast.m_reported = reported;
+  forecast.m_predicted = false;
+  return forecast;
+}
+
+
+
+uint32_t 
+XgponOltDbaEnginePredictive::CalculateAmountData2Upload (const Ptr<XgponTcontOlt>& tcontOlt, uint32_t allocatedSize, uint64_t nowNano)
+{
+  NS_LOG_FUNCTION(this);
+
+  ArrivalForecast& forecast = UpdateForecast (tcontOlt);
+  if(forecast.m_reportTime == 0) return ShapeGrant (0);   //poll the T-CONT until its first report arrives
+
+  //the data granted after the report (not counted by the report yet)
+  uint64_t unreported = tcontOlt->GetAssignedSizeTotal () - forecast.m_reported;
+
+  //the arrivals from the report time until the grant is used (one RTT later)
+  double rate = forecast.m_level + forecast.m_trend;
+  if(rate < 0) rate = 0;
+  double frames = (double) (nowNano + GetRtt() - forecast.m_reportTime) / GetFrameSlotSize();
+  double predicted = forecast.m_confidence * rate * frames;
+  if(predicted > m_maxPredictedSize) predicted = m_maxPredictedSize;
+
+  int64_t size2Assign = (int64_t) forecast.m_occupancy + (int64_t) predicted - (int64_t) unreported;
+  if(size2Assign <= 0) return ShapeGrant (0);
+
+  if(predicted >= 1) forecast.m_predicted = true;
+  return ShapeGrant ((uint32_t) size2Assign);
+}
+
+
+}//namespace ns3
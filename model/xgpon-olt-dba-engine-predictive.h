@@ -0,0 +1,90 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2012 University College Cork (UCC), Ireland
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jerome Arokkiam <jerome.arokkia@bt.com>
+ */
+
+#ifndef XGPON_OLT_DBA_ENGINE_PREDICTIVE_H
+#define XGPON_OLT_DBA_ENGINE_PREDICTIVE_H
+
+#include <vector>
+
+#include "xgpon-olt-dba-engine-round-robin.h"
+
+
+
+
+namespace ns3 {
+
+/**
+ * \ingroup xgpon
+ * \brief A round-robin DBA engine that also grants the data predicted to arrive at the ONU while its report is on the way.
+ *
+ * The latest queue occupancy report is at least one RTT old when the grant is used. For each T-CONT, the arrival rate
+ * is estimated from consecutive reports (occupancy change + data sent in between) and smoothed with Holt's linear trend method.
+ * The grant covers the reported backlog plus the arrivals predicted from the report time until the grant is used,
+ * minus the data already granted after the report. The prediction is capped (MaxPredictedSize) and scaled by a per-T-CONT
+ * confidence, which is halved whenever a report shows an empty queue after predicted grants (over-grant waste) and recovers otherwise.
+ */
+class XgponOltDbaEnginePredictive : public XgponOltDbaEngineRoundRobin
+{
+public:
+  /**
+   * \brief Constructor
+   */
+  XgponOltDbaEnginePredictive ();
+  virtual ~XgponOltDbaEnginePredictive ();
+
+
+  ///////////////////////////////////////Functions required by NS-3
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+
+private:
+  /**
+   * \brief the arrival forecast of one T-CONT (indexed by alloc-id)
+   */
+  struct ArrivalForecast
+  {
+    uint64_t m_reportTime;        //the receive time of the last report used. 0: no report has been used.
+    uint32_t m_occupancy;         //the occupancy in that report. unit: block
+    uint64_t m_reported;          //GetAssignedSizeReported at that report. unit: block
+    double m_level;               //smoothed arrival rate. unit: block per frame
+    double m_trend;               //the trend of the arrival rate. unit: block per frame per report
+    double m_confidence;          //(0, 1]: scales the prediction
+    bool m_predicted;             //whether predicted data has been granted since that report
+  };
+
+  /**
+   * \brief the reported backlog plus the predicted arrivals, minus the data granted after the report. unit: block
+   */
+  virtual uint32_t CalculateAmountData2Upload (const Ptr<XgponTcontOlt>& tcontOlt, uint32_t allocatedSize,uint64_t nowNano);
+
+  //feed the forecaster with the latest report of the T-CONT (if it has not been used).
+  ArrivalForecast& UpdateForecast (const Ptr<XgponTcontOlt>& tcontOlt);
+
+
+  std::vector<ArrivalForecast> m_forecasts;
+
+  double m_alpha;               //smoothing factor of the level
+  double m_beta;                //smoothing factor of the trend
+  uint32_t m_maxPredictedSize;  //the largest predicted size added to one grant. unit: block
+};
+
+}; // namespace ns3
+
+#endif // XGPON_OLT_DBA_ENGINE_PREDICTIVE_H
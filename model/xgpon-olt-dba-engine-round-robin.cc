@@ -66,6 +66,7 @@ XgponOltDbaEngineRoundRobin::XgponOltDbaEngineRoundRobin () : XgponOltDbaEngine(
   m_lastSchTcontIndexForFrame(0),
 	m_lastSchTcontIndexForCycle(0),
 	m_dbaCycleStart(false),
+  m_firstTcontIndex(0),
 	//m_nullTcont(0),
   m_getNextTcontAtBeginning(false)
 {
@@ -84,6 +85,10 @@ XgponOltDbaEngineRoundRobin::AddTcontToDbaEngine (Ptr<XgponTcontOlt>& tcont)
   NS_LOG_FUNCTION(this);
 
   m_usAllTconts.push_back(tcont);
+
+  //the cursor walks both lists with the same index.
+  uint32_t index = m_activeTconts.AddTcont(tcont);
+  NS_ASSERT_MSG((index == m_usAllTconts.size() - 1), "The T-CONT has been added into the active index before!!!");
   return;
 } 
 
@@ -94,8 +99,16 @@ XgponOltDbaEngineRoundRobin::GetNextTcontOlt ( )
 {
   NS_LOG_FUNCTION(this);
   
-	m_lastSchTcontIndexForFrame++;
-  if(m_lastSchTcontIndexForFrame >= m_usAllTconts.size()) m_lastSchTcontIndexForFrame = 0;
+  if(m_activeTcontIndex)
+  {
+    //jump over the idle T-CONTs, but stop at the first T-CONT of this cycle so that CheckAllTcontsServed ends the loop.
+    m_lastSchTcontIndexForFrame = m_activeTconts.FindNextCandidate (m_lastSchTcontIndexForFrame, m_firstTcontIndex);
+  }
+  else
+  {
+    m_lastSchTcontIndexForFrame++;
+    if(m_lastSchTcontIndexForFrame >= m_usAllTconts.size()) m_lastSchTcontIndexForFrame = 0;
+  }
  	//std::cout << "DBA-order: getting next tcont index " << m_lastSchTcontIndexForFrame << std::endl; 
 	return m_usAllTconts[m_lastSchTcontIndexForFrame];
 }
@@ -119,6 +132,7 @@ XgponOltDbaEngineRoundRobin::GetFirstTcontOlt ( )
 	m_dbaCycleStart = true;
   m_firstTcontOlt = m_usAllTconts[m_lastSchTcontIndexForCycle];
 	m_lastSchTcontIndexForFrame = m_lastSchTcontIndexForCycle;
+  m_firstTcontIndex = m_lastSchTcontIndexForCycle;
   NS_ASSERT_MSG((m_firstTcontOlt!=nullptr), "There is no T-CONT in the network!!!");
  	//std::cout << "DBA-order: first tcont index for cycle/frame: " << m_lastSchTcontIndexForCycle << std::endl;
   return m_firstTcontOlt;
@@ -154,8 +168,13 @@ uint32_t
 XgponOltDbaEngineRoundRobin::CalculateAmountData2Upload (const Ptr<XgponTcontOlt>& tcontOlt,	uint32_t allocatedSize, uint64_t nowNano)
 {
   uint32_t size2Assign = tcontOlt->CalculateRemainingDataToServe(GetRtt(), GetFrameSlotSize()); //unit: blocks (4 Bytes in XGPON, 16 Bytes in XGSPON)
-  
+  return ShapeGrant (size2Assign);
+}
 
+
+uint32_t
+XgponOltDbaEngineRoundRobin::ShapeGrant (uint32_t size2Assign)
+{
   //ja:update:xgsponv5; in RR DBA, n_ONUs = m_usAllTconts.size(), m_maxServiceSize is in Blocks here (9718)
 	uint16_t overheadPerONU = 188; //ja:update:xgsponv5
 	uint32_t largest2Assign = ((m_framesPerDBAcycle * m_maxServiceSize)/ m_usAllTconts.size()) - overheadPerONU; //ja:update:xgsponv5, largest value allowed for an allocId (an ONU in the RR DBA) is limited by the burst info overhead 
@@ -65,6 +65,15 @@ public:
   static TypeId GetTypeId (void);
   virtual TypeId GetInstanceTypeId (void) const;
 
+
+protected:
+  /**
+   * \brief turn the amount of data to be served into the grant size: one block is added for the queue status report, 
+   *        the grant is limited by the per-T-CONT share of the DBA cycle and no less than the smallest allocation.
+   *        0 results in a polling grant (one block). unit: block
+   */
+  uint32_t ShapeGrant (uint32_t dataSize);
+
 private:
 
   /**
@@ -120,6 +129,7 @@ private:
 	std::vector< Ptr<XgponTcontOlt> > m_usAllTconts;
   
   Ptr<XgponTcontOlt> m_firstTcontOlt;
+  uint16_t m_firstTcontIndex;      //the index of m_firstTcontOlt (the same in m_usAllTconts and m_activeTconts)
   bool m_getNextTcontAtBeginning;  //whether to get the next T-CONT at the beginning of bwmap generation
 
 };
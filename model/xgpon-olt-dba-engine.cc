@@ -19,9 +19,12 @@
  * Author: Jerome Arokkiam <jerome.arokkia@bt.com>
  */
 
+#include <algorithm>
+
 #include "ns3/log.h"
 #include "ns3/simulator.h"
 #include "ns3/uinteger.h"
+#include "ns3/boolean.h"
 
 #include "xgpon-olt-dba-engine.h"
 #include "xgpon-olt-net-device.h"
@@ -50,6 +53,16 @@ XgponOltDbaEngine::GetTypeId (void)
               UintegerValue(4),
               MakeUintegerAccessor(&XgponOltDbaEngine::m_framesPerDBAcycle),
               MakeUintegerChecker<uint8_t>())
+    .AddAttribute("ActiveTcontIndex",
+              "Whether the T-CONTs that reported an empty buffer are only visited (polled) once per service interval when producing BWMAP (it changes the polling of idle T-CONTs, hence the results, of the existing engines; the max-min engine always uses it)",
+              BooleanValue(false),
+              MakeBooleanAccessor(&XgponOltDbaEngine::m_activeTcontIndex),
+              MakeBooleanChecker())
+    .AddAttribute("PadFecCodewords",
+              "Whether the space left at the end of the upstream frame is used to pad the grants up to the boundaries of the shortened FEC codewords of the bursts",
+              BooleanValue(false),
+              MakeBooleanAccessor(&XgponOltDbaEngine::m_padFecCodewords),
+              MakeBooleanChecker())
   ;
   return tid;
 }
@@ -62,14 +75,15 @@ XgponOltDbaEngine::GetInstanceTypeId (void) const
 
 
 
-XgponOltDbaEngine::XgponOltDbaEngine (): m_bursts(), 
+XgponOltDbaEngine::XgponOltDbaEngine (): m_bursts(), m_activeTconts(), m_activeTcontIndex(false),
   m_aggregateAllocatedSize(0),
-  m_servedBwmaps(0), m_nullBwmap(0),
-  m_extraInLastBwmap(0),
+  m_servedBwmaps(SERVED_BWMAP_RING_SIZE), m_nullBwmap(0),
+  m_locatedBurstTime(0), m_locatedBwmap(0), m_locatedFirstIndex(0),
+  m_extraInLastBwmap(0), m_padFecCodewords(false),
   m_dsFrameSlotSizeInNano (0), m_logicRtt (0), m_usRate(0)
 	//m_framesPerDBAcycle(4),//ja:update:xgsponv5
 {
-  m_servedBwmaps.clear();
+  for(uint32_t i = 0; i < SERVED_BWMAP_RING_SIZE; i++) m_servedBwmaps[i].m_frame = 0;
 }
 XgponOltDbaEngine::~XgponOltDbaEngine ()
 {
@@ -92,6 +106,7 @@ XgponOltDbaEngine::ReceiveStatusReport (const Ptr<XgponXgtcDbru>& report, uint16
     //uint64_t nowNano = Simulator::Now().GetNanoSeconds();//ja:update:xgsponv5
 		//std::cout << "DBA_timing,receiving SR at,"<< time << ",allocId," << tcont->GetAllocId() << std::endl;
     tcont->ReceiveStatusReport (report, time);
+    if(m_activeTcontIndex) m_activeTconts.ReceiveStatusReport (tcont, report->GetBufOcc (), time / GetFrameSlotSize ());
   }
 }
 
@@ -105,121 +120,306 @@ XgponOltDbaEngine::GenerateBwMap ()  //unit: block of word or 4-word; we assume
   uint64_t nowNano = Simulator::Now().GetNanoSeconds();
   //std::cout << "secondsNano: " << nowNano << std::endl;
 
+  uint16_t allocatedSize = FillBursts4Frame (nowNano, m_extraInLastBwmap);
+  Ptr<XgponXgtcBwmap> map = ProduceBwmap (nowNano, allocatedSize);
+
+  FinalizeBwmapProduction();
+	//std::cout << "\t\tDBA:bw_map_finalised,at_time," << nowNano << ",totalAllocBytes," << allocatedSize*m_baseGrantSize << ",m_extraInLastBwmapBytes," << m_extraInLastBwmap*m_baseGrantSize << std::endl;
+  return map;
+}
+
+
+
+uint16_t
+XgponOltDbaEngine::FillBursts4Frame (uint64_t nowNano, uint16_t extraFromLastFrame)
+{
+  NS_LOG_FUNCTION(this);
+
+  uint64_t frame = nowNano / GetFrameSlotSize ();
+  if(m_activeTcontIndex) m_activeTconts.Advance (frame);
+
 	//std::cout << "DBA_timing: Overall cycle (nanoseconds/125000): " << nowNano/125000 << ", DBA Cycle: " << (nowNano%(m_framesPerDBAcycle*125000)/125000) << std::endl;
   const Ptr<XgponPhy>& commonPhy = m_device->GetXgponPhy();
   uint32_t usPhyFrameSize = commonPhy->GetUsPhyFrameSizeInBlocks();
-  uint16_t allocatedSize = m_extraInLastBwmap;
+  uint16_t allocatedSize = extraFromLastFrame;
   //std::cout << "m_extraInLastBwmap = " << m_extraInLastBwmap << std::endl; //ja:update:xgspon
-  NS_ASSERT_MSG((m_extraInLastBwmap < 0.5*(usPhyFrameSize)), "the last bwmap over-allocated too much!!!");
+  NS_ASSERT_MSG((extraFromLastFrame < 0.5*(usPhyFrameSize)), "the last bwmap over-allocated too much!!!");
   
 	//carry out initialization before the loop
   m_bursts.ClearBurstInfoList( );
   Prepare2ProduceBwmap ( );
 	//double perFrameAllocLimitingFactor = 1.5; //ja:update:xgspon
 
-  const Ptr<XgponOltPloamEngine>& ploamEngine = m_device->GetPloamEngine();
-
   //usPhyFrameSize= 9720 words, equivalent to 2.488Gbps in XGPON, or 9720 4-word blocks for 9.9533Gbps in XGSPON
   //std::cout << "DBA: usPhyFrameSize (in Bytes) = " << usPhyFrameSize*m_baseGrantSize << ", extraFromPrev (Bytes): " << m_extraInLastBwmap*m_baseGrantSize << std::endl; //ja:update:xgspon
 
-  uint16_t guardTime = commonPhy->GetUsMinimumGuardTime (); //TODO: CHECK IF THE US MIN GUARD TIME IS SAME/DIFFERENT IN XG(S)PON
-  //std::cout << "guardTime = " << guardTime << std::endl;//ja:update:xgspon verifying that the parameters set at xgpon-helper are effect
-
   uint32_t numScheduledTconts= 0;
-  Ptr<XgponTcontOlt> tcontOlt; 
+
+  //the announced data (cooperative DBA) is granted before the DBA algorithm serves the T-CONTs.
+  if(!m_announcements.empty()) allocatedSize = ServeAnnouncedData (nowNano, allocatedSize, numScheduledTconts);
 	//ja:update:xgsponv5 - introducing the idea that a DBA cycle could consist of multiple XG(S)-PON frames. A configurable parameter is introduced in attributes
-	if(nowNano%(m_framesPerDBAcycle*125000U) == 0){
-		tcontOlt = GetFirstTcontOlt ( );
-		//std::cout << "DBA-order: STARTING A DBA CYCLE" << std::endl;
-	}else{
-		tcontOlt = GetCurrentTcontOlt();
-  	//std::cout << "DBA-order: in the MIDDLE of a DBA cycle" << std::endl;
-	}
-
-  do 
+  bool cycleStart = (nowNano%(m_framesPerDBAcycle*125000U) == 0);
+  allocatedSize = ServeTcontsOfFrame (nowNano, cycleStart, usPhyFrameSize, allocatedSize, numScheduledTconts);
+
+	//std::cout << "DBA-order,at_time," << nowNano << ",nanoSeconds,DBA_Cycle," << (nowNano%(m_framesPerDBAcycle*125000)/125000) << ",blockSize," << (uint16_t)m_baseGrantSize << ",Bytes,totalAllocBlocks," << allocatedSize << ",usPHYblocks," << usPhyFrameSize << ",numSchTcontsThisFrame," << numScheduledTconts << ",extraBlocks," << m_extraInLastBwmap << std::endl;
+  return allocatedSize;
+}
+
+
+uint16_t
+XgponOltDbaEngine::ServeTcontsOfFrame (uint64_t nowNano, bool cycleStart, uint32_t usPhyFrameSize, uint16_t allocatedSize, uint32_t& numScheduledTconts)
+{
+  NS_LOG_FUNCTION(this);
+  VirtualTcontWalker walker (*this);
+  return ServeTcontsInOrder (walker, nowNano, cycleStart, usPhyFrameSize, allocatedSize, numScheduledTconts);
+}
+
+
+uint16_t
+XgponOltDbaEngine::AddGrant2Burst (const Ptr<XgponOltDbaPerBurstInfo>& perBurstInfo, const Ptr<XgponTcontOlt>& tcontOlt, uint32_t size2Assign, bool dbru, uint16_t allocatedSize, uint32_t& numScheduledTconts)
+{
+  NS_LOG_FUNCTION(this);
+
+  const Ptr<XgponPhy>& commonPhy = m_device->GetXgponPhy();
+  const Ptr<XgponLinkInfo>& linkInfo = (m_device->GetPloamEngine())->GetLinkInfo(tcontOlt->GetOnuId());
+
+  if(perBurstInfo->GetBwAllocNumber() == 0) 
+  {
+    uint16_t guardTime = commonPhy->GetUsMinimumGuardTime (); //TODO: CHECK IF THE US MIN GUARD TIME IS SAME/DIFFERENT IN XG(S)PON
+    perBurstInfo->Initialize(tcontOlt->GetOnuId(), linkInfo->GetPloamExistAtOnu4OLT(), linkInfo->GetCurrentProfile(), guardTime,commonPhy->GetUsFecBlockDataSize(), commonPhy->GetUsFecBlockSize(), m_baseGrantSize);
+    //Create the first bwalloc; starttime will be set when producing bwmap from all bursts
+    Ptr<XgponXgtcBwAllocation> bwAlloc = Create<XgponXgtcBwAllocation> (tcontOlt->GetAllocId(), dbru, linkInfo->GetPloamExistAtOnu4OLT(), 0, size2Assign, 0, linkInfo->GetCurrentProfileIndex());
+    perBurstInfo->AddOneNewBwAlloc(bwAlloc, tcontOlt, m_baseGrantSize);
+    allocatedSize += (perBurstInfo->GetFinalBurstSize( ))/m_baseGrantSize;
+    numScheduledTconts++;
+    return allocatedSize;
+  }
+
+  uint32_t orgBurstSize = perBurstInfo->GetFinalBurstSize( );
+  Ptr<XgponXgtcBwAllocation> bwAlloc = perBurstInfo->FindBwAlloc(tcontOlt);
+  if(bwAlloc==nullptr)//bwalloc not already present
+  {
+    //Create the bwalloc
+    bwAlloc = Create<XgponXgtcBwAllocation> (tcontOlt->GetAllocId(), dbru, linkInfo->GetPloamExistAtOnu4OLT(), 0xFFFF, size2Assign, 0, 0);
+    perBurstInfo->AddOneNewBwAlloc(bwAlloc, tcontOlt, m_baseGrantSize);
+    numScheduledTconts++;
+  }
+  else
+  {
+    //BwAllocation already exists, add extra allocation to the existing bwAlloc; do not increment numScheduledTconts
+    perBurstInfo->AddToExistingBwAlloc(bwAlloc, size2Assign, m_baseGrantSize);
+    //a grant with DBRu merged into an announced grant (without DBRu): the block of the report is in the grant, so is the flag.
+    if(dbru) bwAlloc->SetDbruFlag (1);
+  }
+  allocatedSize += (perBurstInfo->GetFinalBurstSize( ) - orgBurstSize)/m_baseGrantSize;
+  return allocatedSize;
+}
+
+
+uint32_t
+XgponOltDbaEngine::LimitGrant2FrameSpace (const Ptr<XgponTcontOlt>& tcontOlt, uint32_t size2Assign, uint32_t allocatedSize)
+{
+  NS_LOG_FUNCTION(this);
+  uint32_t sizeRemaining = 0;
+
+  Ptr<XgponPhy> phy = m_device->GetXgponPhy();
+  uint32_t usPhyFrameSize = phy->GetUsPhyFrameSizeInBlocks();
+  Ptr<XgponBurstProfile> burstProfile = m_device->GetPloamEngine()->GetLinkInfo(tcontOlt->GetOnuId())->GetCurrentProfile();
+
+  bool isNewBurstNecessary=m_bursts.IsNewBurstNecessary(tcontOlt);
+
+
+  /**************************************
+   *
+   * Get the remaining size in a frame
+   *
+   **************************************/
+
+  if(isNewBurstNecessary)
   {
-			//std::cout << "DBA-tcontOlt : " << tcontOlt << std::endl;
-    uint32_t size2Assign = 0;
-		if(tcontOlt != nullptr){
-			size2Assign = CalculateAmountData2Upload (tcontOlt, allocatedSize, nowNano); //this function limits the size2Assign, units in blocks, to be less than maxServiceSize (40KB in XGPON, ~160KB in XGSPON)
-			//size2Assign = 1.5 * size2Assign; //ja-tcp-test, what happens to the tcp behaviour if more grant is given than the report
-    	//enable the below output to see the details of the serving TCONT, TCONT Type, associated ONU and how much of Bytes requested by the TCONT
-	    //std::cout << "DBA-order: for " << tcontOlt->GetTcontType() << "-" << tcontOlt->GetOnuId() << ", calculated size2Assign " << size2Assign*m_baseGrantSize << " Bytes" << std::endl;
-		}else{
-			//std::cout << "DBA-order: all tconts served in this DBA Cycle " << std::endl;
-			break;
-		}
-    
-		//ja:update:xgsponv5 the above function limit the allocation fo an allocID to be less than usPhyFrameSize. This is a significant change to the original xgpon model, when an extra 50% was allowed as allocation as in the commented block below. With multiple frames per DBA cycle, having the commented condition will complicate the frame boundary conditions when within the DBA cycle and at the end of the DBA cycle; hence the blcok below being commented
-   	
-		//uint32_t largestAssign = perFrameAllocLimitingFactor * usPhyFrameSize - allocatedSize;//ja:update:xgspon5, an extra 20% insted of the earlier 50% to limit overallocation 
-    //if(size2Assign > largestAssign) size2Assign = largestAssign;  
-			
-//    if(GetCurrentTcontOlt() == GetFirstTcontOlt()) {// all T-CONTs had been considered.
-//			break;
-//		}
-
-    if(size2Assign > 0 && numScheduledTconts < MAX_TCONT_PER_BWMAP)
+
+    if(burstProfile->GetFec())
     {
-			//std::cout << "\toltDBA,atMicro," << nowNano/1000 << ",bytesToAssign," << size2Assign*m_baseGrantSize << ",allocId," << tcontOlt->GetAllocId() << std::endl;
-			      
-			Ptr<XgponOltDbaPerBurstInfo> perBurstInfo = m_bursts.GetBurstInfo4TcontOlt(tcontOlt);      
-      if(perBurstInfo!=nullptr)
+      //Get the remaining size available for XGTC data when a new burst is needed and FEC is enabled.
+      uint32_t fecBlocks=(2+size2Assign)/(phy->GetUsFecBlockDataSize()/4); //Divide by four to convert to words; Add two to take XGTC header and trailer into account
+      if((2+size2Assign)%(phy->GetUsFecBlockDataSize()/4)!=0)
+        fecBlocks++;
+      uint32_t codeWords=fecBlocks*(phy->GetUsFecBlockSize()-phy->GetUsFecBlockDataSize())/4;
+      sizeRemaining = usPhyFrameSize-allocatedSize-phy->GetUsMinimumGuardTime()-(burstProfile->GetPreambleLen()+burstProfile->GetDelimiterLen())/4-codeWords-2; //Two words for XGTC headers.
+
+    }
+    else
+    {
+      //Get the remaining size available for XGTC data when a new burst is needed and FEC is disabled.
+      sizeRemaining = usPhyFrameSize-allocatedSize-phy->GetUsMinimumGuardTime()-(burstProfile->GetPreambleLen()+burstProfile->GetDelimiterLen())/4-2;
+    }
+  }
+  else
+  {
+    if(burstProfile->GetFec())
+    {
+      //Get the remaining size available for XGTC data when the ONU has been served before and FEC is enabled.
+      Ptr<XgponOltDbaPerBurstInfo> burstInfo=m_bursts.GetBurstInfo4TcontOlt(tcontOlt);
+      uint32_t oldDataWords=burstInfo->GetHeaderTrailerDataSize()/phy->GetUsFecBlockDataSize()/4;
+      uint32_t oldFecBlocks=oldDataWords/(phy->GetUsFecBlockDataSize()/4); //Divide by four to convert to words
+      if(oldDataWords%(phy->GetUsFecBlockDataSize()/4)!=0)
+        oldFecBlocks++;
+      uint32_t oldCodeWords=oldFecBlocks*(phy->GetUsFecBlockSize()-phy->GetUsFecBlockDataSize())/4;
+      sizeRemaining = usPhyFrameSize-(allocatedSize-oldCodeWords);
+    }
+    else
+    {
+      //Get the remaining size available for XGTC data when the ONU has been served before and FEC is disabled.
+      sizeRemaining = usPhyFrameSize-allocatedSize;
+    }
+  }
+
+  /**************************************
+   *
+   * Prevent the bwMap from granting more than
+   * what is allowed by the US PHY frame.
+   *
+   **************************************/
+  if(size2Assign>sizeRemaining)
+  {
+    //There is not enough space to send all that the user requested
+    if(burstProfile->GetFec())
+    {
+      //FEC is enabled. We need to compute what is the maximum amount of words we can transmit,
+      //considering the FEC overhead will be smaller if the transmitted data is smaller.
+      if(isNewBurstNecessary)
       {
-        SetServedTcont(tcontOlt->GetAllocId());
-        const Ptr<XgponLinkInfo>& linkInfo = ploamEngine->GetLinkInfo(tcontOlt->GetOnuId());
+        //Computing the maximum data transmission possible, bearing in mind that a new burst is necessary to serve the T-CONT.
+        uint32_t sizeRemainingNoFec=usPhyFrameSize-allocatedSize-phy->GetUsMinimumGuardTime()-(burstProfile->GetPreambleLen()+burstProfile->GetDelimiterLen())/4;
 
-        if(perBurstInfo->GetBwAllocNumber() == 0) 
+        uint32_t fecBlocs=sizeRemainingNoFec/(phy->GetUsFecBlockSize()/4);
+        uint32_t dataRemainder=0;
+        if(sizeRemainingNoFec%(phy->GetUsFecBlockSize()/4)!=0)
         {
-          perBurstInfo->Initialize(tcontOlt->GetOnuId(), linkInfo->GetPloamExistAtOnu4OLT(), linkInfo->GetCurrentProfile(), guardTime,commonPhy->GetUsFecBlockDataSize(), commonPhy->GetUsFecBlockSize(), m_baseGrantSize);
-					//std::cout << "Initialise:guardTime," << guardTime << ",FecBlockDataSize," << commonPhy->GetUsFecBlockDataSize() << ",UsFecBlockSize," << commonPhy->GetUsFecBlockSize() << ",baseGrantSize," << (uint16_t)m_baseGrantSize << std::endl;
-          //Create the first bwalloc; starttime will be set when producing bwmap from all bursts
-          Ptr<XgponXgtcBwAllocation> bwAlloc = Create<XgponXgtcBwAllocation> (tcontOlt->GetAllocId(), true, linkInfo->GetPloamExistAtOnu4OLT(), 0, size2Assign, 0, linkInfo->GetCurrentProfileIndex());
-          perBurstInfo->AddOneNewBwAlloc(bwAlloc, tcontOlt, m_baseGrantSize);
-					//std::cout << "DBA,burstBytes(firstBwAlloc),"<< perBurstInfo->GetFinalBurstSize() << std::endl;
-          allocatedSize += (perBurstInfo->GetFinalBurstSize( ))/m_baseGrantSize;
-          numScheduledTconts++;
+          dataRemainder=sizeRemainingNoFec-fecBlocs*(phy->GetUsFecBlockSize()/4)-(phy->GetUsFecBlockSize()-phy->GetUsFecBlockDataSize())/4;
         }
-        else
+        sizeRemaining=fecBlocs*phy->GetUsFecBlockDataSize()/4+dataRemainder-2;
+      }
+      else
+      {
+        //Computing the maximum possible data transmission, bearing in mind that the ONU was served before.
+        Ptr<XgponOltDbaPerBurstInfo> burstInfo=m_bursts.GetBurstInfo4TcontOlt(tcontOlt);
+        uint32_t oldDataWords=burstInfo->GetHeaderTrailerDataSize()/phy->GetUsFecBlockDataSize()/4;
+        uint32_t oldFecBlocks=oldDataWords/(phy->GetUsFecBlockDataSize()/4); //Divide by four to convert to words
+        if(oldDataWords%(phy->GetUsFecBlockDataSize()/4)!=0)
+          oldFecBlocks++;
+        uint32_t oldCodeWords=oldFecBlocks*(phy->GetUsFecBlockSize()-phy->GetUsFecBlockDataSize())/4;
+
+        uint32_t newCodedBurstSize=usPhyFrameSize-(allocatedSize-oldCodeWords-oldDataWords);
+        uint32_t newFecBlocks = newCodedBurstSize/(phy->GetUsFecBlockSize()/4);
+        uint32_t newDataWords = newFecBlocks*(phy->GetUsFecBlockDataSize()/4);
+        if(newCodedBurstSize%(phy->GetUsFecBlockSize()/4)!=0)
         {
-          if(perBurstInfo->FindBwAlloc(tcontOlt)==nullptr)//bwalloc not already present
-          {
-            //Create the bwalloc
-            Ptr<XgponXgtcBwAllocation> bwAlloc = Create<XgponXgtcBwAllocation> (tcontOlt->GetAllocId(), true, linkInfo->GetPloamExistAtOnu4OLT(), 0xFFFF, size2Assign, 0, 0);
-            uint32_t orgBurstSize = perBurstInfo->GetFinalBurstSize( );
-						//std::cout << "DBA,burstBlocks(newBwAlloc),before,"<< orgBurstSize << std::endl;
-            perBurstInfo->AddOneNewBwAlloc(bwAlloc, tcontOlt, m_baseGrantSize);
-            allocatedSize += (perBurstInfo->GetFinalBurstSize( ) - orgBurstSize)/m_baseGrantSize;
-						//std::cout << "DBA,addedBurstBlocks,after"<< allocatedSize - m_extraInLastBwmap << std::endl;
-            numScheduledTconts++;
-          }
-          else
-          {
-            //BwAllocation already exists, add extra allocation to the existing bwAlloc
-            Ptr<XgponXgtcBwAllocation> bwAlloc = perBurstInfo->FindBwAlloc(tcontOlt);
-            uint32_t orgBurstSize = perBurstInfo->GetFinalBurstSize( );
-						//std::cout << "DBA,burstBlocks(newBwAlloc),before,"<< orgBurstSize << std::endl;
-            perBurstInfo->AddToExistingBwAlloc( bwAlloc, size2Assign*m_baseGrantSize);
-            allocatedSize += (perBurstInfo->GetFinalBurstSize( ) - orgBurstSize)/m_baseGrantSize;
-						//std::cout << "DBA,addedBurstBlocks,after"<< allocatedSize - m_extraInLastBwmap << std::endl;
-            //do not increment numScheduledTconts
-          }
+          newFecBlocks++;
+          uint32_t shortenedCodedBlockSize=newCodedBurstSize%(phy->GetUsFecBlockSize()/4);
+          newDataWords=newDataWords+shortenedCodedBlockSize-(phy->GetUsFecBlockSize()-phy->GetUsFecBlockDataSize())/4;
         }
+        sizeRemaining=newDataWords-oldDataWords;
       }
-    }    
+    }
+    return sizeRemaining;
+  }
+  else
+  {
+    return size2Assign;
+  }
+}
+
+
+
+void
+XgponOltDbaEngine::AnnounceUpstreamData (uint16_t allocId, uint32_t size, uint64_t time)
+{
+  NS_LOG_FUNCTION(this);
+  NS_ASSERT_MSG(((m_device->GetConnManager( ))->GetTcontById (allocId) != nullptr), "The data is announced for an unknown T-CONT!!!");
+
+  if(size == 0) return;
+
+  AnnouncedData data;
+  data.m_time = time;
+  data.m_allocId = allocId;
+  data.m_size = (size + m_baseGrantSize - 1) / m_baseGrantSize;
+
+  m_announcements.push_back (data);
+  std::push_heap (m_announcements.begin(), m_announcements.end(), &XgponOltDbaEngine::LaterAnnouncement);
+}
+
+
+uint16_t
+XgponOltDbaEngine::ServeAnnouncedData (uint64_t nowNano, uint16_t allocatedSize, uint32_t& numScheduledTconts)
+{
+  NS_LOG_FUNCTION(this);
+
+  //the bursts of this BWmap are transmitted by ONUs at least half rtt later (the furthest ONU transmits first).
+  uint64_t transmitTime = nowNano + GetRtt() / 2;
+  uint32_t usPhyFrameSize = (m_device->GetXgponPhy())->GetUsPhyFrameSizeInBlocks();
+  const Ptr<XgponOltConnManager>& connManager = m_device->GetConnManager( );
 
+  while(!m_announcements.empty() && m_announcements.front().m_time <= transmitTime)
+  {
+    //the rest is granted in the following BWmaps.
+    if(allocatedSize >= (usPhyFrameSize-10) || numScheduledTconts >= MAX_TCONT_PER_BWMAP) break;
+
+    AnnouncedData& data = m_announcements.front();
+    const Ptr<XgponTcontOlt>& tcontOlt = connManager->GetTcontById (data.m_allocId);
+
+    Ptr<XgponOltDbaPerBurstInfo> perBurstInfo = m_bursts.GetBurstInfo4TcontOlt(tcontOlt);
+    if(perBurstInfo == nullptr) 
+    {
+      //no more burst for this ONU in this BWmap; the data waits for the next one.
+      m_deferredAnnouncements.push_back (data);
+      std::pop_heap (m_announcements.begin(), m_announcements.end(), &XgponOltDbaEngine::LaterAnnouncement);
+      m_announcements.pop_back ();
+      continue;
+    }
 
-		//std::cout << "allocatedSize," << allocatedSize << ",usPhyFrameSize," << usPhyFrameSize << std::endl;
-    tcontOlt = GetNextTcontOlt ( );
-    if(CheckAllTcontsServed()) {// all T-CONTs had been considered.
-			//std::cout << "\tDBA-order: ALL TCONTS SERVED IN THE FRAME " << std::endl;
+    uint32_t size2Assign = std::min (data.m_size, usPhyFrameSize - 10 - allocatedSize);
+
+    //the T-CONT is not polled by the announced grant. The engines that check CheckServedTcont do not add one block for its DBRu later;
+    //if another one does, AddGrant2Burst sets the DBRu flag of the merged allocation.
+    SetServedTcont (tcontOlt->GetAllocId());
+    allocatedSize = AddGrant2Burst (perBurstInfo, tcontOlt, size2Assign, false, allocatedSize, numScheduledTconts);
+
+    if(size2Assign < data.m_size) 
+    {
+      data.m_size -= size2Assign;  //the earliest announcement is still at the top of the heap
       break;
-		}
+    }
+    std::pop_heap (m_announcements.begin(), m_announcements.end(), &XgponOltDbaEngine::LaterAnnouncement);
+    m_announcements.pop_back ();
+  }
 
-      
-  } while((allocatedSize < (usPhyFrameSize-10)) && numScheduledTconts<MAX_TCONT_PER_BWMAP);
+  for(std::vector<AnnouncedData>::const_iterator it = m_deferredAnnouncements.begin(); it != m_deferredAnnouncements.end(); it++)
+  {
+    m_announcements.push_back (*it);
+    std::push_heap (m_announcements.begin(), m_announcements.end(), &XgponOltDbaEngine::LaterAnnouncement);
+  }
+  m_deferredAnnouncements.clear ();
+
+  return allocatedSize;
+}
+
+
+
+
+const Ptr<XgponXgtcBwmap>
+XgponOltDbaEngine::ProduceBwmap (uint64_t nowNano, uint16_t allocatedSize)
+{
+  NS_LOG_FUNCTION(this);
+
+  uint32_t usPhyFrameSize = (m_device->GetXgponPhy())->GetUsPhyFrameSizeInBlocks();
+
+  //the space left at the end of the frame costs nothing if it completes the shortened FEC codewords of the bursts.
+  if(m_padFecCodewords && allocatedSize < usPhyFrameSize)
+  {
+    allocatedSize += m_bursts.OptimiseBursts (usPhyFrameSize - allocatedSize, GetRtt(), GetFrameSlotSize(), m_baseGrantSize);
+  }
 
-	//std::cout << "DBA-order,at_time," << nowNano << ",nanoSeconds,DBA_Cycle," << (nowNano%(m_framesPerDBAcycle*125000)/125000) << ",blockSize," << (uint16_t)m_baseGrantSize << ",Bytes,totalAllocBlocks," << allocatedSize << ",usPHYblocks," << usPhyFrameSize << ",numSchTcontsThisFrame," << numScheduledTconts << ",extraBlocks," << m_extraInLastBwmap << std::endl;
   //TODO: assert m_minimumSI >= 1
   m_aggregateAllocatedSize += allocatedSize;
   //std::cout << "Total AllocatedSize: " << allocatedSize*m_baseGrantSize << " Bytes" << std::endl;
@@ -240,13 +440,12 @@ XgponOltDbaEngine::GenerateBwMap ()  //unit: block of word or 4-word; we assume
     m_extraInLastBwmap = allocatedSize - usPhyFrameSize; //all units are in blocks (4 Bytes for XGPON and 16 Bytes for XGSPON)
   } else m_extraInLastBwmap = 0;
 
+  //LocateBurst finds this BW-MAP from (receiving time - rtt) / slot; it only gives this frame when the BW-MAP is produced at the frame boundary.
+  NS_ASSERT_MSG((nowNano % GetFrameSlotSize () == 0), "The BW-MAP is not produced at the boundary of one frame slot!!!");
   map->SetCreationTime(nowNano);
-  m_servedBwmaps.push_back(map);  //used for receiving the corresponding bursts
+  AddServedBwmap(map, nowNano / GetFrameSlotSize ());  //used for receiving the corresponding bursts
 
-  FinalizeBwmapProduction();
-	//std::cout << "\t\tDBA:bw_map_finalised,at_time," << nowNano << ",totalAllocBytes," << allocatedSize*m_baseGrantSize << ",m_extraInLastBwmapBytes," << m_extraInLastBwmap*m_baseGrantSize << std::endl;
   return map;
-	
 }
 
 
@@ -257,31 +456,74 @@ XgponOltDbaEngine::GenerateBwMap ()  //unit: block of word or 4-word; we assume
 
 
 
-const Ptr<XgponXgtcBwmap>& 
-XgponOltDbaEngine::GetBwMap4CurrentBurst (uint64_t time)
+void
+XgponOltDbaEngine::AddServedBwmap (const Ptr<XgponXgtcBwmap>& map, uint64_t frame)
+{
+  NS_LOG_FUNCTION(this);
+
+  ServedBwmap& served = m_servedBwmaps[frame % SERVED_BWMAP_RING_SIZE];
+  if(&served == m_locatedBwmap) m_locatedBwmap = 0;
+
+  served.m_bwmap = map;
+  served.m_frame = frame;
+  served.m_burstStartTimes.clear();
+  served.m_burstFirstIndexes.clear();
+
+  //StartTime is only set in the first allocation of each burst (0xFFFF in the others). The bursts are in ascending order of StartTime.
+  uint16_t num = map->GetNumberOfBwAllocation();
+  for(uint16_t i=0; i<num; i++)
+  {
+    uint16_t startTime = (map->GetBwAllocationByIndex(i))->GetStartTime();
+    if(startTime != 0xFFFF)
+    {
+      served.m_burstStartTimes.push_back(startTime);
+      served.m_burstFirstIndexes.push_back(i);
+    }
+  }
+}
+
+
+void 
+XgponOltDbaEngine::LocateBurst (uint64_t time)
 {
   NS_LOG_FUNCTION(this);
 
+  if(m_locatedBwmap != 0 && m_locatedBurstTime == time) return;
+
   uint64_t slotSize = GetFrameSlotSize ( );  //slotSize in nanosecond
   uint64_t rtt = GetRtt();
+  NS_ASSERT_MSG((time>rtt), "The burst is received before any bwmap could be sent!!!"); 
 
-  while(m_servedBwmaps.size() > 0)
-  {
-    const Ptr<XgponXgtcBwmap>& first = m_servedBwmaps.front();
-    uint64_t startTime = first->GetCreationTime() + rtt;
-    uint64_t endTime = startTime + slotSize;
+  //the burst is received within one frame slot after the corresponding bwmap is sent plus rtt.
+  //BW-MAPs are produced at the frame boundaries (asserted in ProduceBwmap), so this is the frame used by AddServedBwmap.
+  uint64_t frame = (time - rtt) / slotSize;
+  const ServedBwmap& served = m_servedBwmaps[frame % SERVED_BWMAP_RING_SIZE];
+  NS_ASSERT_MSG((served.m_bwmap!=nullptr && served.m_frame==frame), "The corresponding bwmap was deleted too early!!!"); 
 
-    NS_ASSERT_MSG((time>startTime), "The corresponding bwmap was deleted too early!!!"); 
+  //calculate STARTTIME based on receiving time of the burst
+  // (offsetTime * usRate)/(4*1000000000)
+  uint64_t offsetSize64 = (time - (served.m_bwmap->GetCreationTime ( ) + rtt)) * GetUsLinkRate();   
+  uint64_t tmpInt64 = 1000000000L;
+  offsetSize64 = offsetSize64 / (m_baseGrantSize*tmpInt64); //ja:update::xgspon replaced the word size with the actual block size (4 or 16) as per the PON technology (XGPON or XGSPON respectively)
+  uint32_t offsetSize = (uint32_t) offsetSize64;  //unit: blocks of word or 4-words
 
-    if(time < endTime) return m_servedBwmaps.front();
-    else
-    { //first bwmap should be deleted since all of the corresponding bursts have been received (based on time).
-      m_servedBwmaps.pop_front();
-    }
-  }
+  //Note that the starttime in BwAlloc starts from the XGTC header (after the preamble and delimiter). Thus, the burst will arrive before the starttime.
+  std::vector<uint16_t>::const_iterator it = std::upper_bound (served.m_burstStartTimes.begin(), served.m_burstStartTimes.end(), offsetSize);
+  NS_ASSERT_MSG((it != served.m_burstStartTimes.end()), "There is no burst in the bwmap at this time!!!"); 
 
-  NS_ASSERT_MSG(false, "this line should never been run!!!"); 
-  return m_nullBwmap;
+  m_locatedBurstTime = time;
+  m_locatedBwmap = &served;
+  m_locatedFirstIndex = served.m_burstFirstIndexes[it - served.m_burstStartTimes.begin()];
+}
+
+
+const Ptr<XgponXgtcBwmap>& 
+XgponOltDbaEngine::GetBwMap4CurrentBurst (uint64_t time)
+{
+  NS_LOG_FUNCTION(this);
+
+  LocateBurst (time);
+  return m_locatedBwmap->m_bwmap;
 }
 
 
@@ -290,7 +532,7 @@ XgponOltDbaEngine::GetProfile4BurstFromChannel(uint64_t time)
 {
   NS_LOG_FUNCTION(this);
 
-  Ptr<XgponXgtcBwmap> map = GetBwMap4CurrentBurst (time);
+  const Ptr<XgponXgtcBwmap>& map = GetBwMap4CurrentBurst (time);
   NS_ASSERT_MSG((map!=nullptr), "There is no corresponding bwmap for this burst!!!");
 
   uint32_t first = GetIndexOfBurstFirstBwAllocation (map, time);
@@ -310,24 +552,9 @@ XgponOltDbaEngine::GetIndexOfBurstFirstBwAllocation (const Ptr<XgponXgtcBwmap>&
 {
   NS_LOG_FUNCTION(this);
 
-  //calculate STARTTIME based on receiving time of the burst
-  // (offsetTime * usRate)/(4*1000000000)
-  uint64_t offsetSize64 = (time - (bwmap->GetCreationTime ( ) + GetRtt())) * GetUsLinkRate();   
-  uint64_t tmpInt64 = 1000000000L;
-  offsetSize64 = offsetSize64 / (m_baseGrantSize*tmpInt64); //ja:update::xgspon replaced the word size with the actual block size (4 or 16) as per the PON technology (XGPON or XGSPON respectively)
-  uint32_t offsetSize = (uint32_t) offsetSize64;  //unit: blocks of word or 4-words
-
-  int num = bwmap->GetNumberOfBwAllocation();
-  for(int i=0; i<num; i++)
-  {
-    uint32_t startTime = (bwmap->GetBwAllocationByIndex(i))->GetStartTime();
-
-    //Note that the starttime in BwAlloc starts from the XGTC header (after the preamble and delimiter). Thus, the burst will arrive before the starttime.
-    if((startTime!= 0xFFFF) && offsetSize < startTime ) { return i; }
-  }
-  
-  NS_ASSERT_MSG(false, "this line should never been run!!!"); 
-  return (num+1); //return one impossible value.
+  LocateBurst (time);
+  NS_ASSERT_MSG((m_locatedBwmap->m_bwmap == bwmap), "The bwmap is not the one in which this burst is scheduled!!!"); 
+  return m_locatedFirstIndex;
 }
 
 
@@ -353,15 +580,21 @@ XgponOltDbaEngine::GetIndexOfBurstFirstBwAllocation (const Ptr<XgponXgtcBwmap>&
 void 
 XgponOltDbaEngine::PrintAllActiveBwmaps (void) 
 {
-  std::list< Ptr<XgponXgtcBwmap> >::iterator it = m_servedBwmaps.begin(); 
-  std::list< Ptr<XgponXgtcBwmap> >::iterator end = m_servedBwmaps.end();
+  //find the latest one and print the ring from the oldest one.
+  uint32_t latest = 0;
+  for(uint32_t i=1; i<SERVED_BWMAP_RING_SIZE; i++)
+  {
+    if(m_servedBwmaps[i].m_frame > m_servedBwmaps[latest].m_frame) latest = i;
+  }
 
-  while(it!=end)
+  for(uint32_t j=1; j<=SERVED_BWMAP_RING_SIZE; j++)
   {
+    const ServedBwmap& served = m_servedBwmaps[(latest + j) % SERVED_BWMAP_RING_SIZE];
+    if(served.m_bwmap == nullptr) continue;
+
     std::cout << std::endl << std::endl;
-    (*it)->Print(std::cout);
+    served.m_bwmap->Print(std::cout);
     std::cout << std::endl << std::endl;
-    it++;
   }
 }
 
@@ -22,10 +22,13 @@
 #ifndef XGPON_OLT_DBA_ENGINE_H
 #define XGPON_OLT_DBA_ENGINE_H
 
+#include <vector>
+
 #include "ns3/object.h"
 
 #include "xgpon-olt-engine.h"
 #include "xgpon-olt-dba-bursts.h"
+#include "xgpon-olt-dba-active-tconts.h"
 
 #include "xgpon-xgtc-dbru.h"
 
@@ -72,6 +75,7 @@ public:
 
   const static uint32_t MAX_TCONT_PER_BWMAP=512;         //at most, 512 T-CONTs can be scheduled in one bwmap.
   const static uint8_t BASE_GRANT_SIZE_XGPON = 4;         //unit: Bytes, ja:update:xgspon
+  const static uint32_t SERVED_BWMAP_RING_SIZE = 64;     //the number of BW-MAPs kept for receiving bursts. It should cover the round trip delay (64 frames: 8ms).
   /**
    * \brief Constructor
    */
@@ -101,6 +105,16 @@ public:
    */
   void ReceiveStatusReport (const Ptr<XgponXgtcDbru>& report, uint16_t onuId, uint16_t allocId, uint64_t time);  
 
+  /**
+   * \brief announce the data that will arrive at one T-CONT ahead of time (cooperative DBA, e.g., by the scheduler of a small cell).
+   *        The data is granted in the first BWmap whose bursts are transmitted after the data arrives, without waiting for
+   *        the queue occupancy report. The DBA algorithm still serves the T-CONT as usual.
+   * \param allocId the T-CONT that the data is put into
+   * \param size the size of the XGEM frames that carry the data. unit: byte
+   * \param time the time that the data arrives at the T-CONT. unit: nanosecond
+   */
+  void AnnounceUpstreamData (uint16_t allocId, uint32_t size, uint64_t time);
+
 
 
 
@@ -117,6 +131,7 @@ public:
 
   /**
    * \brief Get the corresponding BW_MAP in which the just received burst is allocated.
+   *        The BW_MAP and the index of the burst's first allocation are looked up once per burst (cached based on the time).
    * \return the corresponding BW_MAP
    * \param time the time that the upstream burst is received.
    */
@@ -182,6 +197,25 @@ protected:
    */
   void SetServedTcont(uint64_t allocId);
 
+  /**
+   * \brief limit the grant of the T-CONT to what is left in the upstream frame (the burst overhead and FEC parity of its ONU considered).
+   *        Used by the engines of the GIANT family at the end of CalculateAmountData2Upload.
+   * \return the grant after the limit. unit: word
+   * \param size2Assign the grant calculated by the engine. unit: word
+   * \param allocatedSize the size already allocated in this frame. unit: word
+   */
+  uint32_t LimitGrant2FrameSpace (const Ptr<XgponTcontOlt>& tcontOlt, uint32_t size2Assign, uint32_t allocatedSize);
+
+  /**
+   * \brief serve the T-CONTs in the order given by the walker until the frame is full or all T-CONTs of the DBA cycle have been considered.
+   *        The walker provides FirstTcont, CurrentTcont, NextTcont, CalculateGrant and AllTcontsServed (the counterparts of the virtual functions below).
+   *        An engine that passes itself as the walker (see XgponOltDbaEngineGiantCore) serves the T-CONTs without any virtual call.
+   * \return the allocated size after serving the T-CONTs (unit: block)
+   * \param cycleStart whether a DBA cycle starts in this frame (the T-CONTs are served from the first one of the cycle)
+   */
+  template <class Walker>
+  uint16_t ServeTcontsInOrder (Walker& walker, uint64_t nowNano, bool cycleStart, uint32_t usPhyFrameSize, uint16_t allocatedSize, uint32_t& numScheduledTconts);
+
 
 private:
 
@@ -214,6 +248,12 @@ private:
    */
   virtual bool CheckAllTcontsServed ( ) = 0;
 
+  /*
+   * \brief serve the T-CONTs of one frame and put the bwallocs into m_bursts. return the allocated size (unit: block)
+   * By default, the T-CONTs are visited through the virtual functions above (one call of each per T-CONT).
+   */
+  virtual uint16_t ServeTcontsOfFrame (uint64_t nowNano, bool cycleStart, uint32_t usPhyFrameSize, uint16_t allocatedSize, uint32_t& numScheduledTconts);
+
   /*
    * \brief Called before producing one Bwmap with aim of adjusting the next alloc-olt to be served.
    *  For round robin, nothing to be done. In other dba algorithms, olt should first check the T-CONT with the highest priority.
@@ -228,17 +268,90 @@ private:
 
 protected:
   XgponOltDbaBursts m_bursts;      //bursts used to produce BWMAP
+  XgponOltDbaActiveTconts m_activeTconts;   //T-CONTs that are active or due to be polled; idle ones are passed over when producing BWMAP
+  bool m_activeTcontIndex;                  //whether m_activeTconts is used
   //jerome, C1
   uint32_t m_aggregateAllocatedSize;    //Used to maintain the total allocation for the minimum no of cycles. Tcont cycle is reset once this exceeded;  unit: block (of 4-Bytes for XGPON, of 16-Bytes for XGSPON)
   uint8_t m_baseGrantSize; //unit: Bytes, ja:update:xgspon
 	uint8_t	m_framesPerDBAcycle; //unit: number of XG(S)-PON frames; equals the DBA cycle, by the count of frames, ja:update:xgsponv5
 
 private:
-  //the list of BW-MAPs that have been sent out, but the corresponding bursts have not been received yet.
-  std::list< Ptr<XgponXgtcBwmap> > m_servedBwmaps;  
+  /**
+   * \brief one BW-MAP that has been sent out and the start times of its bursts (to find the burst based on its receiving time).
+   */
+  struct ServedBwmap
+  {
+    Ptr<XgponXgtcBwmap> m_bwmap;
+    uint64_t m_frame;                              //the index of the downstream frame in which the BW-MAP is sent
+    std::vector<uint16_t> m_burstStartTimes;       //StartTime of the first allocation of each burst (ascending order)
+    std::vector<uint16_t> m_burstFirstIndexes;     //the index of the first allocation of each burst in the BW-MAP
+  };
+
+  /**
+   * \brief the data announced for one T-CONT (cooperative DBA) that has not been granted yet.
+   */
+  struct AnnouncedData
+  {
+    uint64_t m_time;          //the time that the data arrives at the T-CONT. unit: nanosecond
+    uint16_t m_allocId;
+    uint32_t m_size;          //unit: block
+  };
+
+  /**
+   * \brief the walker of ServeTcontsInOrder through the virtual functions of the engine.
+   */
+  class VirtualTcontWalker
+  {
+  public:
+    VirtualTcontWalker (XgponOltDbaEngine& engine) : m_engine(engine) { }
+
+    const Ptr<XgponTcontOlt>& FirstTcont (void) { return m_engine.GetFirstTcontOlt (); }
+    const Ptr<XgponTcontOlt>& CurrentTcont (void) { return m_engine.GetCurrentTcontOlt (); }
+    const Ptr<XgponTcontOlt>& NextTcont (void) { return m_engine.GetNextTcontOlt (); }
+    uint32_t CalculateGrant (const Ptr<XgponTcontOlt>& tcontOlt, uint32_t allocatedSize, uint64_t nowNano) { return m_engine.CalculateAmountData2Upload (tcontOlt, allocatedSize, nowNano); }
+    bool AllTcontsServed (void) { return m_engine.CheckAllTcontsServed (); }
+
+  private:
+    XgponOltDbaEngine& m_engine;
+  };
+
+  //the order of the heap of announcements (the earliest one at the top)
+  static bool LaterAnnouncement (const AnnouncedData& a, const AnnouncedData& b);
+
+  //serve the T-CONTs from the current cursor of the engine and put the bwallocs into m_bursts. return the allocated size (unit: block)
+  uint16_t FillBursts4Frame (uint64_t nowNano, uint16_t extraFromLastFrame);
+
+  //put one grant of the T-CONT into its burst (added to its bwalloc if the T-CONT is already in the burst). return the allocated size after this grant (unit: block)
+  uint16_t AddGrant2Burst (const Ptr<XgponOltDbaPerBurstInfo>& perBurstInfo, const Ptr<XgponTcontOlt>& tcontOlt, uint32_t size2Assign, bool dbru, uint16_t allocatedSize, uint32_t& numScheduledTconts);
+
+  //grant the announced data that arrives before the bursts of this BWmap are transmitted. return the allocated size (unit: block)
+  uint16_t ServeAnnouncedData (uint64_t nowNano, uint16_t allocatedSize, uint32_t& numScheduledTconts);
+
+  //produce the BW-MAP from m_bursts, update the over-allocation and keep the BW-MAP for receiving bursts.
+  const Ptr<XgponXgtcBwmap> ProduceBwmap (uint64_t nowNano, uint16_t allocatedSize);
+
+  //put the just produced BW-MAP into the ring.
+  void AddServedBwmap (const Ptr<XgponXgtcBwmap>& map, uint64_t frame);
+
+  //find the BW-MAP and the first allocation of the burst received at the time. The result is cached for the following calls.
+  void LocateBurst (uint64_t time);
+
+
+  //the ring of BW-MAPs that have been sent out (indexed by frame number). The corresponding bursts may have not been received yet.
+  std::vector<ServedBwmap> m_servedBwmaps;  
   Ptr<XgponXgtcBwmap> m_nullBwmap;  //used to return a null bwmap.
 
+  //the result of the latest LocateBurst
+  uint64_t m_locatedBurstTime;
+  const ServedBwmap* m_locatedBwmap;
+  uint32_t m_locatedFirstIndex;
+
   uint16_t m_extraInLastBwmap;     //BWMAP may cross the boundary of frame and this variable is used to maintail the over-allocation. unit: block (of 4-Bytes for XGPON, of 16-Bytes for XGSPON)
+  bool m_padFecCodewords;          //whether the space left at the end of the frame is used to pad the grants up to FEC codeword boundaries
+
+  //the announced data (cooperative DBA)
+  std::vector<AnnouncedData> m_announcements;          //a heap (std::push_heap) ordered by the arrival time
+  std::vector<AnnouncedData> m_deferredAnnouncements;  //the due ones that cannot be put into the current BWmap (their ONUs have no more bursts)
 
   //calculate once to save CPU.
   uint32_t m_dsFrameSlotSizeInNano; //unit: nanosecond
@@ -254,6 +367,50 @@ XgponOltDbaEngine::GetExtraInLastBwmap ( ) const
   return m_extraInLastBwmap;
 }
 
+inline bool
+XgponOltDbaEngine::LaterAnnouncement (const AnnouncedData& a, const AnnouncedData& b)
+{
+  return a.m_time > b.m_time;
+}
+
+template <class Walker>
+inline uint16_t
+XgponOltDbaEngine::ServeTcontsInOrder (Walker& walker, uint64_t nowNano, bool cycleStart, uint32_t usPhyFrameSize, uint16_t allocatedSize, uint32_t& numScheduledTconts)
+{
+  uint64_t frame = nowNano / GetFrameSlotSize ();
+
+  Ptr<XgponTcontOlt> tcontOlt;
+  if(cycleStart) tcontOlt = walker.FirstTcont ();
+  else tcontOlt = walker.CurrentTcont ();
+
+  do
+  {
+    uint32_t size2Assign = 0;
+    if(tcontOlt == nullptr) break;   //all tconts served in this DBA Cycle
+
+    //idle T-CONTs that are not due to be polled yet are passed over without any work.
+    if(!m_activeTcontIndex || m_activeTconts.IsCandidate (tcontOlt))
+      size2Assign = walker.CalculateGrant (tcontOlt, allocatedSize, nowNano); //this function limits the size2Assign, units in blocks, to be less than maxServiceSize (40KB in XGPON, ~160KB in XGSPON)
+
+    //ja:update:xgsponv5 the grant of one allocID is limited to be less than usPhyFrameSize (the original xgpon model allowed an extra 50%), to keep the frame boundary conditions simple when a DBA cycle has multiple frames.
+    if(size2Assign > 0 && numScheduledTconts < MAX_TCONT_PER_BWMAP)
+    {
+      Ptr<XgponOltDbaPerBurstInfo> perBurstInfo = m_bursts.GetBurstInfo4TcontOlt(tcontOlt);
+      if(perBurstInfo!=nullptr)
+      {
+        SetServedTcont(tcontOlt->GetAllocId());
+        if(m_activeTcontIndex) m_activeTconts.SetPolled (tcontOlt, frame);
+        allocatedSize = AddGrant2Burst (perBurstInfo, tcontOlt, size2Assign, true, allocatedSize, numScheduledTconts);
+      }
+    }
+
+    tcontOlt = walker.NextTcont ();
+    if(walker.AllTcontsServed ()) break;   // all T-CONTs had been considered.
+  } while((allocatedSize < (usPhyFrameSize-10)) && numScheduledTconts<MAX_TCONT_PER_BWMAP);
+
+  return allocatedSize;
+}
+
 
 }; // namespace ns3
 
@@ -0,0 +1,566 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2012 University College Cork (UCC), Ireland
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jerome Arokkiam <jerome.arokkia@bt.com>
+ */
+
+#ifndef XGPON_OLT_DBA_GIANT_CYCLE_H
+#define XGPON_OLT_DBA_GIANT_CYCLE_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "ns3/assert.h"
+#include "ns3/ptr.h"
+
+#include "xgpon-qos-parameters.h"
+#include "xgpon-tcont-olt.h"
+#include "xgpon-olt-dba-active-tconts.h"
+
+
+
+namespace ns3 {
+
+/**
+ * \brief round policy of the GIANT family (GIANT, XGIANT-deficit, XGIANT-prop): the T-CONTs of each type are visited once per DBA cycle.
+ *        T3 gets its GIR and its PIR in alternate DBA cycles; the cycle ends after all T4 T-CONTs are visited.
+ */
+struct XgponGiantOneRoundPerCycle
+{
+  static const bool TWO_ROUNDS_PER_CYCLE = false;
+};
+
+/**
+ * \brief round policy of XGIANT: T3 and T4 are visited twice in one DBA cycle (the GIR round and then the PIR round).
+ */
+struct XgponGiantTwoRoundsPerCycle
+{
+  static const bool TWO_ROUNDS_PER_CYCLE = true;
+};
+
+
+/**
+ * \brief what happened when the cursor of a DBA cycle moved to the next T-CONT.
+ */
+enum XgponGiantStep
+{
+  XGPON_GIANT_STEP_SAME_TYPE,          //the next T-CONT of the same type
+  XGPON_GIANT_STEP_NEXT_TYPE,          //all T-CONTs of the type were visited; the first T-CONT of the next type
+  XGPON_GIANT_STEP_SECOND_ROUND,       //all T4 T-CONTs were visited in the GIR round; the second round of T3 starts (two rounds per cycle only)
+  XGPON_GIANT_STEP_CYCLE_END           //all T-CONTs were visited in this DBA cycle
+};
+
+
+
+/**
+ * \ingroup xgpon
+ * \brief The order in which the DBA engines of the GIANT family visit the T-CONTs: T1, T2, T3 and then T4 in each DBA cycle.
+ *        Each type is served round-robin from the T-CONT after the one visited last, until all T-CONTs of this type are visited.
+ *
+ * The T-CONTs are kept in one contiguous list per type, so that they need not be added in the order T1, T2, T3, T4 per ONU.
+ * With this order (the layout these engines assumed), the position of one T-CONT in its list is its index in the list of all T-CONTs divided by 4.
+ * The round policy is a template parameter, so that the engines (see XgponOltDbaEngineGiantCore) share this code
+ * without any virtual call per T-CONT.
+ *
+ * In XgponOltDbaActiveTconts, the T-CONT at the position p of the type t gets the index 4*p + t - 1 (one lane per type),
+ * so that the cursor can jump over the idle T-CONTs of its type with one search of the bitset.
+ */
+template <class RoundPolicy>
+class XgponOltDbaGiantCycle
+{
+public:
+  /**
+   * \brief Constructor
+   */
+  XgponOltDbaGiantCycle ();
+
+  /**
+   * \brief append one T-CONT (of type 1 to 4) to the list of its type.
+   * \return the index of the T-CONT in XgponOltDbaActiveTconts
+   */
+  uint32_t AddTcont (const Ptr<XgponTcontOlt>& tcont);
+
+  /**
+   * \return the T-CONTs of one type (in the order of being added)
+   */
+  const std::vector< Ptr<XgponTcontOlt> >& GetTconts (XgponQosParameters::XgponTcontType type) const;
+
+
+  /**
+   * \brief start a DBA cycle from the T1 T-CONT after the one visited last.
+   * \return the first T-CONT to be served.
+   */
+  const Ptr<XgponTcontOlt>& StartCycle (void);
+
+  /**
+   * \return the T-CONT pointed by the cursor.
+   */
+  const Ptr<XgponTcontOlt>& GetCurrent (void) const;
+
+  /**
+   * \return the type of the T-CONT pointed by the cursor.
+   */
+  XgponQosParameters::XgponTcontType GetCurrentType (void) const;
+
+  /**
+   * \brief move the cursor to the next T-CONT.
+   * \param active if not null, the T-CONTs that are not candidates in it are jumped over (the first T-CONT of each round excepted).
+   */
+  XgponGiantStep Advance (const XgponOltDbaActiveTconts* active);
+
+
+  /**
+   * \return whether all T-CONTs were visited in this DBA cycle.
+   */
+  bool IsStopped (void) const;
+
+  /**
+   * \return whether the T3 (and T4) T-CONTs are in the GIR round.
+   */
+  bool IsFirstRound (void) const;
+
+  /**
+   * \return the position (in the list of its type) of the T-CONT of this type visited last.
+   */
+  uint16_t GetLastPosition (XgponQosParameters::XgponTcontType type) const;
+
+  /**
+   * \return the number of T-CONTs of this type that have not been visited yet in this round (the one visited last included).
+   */
+  uint16_t GetRemainingInRound (XgponQosParameters::XgponTcontType type) const;
+
+
+private:
+  //the position of the T-CONT of the type visited after the one at position; stop if the round ends first.
+  uint16_t GetNextPosition (const XgponOltDbaActiveTconts* active, uint8_t type, uint16_t position, uint16_t stop) const;
+
+  const static uint8_t XGPON_GIANT_TCONT_TYPES = 4;
+
+  std::vector< Ptr<XgponTcontOlt> > m_tconts[XGPON_GIANT_TCONT_TYPES];   //indexed by (type - 1)
+
+  uint16_t m_first[XGPON_GIANT_TCONT_TYPES];     //the position of the first T-CONT visited in the current round of each type
+  uint16_t m_last[XGPON_GIANT_TCONT_TYPES];      //the position of the T-CONT visited last of each type
+
+  uint8_t m_type;                                //the cursor: (type - 1) and the position in the list of this type
+  uint16_t m_current;
+
+  bool m_stop;
+  bool m_firstRound;
+
+  Ptr<XgponTcontOlt> m_nullTcont;                //returned when there is no T-CONT
+};
+
+
+
+/**
+ * \ingroup xgpon
+ * \brief The order in which the EBU DBA engine visits the T-CONTs. As in XgponOltDbaGiantCycle (two rounds per cycle),
+ *        T1, T2, T3 and then T4 are visited and T3 and T4 get a GIR and a PIR round in one DBA cycle.
+ *        But every type starts from the same position, which is moved to the cursor (SetNextCycleStart) every few DBA cycles.
+ *
+ * This replays the walk of EBU over the list of all T-CONTs (T1, T2, T3 and T4 of each ONU in turn),
+ * in which the T-CONT at the position p of the type t is the (4*p + t - 1)-th one. This is also its index in XgponOltDbaActiveTconts.
+ */
+class XgponOltDbaEbuCycle
+{
+public:
+  /**
+   * \brief Constructor
+   */
+  XgponOltDbaEbuCycle ();
+
+  /**
+   * \brief append one T-CONT (of type 1 to 4) to the list of its type.
+   * \return the index of the T-CONT in XgponOltDbaActiveTconts
+   */
+  uint32_t AddTcont (const Ptr<XgponTcontOlt>& tcont);
+
+  /**
+   * \return the T-CONTs of one type (in the order of being added)
+   */
+  const std::vector< Ptr<XgponTcontOlt> >& GetTconts (XgponQosParameters::XgponTcontType type) const;
+
+
+  /**
+   * \brief start a DBA cycle from the T1 T-CONT at the start position.
+   * \return the first T-CONT to be served.
+   */
+  const Ptr<XgponTcontOlt>& StartCycle (void);
+
+  /**
+   * \return the T-CONT pointed by the cursor.
+   */
+  const Ptr<XgponTcontOlt>& GetCurrent (void) const;
+
+  /**
+   * \return the type of the T-CONT pointed by the cursor.
+   */
+  XgponQosParameters::XgponTcontType GetCurrentType (void) const;
+
+  /**
+   * \brief move the cursor to the next T-CONT.
+   * \param active if not null, the T-CONTs that are not candidates in it are jumped over (the first T-CONT of each round excepted).
+   */
+  XgponGiantStep Advance (const XgponOltDbaActiveTconts* active);
+
+
+  /**
+   * \return whether all T-CONTs were visited in this DBA cycle.
+   */
+  bool IsStopped (void) const;
+
+  /**
+   * \return whether the T3 (and T4) T-CONTs are in the GIR round.
+   */
+  bool IsFirstRound (void) const;
+
+  /**
+   * \brief the following DBA cycles start from the position of the cursor.
+   */
+  void SetNextCycleStart (void);
+
+
+private:
+  //record the T-CONT pointed by the cursor as the first or the last one visited in the round of its type
+  void Visit (uint8_t type);
+
+  //the position of the T-CONT of the type visited after the one at position; stop if the round ends first.
+  uint16_t GetNextPosition (const XgponOltDbaActiveTconts* active, uint8_t type, uint16_t position, uint16_t stop) const;
+
+  //move the cursor to the start position of the type and start its round
+  void StartType (uint8_t type);
+
+  const static uint8_t XGPON_EBU_TCONT_TYPES = 4;
+  const static uint16_t NO_POSITION = 0xFFFF;
+
+  std::vector< Ptr<XgponTcontOlt> > m_tconts[XGPON_EBU_TCONT_TYPES];   //indexed by (type - 1)
+
+  bool m_visited[XGPON_EBU_TCONT_TYPES];         //whether the first T-CONT of the current round of each type is recorded
+  uint16_t m_first[XGPON_EBU_TCONT_TYPES];       //the position of the first T-CONT visited in the current round of each type
+  uint16_t m_last[XGPON_EBU_TCONT_TYPES];        //the position of the T-CONT visited last of each type
+
+  uint16_t m_start;                              //the position from which every type is visited in the DBA cycle
+  uint8_t m_type;                                //the cursor: (type - 1) and the position in the list of this type
+  uint16_t m_current;
+
+  bool m_stop;
+  bool m_firstRound;
+
+  Ptr<XgponTcontOlt> m_nullTcont;                //returned when there is no T-CONT
+};
+
+
+
+
+////////////////////////////////////////////////////INLINE Functions
+template <class RoundPolicy>
+XgponOltDbaGiantCycle<RoundPolicy>::XgponOltDbaGiantCycle ()
+  : m_type(0), m_current(0), m_stop(false), m_firstRound(true), m_nullTcont(0)
+{
+  for(uint8_t i = 0; i < XGPON_GIANT_TCONT_TYPES; i++)
+  {
+    m_first[i] = 0;
+    m_last[i] = 0;
+  }
+}
+
+template <class RoundPolicy>
+inline uint32_t
+XgponOltDbaGiantCycle<RoundPolicy>::AddTcont (const Ptr<XgponTcontOlt>& tcont)
+{
+  uint8_t type = (uint8_t) tcont->GetTcontType ();
+  NS_ASSERT_MSG((type >= 1 && type <= XGPON_GIANT_TCONT_TYPES), "The GIANT family only serves the T-CONTs of type 1 to 4!!!");
+  m_tconts[type - 1].push_back (tcont);
+  return (m_tconts[type - 1].size () - 1) * XGPON_GIANT_TCONT_TYPES + type - 1;
+}
+
+template <class RoundPolicy>
+inline const std::vector< Ptr<XgponTcontOlt> >&
+XgponOltDbaGiantCycle<RoundPolicy>::GetTconts (XgponQosParameters::XgponTcontType type) const
+{
+  return m_tconts[type - 1];
+}
+
+template <class RoundPolicy>
+inline const Ptr<XgponTcontOlt>&
+XgponOltDbaGiantCycle<RoundPolicy>::StartCycle (void)
+{
+  for(uint8_t i = 0; i < XGPON_GIANT_TCONT_TYPES; i++)
+  {
+    NS_ASSERT_MSG(!m_tconts[i].empty (), "The GIANT family needs T-CONTs of all four types to be served");
+  }
+
+  m_stop = false;
+  m_type = 0;
+  m_current = m_last[0];
+  m_first[0] = m_last[0];
+  return m_tconts[0][m_current];
+}
+
+template <class RoundPolicy>
+inline const Ptr<XgponTcontOlt>&
+XgponOltDbaGiantCycle<RoundPolicy>::GetCurrent (void) const
+{
+  if(m_current >= m_tconts[m_type].size ()) return m_nullTcont;
+  return m_tconts[m_type][m_current];
+}
+
+template <class RoundPolicy>
+inline XgponQosParameters::XgponTcontType
+XgponOltDbaGiantCycle<RoundPolicy>::GetCurrentType (void) const
+{
+  return static_cast<XgponQosParameters::XgponTcontType> (m_type + 1);
+}
+
+template <class RoundPolicy>
+inline uint16_t
+XgponOltDbaGiantCycle<RoundPolicy>::GetNextPosition (const XgponOltDbaActiveTconts* active, uint8_t type, uint16_t position, uint16_t stop) const
+{
+  if(active != 0)
+  {
+    uint32_t index = active->FindNextCandidate (position * XGPON_GIANT_TCONT_TYPES + type, stop * XGPON_GIANT_TCONT_TYPES + type, XGPON_GIANT_TCONT_TYPES);
+    return index / XGPON_GIANT_TCONT_TYPES;
+  }
+
+  position++;
+  if(position >= m_tconts[type].size ()) position = 0;
+  return position;
+}
+
+template <class RoundPolicy>
+inline XgponGiantStep
+XgponOltDbaGiantCycle<RoundPolicy>::Advance (const XgponOltDbaActiveTconts* active)
+{
+  uint8_t type = m_type;
+  m_last[type] = GetNextPosition (active, type, m_last[type], m_first[type]);
+  m_current = m_last[type];
+
+  //there are more T-CONTs of this type to be visited in this round.
+  if(m_first[type] != m_last[type]) return XGPON_GIANT_STEP_SAME_TYPE;
+
+  if(type < XGPON_GIANT_TCONT_TYPES - 1)
+  {
+    m_type = type + 1;
+    m_current = m_last[m_type];
+    m_first[m_type] = m_last[m_type];
+    if(RoundPolicy::TWO_ROUNDS_PER_CYCLE && m_type == 2) m_firstRound = true;
+    return XGPON_GIANT_STEP_NEXT_TYPE;
+  }
+
+  //all T4 T-CONTs were visited in this round. The cursor stays at the T4 T-CONT visited first in this round.
+  if(RoundPolicy::TWO_ROUNDS_PER_CYCLE && m_firstRound)
+  {
+    m_firstRound = false;
+    m_type = 2;
+    m_current = m_last[2];
+    m_first[2] = m_last[2];
+    return XGPON_GIANT_STEP_SECOND_ROUND;
+  }
+
+  m_stop = true;
+  m_last[0] = m_last[1] = m_last[2] = 0;
+  if(RoundPolicy::TWO_ROUNDS_PER_CYCLE)
+  {
+    m_firstRound = true;
+    m_last[3] = 0;
+  }
+  else
+  {
+    //the GIR and PIR rounds of T3 alternate between cycles; the next cycle starts its T4 round from the next T4 T-CONT.
+    m_firstRound = !m_firstRound;
+    m_last[3]++;
+    if(m_last[3] >= m_tconts[3].size ()) m_last[3] = 0;
+  }
+  return XGPON_GIANT_STEP_CYCLE_END;
+}
+
+template <class RoundPolicy>
+inline bool
+XgponOltDbaGiantCycle<RoundPolicy>::IsStopped (void) const
+{
+  return m_stop;
+}
+
+template <class RoundPolicy>
+inline bool
+XgponOltDbaGiantCycle<RoundPolicy>::IsFirstRound (void) const
+{
+  return m_firstRound;
+}
+
+template <class RoundPolicy>
+inline uint16_t
+XgponOltDbaGiantCycle<RoundPolicy>::GetLastPosition (XgponQosParameters::XgponTcontType type) const
+{
+  return m_last[type - 1];
+}
+
+template <class RoundPolicy>
+inline uint16_t
+XgponOltDbaGiantCycle<RoundPolicy>::GetRemainingInRound (XgponQosParameters::XgponTcontType type) const
+{
+  uint8_t i = type - 1;
+  if(m_first[i] <= m_last[i]) return m_tconts[i].size () - m_last[i] + m_first[i];
+  else return m_first[i] - m_last[i];
+}
+
+
+inline
+XgponOltDbaEbuCycle::XgponOltDbaEbuCycle ()
+  : m_start(0), m_type(0), m_current(0), m_stop(false), m_firstRound(true), m_nullTcont(0)
+{
+  for(uint8_t i = 0; i < XGPON_EBU_TCONT_TYPES; i++)
+  {
+    m_visited[i] = false;
+    m_first[i] = 0;
+    m_last[i] = NO_POSITION;
+  }
+}
+
+inline uint32_t
+XgponOltDbaEbuCycle::AddTcont (const Ptr<XgponTcontOlt>& tcont)
+{
+  uint8_t type = (uint8_t) tcont->GetTcontType ();
+  NS_ASSERT_MSG((type >= 1 && type <= XGPON_EBU_TCONT_TYPES), "EBU only serves the T-CONTs of type 1 to 4!!!");
+  m_tconts[type - 1].push_back (tcont);
+  return (m_tconts[type - 1].size () - 1) * XGPON_EBU_TCONT_TYPES + type - 1;
+}
+
+inline const std::vector< Ptr<XgponTcontOlt> >&
+XgponOltDbaEbuCycle::GetTconts (XgponQosParameters::XgponTcontType type) const
+{
+  return m_tconts[type - 1];
+}
+
+inline void
+XgponOltDbaEbuCycle::Visit (uint8_t type)
+{
+  if(m_visited[type]) m_last[type] = m_current;
+  else
+  {
+    m_first[type] = m_current;
+    m_visited[type] = true;
+  }
+}
+
+inline void
+XgponOltDbaEbuCycle::StartType (uint8_t type)
+{
+  m_type = type;
+  m_current = m_start % m_tconts[type].size ();
+  m_first[type] = m_current;
+  m_visited[type] = true;
+}
+
+inline const Ptr<XgponTcontOlt>&
+XgponOltDbaEbuCycle::StartCycle (void)
+{
+  for(uint8_t i = 0; i < XGPON_EBU_TCONT_TYPES; i++)
+  {
+    NS_ASSERT_MSG(!m_tconts[i].empty (), "EBU needs T-CONTs of all four types to be served");
+  }
+
+  m_stop = false;
+  m_type = 0;
+  m_current = m_start % m_tconts[0].size ();
+  Visit (0);
+  return m_tconts[0][m_current];
+}
+
+inline const Ptr<XgponTcontOlt>&
+XgponOltDbaEbuCycle::GetCurrent (void) const
+{
+  if(m_current >= m_tconts[m_type].size ()) return m_nullTcont;
+  return m_tconts[m_type][m_current];
+}
+
+inline XgponQosParameters::XgponTcontType
+XgponOltDbaEbuCycle::GetCurrentType (void) const
+{
+  return static_cast<XgponQosParameters::XgponTcontType> (m_type + 1);
+}
+
+inline uint16_t
+XgponOltDbaEbuCycle::GetNextPosition (const XgponOltDbaActiveTconts* active, uint8_t type, uint16_t position, uint16_t stop) const
+{
+  if(active != 0)
+  {
+    uint32_t index = active->FindNextCandidate (position * XGPON_EBU_TCONT_TYPES + type, stop * XGPON_EBU_TCONT_TYPES + type, XGPON_EBU_TCONT_TYPES);
+    return index / XGPON_EBU_TCONT_TYPES;
+  }
+
+  position++;
+  if(position >= m_tconts[type].size ()) position = 0;
+  return position;
+}
+
+inline XgponGiantStep
+XgponOltDbaEbuCycle::Advance (const XgponOltDbaActiveTconts* active)
+{
+  uint8_t type = m_type;
+  m_current = GetNextPosition (active, type, m_current, m_first[type]);
+  Visit (type);
+
+  //there are more T-CONTs of this type to be visited in this round.
+  if(m_first[type] != m_last[type]) return XGPON_GIANT_STEP_SAME_TYPE;
+
+  m_visited[type] = false;
+  if(type < XGPON_EBU_TCONT_TYPES - 1)
+  {
+    StartType (type + 1);
+    if(m_type == 2) m_firstRound = true;
+    return XGPON_GIANT_STEP_NEXT_TYPE;
+  }
+
+  if(m_firstRound)
+  {
+    m_firstRound = false;
+    StartType (2);
+    return XGPON_GIANT_STEP_SECOND_ROUND;
+  }
+
+  //the cursor goes back to the first T1 T-CONT, which is also where the next DBA cycle starts.
+  m_stop = true;
+  m_firstRound = true;
+  m_type = 0;
+  m_current = 0;
+  m_start = 0;
+  return XGPON_GIANT_STEP_CYCLE_END;
+}
+
+inline bool
+XgponOltDbaEbuCycle::IsStopped (void) const
+{
+  return m_stop;
+}
+
+inline bool
+XgponOltDbaEbuCycle::IsFirstRound (void) const
+{
+  return m_firstRound;
+}
+
+inline void
+XgponOltDbaEbuCycle::SetNextCycleStart (void)
+{
+  m_start = m_current;
+}
+
+
+} // namespace ns3
+
+#endif /* XGPON_OLT_DBA_GIANT_CYCLE_H */
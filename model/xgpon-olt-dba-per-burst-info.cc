@@ -168,15 +168,52 @@ XgponOltDbaPerBurstInfo::PutAllBwAllocIntoBwmap(const Ptr<XgponXgtcBwmap>& map,
 
 
 void
-XgponOltDbaPerBurstInfo::AddToExistingBwAlloc(Ptr<XgponXgtcBwAllocation> bwAlloc, uint32_t extraGrantSize)
+XgponOltDbaPerBurstInfo::AddToExistingBwAlloc(Ptr<XgponXgtcBwAllocation> bwAlloc, uint32_t extraGrantSize, uint8_t baseGrantSize)
 {
-  uint32_t origGrantSize = bwAlloc->GetGrantSize (); //ja:update:xgsponv5, passed as Bytes instead of Blocks
+  //the grant size of bwAlloc is in blocks; the burst size is in Bytes (as in AddOneNewBwAlloc)
+  uint32_t origGrantSize = bwAlloc->GetGrantSize ();
   bwAlloc->SetGrantSize(origGrantSize + extraGrantSize);
-  m_headerTrailerDataSize += extraGrantSize;
+  m_headerTrailerDataSize += extraGrantSize*baseGrantSize;
 
   UpdateFinalBurstSize();
 }
 
+uint32_t
+XgponOltDbaPerBurstInfo::GetFecPaddingSize(uint8_t baseGrantSize)
+{
+  if(!m_fec) return 0;
+
+  //the shortened codeword has paid the whole parity already (see UpdateFinalBurstSize).
+  uint32_t tmp = m_headerTrailerDataSize % m_dataBlockSize;
+  if(tmp==0) return 0;
+  else return (m_dataBlockSize - tmp) / baseGrantSize;
+}
+
+uint32_t
+XgponOltDbaPerBurstInfo::PadLastFecCodeword(uint32_t maxSize, uint64_t rtt, uint64_t slotSize, uint8_t baseGrantSize)
+{
+  NS_LOG_FUNCTION(this);
+
+  uint32_t padSize = GetFecPaddingSize (baseGrantSize);
+  if(padSize > maxSize) padSize = maxSize;
+
+  uint32_t addedSize = 0;
+  int num = m_bwAllocs.size();
+  for(int i=0; i<num && addedSize<padSize; i++)
+  {
+    //the grants of this burst are not in the service history yet; they are subtracted here.
+    uint32_t remaining = m_tcontOlts[i]->CalculateRemainingDataToServe(rtt, slotSize);
+    uint32_t grantSize = m_bwAllocs[i]->GetGrantSize ();
+    if(remaining <= grantSize) continue;
+
+    uint32_t extraSize = remaining - grantSize;
+    if(extraSize > (padSize - addedSize)) extraSize = padSize - addedSize;
+    AddToExistingBwAlloc(m_bwAllocs[i], extraSize, baseGrantSize);
+    addedSize += extraSize;
+  }
+  return addedSize;
+}
+
 Ptr<XgponXgtcBwAllocation>
 XgponOltDbaPerBurstInfo::FindBwAlloc(Ptr<XgponTcontOlt> tcontOlt)
 {
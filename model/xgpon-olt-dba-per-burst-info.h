@@ -94,8 +94,27 @@ public:
    * \brief Adds extra bytes in a BwAllocation already present in a burst.
    * \param bwAlloc The BwAlloction that is getting extra bytes
    * \param extraGrantSize The amount of base grant size (4/16 bytes) to add to the bwAlloc
+   * \param baseGrantSize the size of one block (4/16 bytes)
    */
-  void AddToExistingBwAlloc(Ptr<XgponXgtcBwAllocation> bwAlloc, uint32_t extraGrantSize);
+  void AddToExistingBwAlloc(Ptr<XgponXgtcBwAllocation> bwAlloc, uint32_t extraGrantSize, uint8_t baseGrantSize);
+
+  /**
+   * \brief Get the size that can still be put into the last (shortened) FEC codeword of this burst. 
+   *        This size does not need extra parity bytes. 0 if FEC is not used or the last codeword is full.
+   * \param baseGrantSize the size of one block (4/16 bytes)
+   * \return the size in blocks
+   */
+  uint32_t GetFecPaddingSize(uint8_t baseGrantSize);
+
+  /**
+   * \brief Pad the grants of this burst towards the end of its last (shortened) FEC codeword. 
+   *        The extra space is only given to the T-CONTs that still have data to upload after their grants in this burst.
+   * \param maxSize the maximal size to be added (unit: blocks)
+   * \param rtt, slotSize used to calculate the data that the T-CONTs still have (see XgponTcontOlt::CalculateRemainingDataToServe)
+   * \param baseGrantSize the size of one block (4/16 bytes)
+   * \return the size added into this burst (unit: blocks)
+   */
+  uint32_t PadLastFecCodeword(uint32_t maxSize, uint64_t rtt, uint64_t slotSize, uint8_t baseGrantSize);
 
 
 
@@ -0,0 +1,206 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2012 University College Cork (UCC), Ireland
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jerome Arokkiam <jerome.arokkia@bt.com>
+ */
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+
+#include "xgpon-olt-ds-scheduler-drr.h"
+#include "xgpon-xgem-frame.h"
+#include "xgpon-xgem-header.h"
+
+
+NS_LOG_COMPONENT_DEFINE ("XgponOltDsSchedulerDrr");
+
+namespace ns3{
+
+NS_OBJECT_ENSURE_REGISTERED (XgponOltDsSchedulerDrr);
+
+TypeId 
+XgponOltDsSchedulerDrr::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::XgponOltDsSchedulerDrr")
+    .SetParent<XgponOltDsScheduler> ()
+    .AddConstructor<XgponOltDsSchedulerDrr> ()
+    .AddAttribute ("QuantumInterval", 
+                   "The quantum of one connection is its contracted bandwidth multiplied with this interval (Unit: nanosecond).",
+                   UintegerValue (XGPON_DS_DRR_DEFAULT_QUANTUM_INTERVAL),
+                   MakeUintegerAccessor (&XgponOltDsSchedulerDrr::m_quantumInterval),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MinQuantum", 
+                   "The smallest quantum, also used for the connections without bandwidth configured (Unit: byte).",
+                   UintegerValue (XGPON_DS_DRR_DEFAULT_MIN_QUANTUM),
+                   MakeUintegerAccessor (&XgponOltDsSchedulerDrr::m_minQuantum),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+TypeId
+XgponOltDsSchedulerDrr::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+
+
+
+
+XgponOltDsSchedulerDrr::XgponOltDsSchedulerDrr ():XgponOltDsScheduler(),
+  m_quantumInterval(XGPON_DS_DRR_DEFAULT_QUANTUM_INTERVAL),
+  m_minQuantum(XGPON_DS_DRR_DEFAULT_MIN_QUANTUM),
+  m_headHasQuantum(false),
+  m_lastServedConn(0)
+{
+  m_entries.clear();
+  m_activeList.clear();
+}
+XgponOltDsSchedulerDrr::~XgponOltDsSchedulerDrr ()
+{
+}
+
+
+
+
+
+
+const Ptr<XgponConnectionSender>
+XgponOltDsSchedulerDrr::SelectConnToServe (uint32_t* amountToServe)
+{
+  NS_LOG_FUNCTION(this);
+  
+  NS_ASSERT_MSG((m_entries.size() > 0), "There is no downstream connections in the network!!!");
+
+  if(m_startFrame)
+  {
+    m_startFrame = false;
+    if(m_lastServedConn != nullptr && m_lastServedConn->IsSegmentationRunning ( ))  //the connection in segmentation has the highest priority.
+    {
+      //the whole XGEM frame had been charged when the first segment was scheduled.
+      *amountToServe = m_lastServedConn->GetFragBufOccupancy4Scheduling () * m_baseGrantSize;
+      return m_lastServedConn;
+    }
+  }
+
+  while(!m_activeList.empty())
+  {
+    DrrEntry& entry = m_entries[m_activeList.front()];
+    if(!m_headHasQuantum)
+    {
+      entry.m_deficit += entry.m_quantum;
+      m_headHasQuantum = true;
+    }
+
+    uint32_t frameSize = GetHeadXgemFrameSize (entry.m_conn);
+    if(frameSize == 0)  //drained: leave the active list and join again when new data arrives.
+    {
+      entry.m_deficit = 0;
+      entry.m_conn->SetInActiveList (false);
+      m_activeList.pop_front ();
+      m_headHasQuantum = false;
+    }
+    else if(frameSize <= entry.m_deficit)
+    {
+      entry.m_deficit -= frameSize;
+      *amountToServe = frameSize;
+      m_lastServedConn = entry.m_conn;
+      return entry.m_conn;
+    }
+    else  //the deficit is not enough for the next XGEM frame: move to the tail for the next round.
+    {
+      m_activeList.push_back (m_activeList.front());
+      m_activeList.pop_front ();
+      m_headHasQuantum = false;
+    }
+  }
+
+  *amountToServe = 0; 
+  return m_nullConn; 
+}
+
+
+
+
+
+
+void
+XgponOltDsSchedulerDrr::AddConnToScheduler (const Ptr<XgponConnectionSender>& conn)
+{
+  NS_ASSERT_MSG((m_entryIndexes.find(conn) == m_entryIndexes.end()), "The connection has been added to the scheduler!!!");
+
+  DrrEntry entry;
+  entry.m_conn = conn;
+  entry.m_quantum = CalculateQuantum (conn);
+  entry.m_deficit = 0;
+
+  m_entryIndexes[conn] = m_entries.size();
+  m_entries.push_back (entry);
+
+  conn->SetBackloggedCallback (MakeCallback (&XgponOltDsSchedulerDrr::ActivateConnection, this));
+  if(conn->GetQueueStatus() > 0) ActivateConnection (conn);
+
+  return;
+}
+
+
+void
+XgponOltDsSchedulerDrr::ActivateConnection (Ptr<XgponConnectionSender> conn)
+{
+  if(conn->IsInActiveList ()) return;
+  conn->SetInActiveList (true);
+
+  std::map<Ptr<XgponConnectionSender>, uint32_t>::const_iterator it = m_entryIndexes.find (conn);
+  NS_ASSERT_MSG((it != m_entryIndexes.end()), "The connection has not been added to the scheduler!!!");
+
+  m_entries[it->second].m_deficit = 0;
+  m_activeList.push_back (it->second);
+}
+
+
+
+
+
+
+uint32_t
+XgponOltDsSchedulerDrr::CalculateQuantum (const Ptr<XgponConnectionSender>& conn) const
+{
+  const Ptr<XgponQosParameters>& qos = conn->GetQosParameters ();
+  if(qos == nullptr) return m_minQuantum;
+
+  uint64_t bw = (uint64_t) qos->GetFixedBw () + qos->GetAssuredBw () + qos->GetNonAssuredBw () + qos->GetBestEffortBw ();  //unit: Bps
+  uint64_t quantum = bw * m_quantumInterval / 1000000000;
+
+  if(quantum < m_minQuantum) return m_minQuantum;
+  if(quantum > 0xFFFFFFFF) return 0xFFFFFFFF;
+  return (uint32_t) quantum;
+}
+
+
+uint32_t
+XgponOltDsSchedulerDrr::GetHeadXgemFrameSize (const Ptr<XgponConnectionSender>& conn)
+{
+  Ptr<const Packet> head = (conn->GetXgponQueue ())->Peek ();
+  if(head == nullptr) return 0;
+
+  return XgponXgemFrame::GetPaddedPayloadSize (head->GetSize()) + XgponXgemHeader::XGPON_XGEM_HEADER_LENGTH;
+}
+
+
+
+
+
+}//namespace ns3
@@ -0,0 +1,120 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2012 University College Cork (UCC), Ireland
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jerome Arokkiam <jerome.arokkia@bt.com>
+ */
+
+#ifndef XGPON_OLT_DS_SCHEDULER_DRR_H
+#define XGPON_OLT_DS_SCHEDULER_DRR_H
+
+#include <vector>
+#include <deque>
+#include <map>
+
+#include "xgpon-olt-ds-scheduler.h"
+
+
+
+namespace ns3 {
+
+/**
+ * \ingroup xgpon
+ * \brief The class used to schedule the downstream connections at OLT side through deficit round robin (DRR).
+ *
+ * Each connection has a quantum (bytes per round) proportional to its contracted bandwidth, i.e.,
+ * the sum of the bandwidths in its XgponQosParameters. Under overload, the connections converge to
+ * their contracted rates (or shares proportional to them if the network is over-subscribed).
+ * The deficit is charged with the size of whole XGEM frames (padded payload + XGEM header), so that
+ * one selection always covers exactly one XGEM frame and no packet is dropped due to a partial grant.
+ * Only the connections with data to send are kept in the active list.
+ */
+class XgponOltDsSchedulerDrr : public XgponOltDsScheduler
+{
+public:
+
+  const static uint32_t XGPON_DS_DRR_DEFAULT_QUANTUM_INTERVAL = 125000;  //unit: nanosecond (one downstream frame)
+  const static uint32_t XGPON_DS_DRR_DEFAULT_MIN_QUANTUM = 1600;         //larger than one XGEM frame with 1500-byte SDU. unit: byte
+
+  /**
+   * \brief Constructor
+   */
+  XgponOltDsSchedulerDrr ();
+  virtual ~XgponOltDsSchedulerDrr ();
+
+
+
+  /**
+   * \brief  Get the connection whose packets will be sent in this downstream frame. It implements the scheduling for downstream connections.
+   * \return the connection to be served. 0: all connections have no data to send.
+   * \param  amountToServe used to return the amount of data to be transmitted for this connection (the size of its first XGEM frame).
+   */  
+  virtual const Ptr<XgponConnectionSender>  SelectConnToServe (uint32_t* amountToServe);
+  
+
+  /**
+   * \brief Adds a connection to the scheduler. Its quantum is calculated from its QoS parameters.
+   * \param conn the downstream connection to be scheduled
+   * \return void
+   */  
+  virtual void AddConnToScheduler (const Ptr<XgponConnectionSender>& conn);   
+
+
+
+
+  //////////////////////////////////////////////Functions required by NS-3
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+
+
+protected:
+
+  /**
+   * \brief the state of one connection maintained by DRR.
+   */
+  struct DrrEntry
+  {
+    Ptr<XgponConnectionSender> m_conn;
+    uint32_t m_quantum;                 //unit: byte
+    uint32_t m_deficit;                 //unit: byte
+  };
+
+  //calculate the quantum of one connection based on its QoS parameters. unit: byte
+  uint32_t CalculateQuantum (const Ptr<XgponConnectionSender>& conn) const;
+
+  //the size of the XGEM frame that carries the first packet in the queue. 0: the queue is empty.
+  static uint32_t GetHeadXgemFrameSize (const Ptr<XgponConnectionSender>& conn);
+
+  //called by one connection when it receives data and is not in the active list.
+  void ActivateConnection (Ptr<XgponConnectionSender> conn);
+
+
+  uint32_t m_quantumInterval;      //the quantum is the contracted bandwidth multiplied with this interval. unit: nanosecond
+  uint32_t m_minQuantum;           //the smallest quantum (also used for connections without QoS parameters). unit: byte
+
+  std::vector<DrrEntry> m_entries;                 //all connections
+  std::map<Ptr<XgponConnectionSender>, uint32_t> m_entryIndexes;   //the index of one connection in m_entries
+
+  std::deque<uint32_t> m_activeList;    //the indexes of the connections that may have data to send. The first one is being served.
+  bool m_headHasQuantum;                //whether the first connection in the active list has received the quantum of this round.
+  Ptr<XgponConnectionSender> m_lastServedConn;   //the connection served most recently (checked for segmentation at frame start)
+};
+
+
+
+}; // namespace ns3
+
+#endif // XGPON_OLT_DS_SCHEDULER_DRR_H
@@ -0,0 +1,140 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2012 University College Cork (UCC), Ireland
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jerome Arokkiam <jerome.arokkia@bt.com>
+ */
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+
+#include "xgpon-olt-ds-scheduler-priority-drr.h"
+
+
+NS_LOG_COMPONENT_DEFINE ("XgponOltDsSchedulerPriorityDrr");
+
+namespace ns3{
+
+NS_OBJECT_ENSURE_REGISTERED (XgponOltDsSchedulerPriorityDrr);
+
+TypeId 
+XgponOltDsSchedulerPriorityDrr::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::XgponOltDsSchedulerPriorityDrr")
+    .SetParent<XgponOltDsSchedulerDrr> ()
+    .AddConstructor<XgponOltDsSchedulerPriorityDrr> ()
+    .AddAttribute ("PriorityClass", 
+                   "The traffic class (TOS >> 2) whose connections are served with strict priority.",
+                   UintegerValue (XGPON_DS_DEFAULT_PRIORITY_CLASS),
+                   MakeUintegerAccessor (&XgponOltDsSchedulerPriorityDrr::m_priorityClass),
+                   MakeUintegerChecker<uint8_t> ())
+  ;
+  return tid;
+}
+TypeId
+XgponOltDsSchedulerPriorityDrr::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+
+
+
+
+XgponOltDsSchedulerPriorityDrr::XgponOltDsSchedulerPriorityDrr ():XgponOltDsSchedulerDrr(),
+  m_priorityClass(XGPON_DS_DEFAULT_PRIORITY_CLASS)
+{
+  m_priorityActiveList.clear();
+}
+XgponOltDsSchedulerPriorityDrr::~XgponOltDsSchedulerPriorityDrr ()
+{
+}
+
+
+
+
+
+
+const Ptr<XgponConnectionSender>
+XgponOltDsSchedulerPriorityDrr::SelectConnToServe (uint32_t* amountToServe)
+{
+  NS_LOG_FUNCTION(this);
+
+  if(m_startFrame)
+  {
+    m_startFrame = false;
+    if(m_lastServedConn != nullptr && m_lastServedConn->IsSegmentationRunning ( ))  //the connection in segmentation has the highest priority.
+    {
+      *amountToServe = m_lastServedConn->GetFragBufOccupancy4Scheduling () * m_baseGrantSize;
+      return m_lastServedConn;
+    }
+  }
+
+  //strict priority: one XGEM frame per connection of the priority class in a round-robin manner.
+  while(!m_priorityActiveList.empty())
+  {
+    Ptr<XgponConnectionSender> conn = m_priorityActiveList.front();
+    m_priorityActiveList.pop_front ();
+
+    uint32_t frameSize = GetHeadXgemFrameSize (conn);
+    if(frameSize == 0)  //drained: join again when new data arrives.
+    {
+      conn->SetInActiveList (false);
+    }
+    else
+    {
+      m_priorityActiveList.push_back (conn);
+      *amountToServe = frameSize;
+      m_lastServedConn = conn;
+      return conn;
+    }
+  }
+
+  return XgponOltDsSchedulerDrr::SelectConnToServe (amountToServe);
+}
+
+
+
+
+
+
+void
+XgponOltDsSchedulerPriorityDrr::AddConnToScheduler (const Ptr<XgponConnectionSender>& conn)
+{
+  if(conn->GetTrafficClass () != m_priorityClass)
+  {
+    XgponOltDsSchedulerDrr::AddConnToScheduler (conn);
+    return;
+  }
+
+  conn->SetBackloggedCallback (MakeCallback (&XgponOltDsSchedulerPriorityDrr::ActivatePriorityConnection, this));
+  if(conn->GetQueueStatus() > 0) ActivatePriorityConnection (conn);
+}
+
+
+void
+XgponOltDsSchedulerPriorityDrr::ActivatePriorityConnection (Ptr<XgponConnectionSender> conn)
+{
+  if(conn->IsInActiveList ()) return;
+  conn->SetInActiveList (true);
+
+  m_priorityActiveList.push_back (conn);
+}
+
+
+
+
+
+}//namespace ns3
@@ -0,0 +1,93 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2012 University College Cork (UCC), Ireland
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jerome Arokkiam <jerome.arokkia@bt.com>
+ */
+
+#ifndef XGPON_OLT_DS_SCHEDULER_PRIORITY_DRR_H
+#define XGPON_OLT_DS_SCHEDULER_PRIORITY_DRR_H
+
+#include <deque>
+
+#include "xgpon-olt-ds-scheduler-drr.h"
+
+
+
+namespace ns3 {
+
+/**
+ * \ingroup xgpon
+ * \brief The downstream scheduler that serves the connections of the top traffic class with strict priority
+ *        and the other connections through deficit round robin.
+ *
+ * The traffic class of one connection is set when it is added (see XgponHelper::AddOneClassDownstreamConnectionForOnu).
+ * The connections of the priority class are served one XGEM frame at a time in a round-robin manner, 
+ * before any connection of the other classes. Thus, real-time traffic only waits for the frames being transmitted.
+ */
+class XgponOltDsSchedulerPriorityDrr : public XgponOltDsSchedulerDrr
+{
+public:
+
+  const static uint8_t XGPON_DS_DEFAULT_PRIORITY_CLASS = 1;  //the same as T-CONT type 1 in the upstream
+
+  /**
+   * \brief Constructor
+   */
+  XgponOltDsSchedulerPriorityDrr ();
+  virtual ~XgponOltDsSchedulerPriorityDrr ();
+
+
+
+  /**
+   * \brief  Get the connection whose packets will be sent in this downstream frame. It implements the scheduling for downstream connections.
+   * \return the connection to be served. 0: all connections have no data to send.
+   * \param  amountToServe used to return the amount of data to be transmitted for this connection (the size of its first XGEM frame).
+   */  
+  virtual const Ptr<XgponConnectionSender>  SelectConnToServe (uint32_t* amountToServe);
+  
+
+  /**
+   * \brief Adds a connection to the scheduler based on its traffic class.
+   * \param conn the downstream connection to be scheduled
+   * \return void
+   */  
+  virtual void AddConnToScheduler (const Ptr<XgponConnectionSender>& conn);   
+
+
+
+
+  //////////////////////////////////////////////Functions required by NS-3
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+
+
+private:
+
+  //called by one connection of the priority class when it receives data and is not in the active list.
+  void ActivatePriorityConnection (Ptr<XgponConnectionSender> conn);
+
+
+  uint8_t m_priorityClass;         //the traffic class served with strict priority, configured through attribute
+
+  std::deque< Ptr<XgponConnectionSender> > m_priorityActiveList;   //the connections of the priority class that may have data to send.
+};
+
+
+
+}; // namespace ns3
+
+#endif // XGPON_OLT_DS_SCHEDULER_PRIORITY_DRR_H
@@ -54,10 +54,11 @@ XgponOltDsSchedulerRoundRobin::GetInstanceTypeId (void) const
 
 
 
-XgponOltDsSchedulerRoundRobin::XgponOltDsSchedulerRoundRobin ():XgponOltDsScheduler(),
-  m_lastServedConnIndex(0)
+XgponOltDsSchedulerRoundRobin::XgponOltDsSchedulerRoundRobin ():XgponOltDsScheduler()
 {
   m_dsAllConns.clear();
+  m_activeConns.clear();
+  m_lastServedConn = m_activeConns.end();
 }
 XgponOltDsSchedulerRoundRobin::~XgponOltDsSchedulerRoundRobin ()
 {
@@ -79,7 +80,7 @@ XgponOltDsSchedulerRoundRobin::SelectConnToServe (uint32_t* amountToServe)
   {
     m_startFrame = false;
     const Ptr<XgponConnectionSender> lastConn = GetTheLastServedConnection ();
-    if(lastConn->IsSegmentationRunning ( ))  //the connection in segmentation has the highest priority.
+    if(lastConn != nullptr && lastConn->IsSegmentationRunning ( ))  //the connection in segmentation has the highest priority.
     {
       *amountToServe = lastConn->GetFragBufOccupancy4Scheduling () * m_baseGrantSize; //ja:update:xgspon
       return lastConn;
@@ -87,16 +88,11 @@ XgponOltDsSchedulerRoundRobin::SelectConnToServe (uint32_t* amountToServe)
   }
 
   //get one connection who has data to transmit
-  uint16_t numEmpty = 0;
   Ptr<XgponConnectionSender> conn = GetNextConnection2Serve ();
-  while(conn->GetQueueStatus()==0)
-  {
-    numEmpty++;
-    if(numEmpty > m_dsAllConns.size()) //all connections are empty. There is no data in the OLT.
-    { 
-      *amountToServe = 0; 
-      return m_nullConn; 
-    } else { conn = GetNextConnection2Serve (); }
+  if(conn == nullptr) //all connections are empty. There is no data in the OLT.
+  { 
+    *amountToServe = 0; 
+    return m_nullConn; 
   }
 
   //calculate the amount of data to be served
@@ -118,12 +114,29 @@ XgponOltDsSchedulerRoundRobin::AddConnToScheduler (const Ptr<XgponConnectionSend
 {
   m_dsAllConns.push_back(conn);
 
+  conn->SetBackloggedCallback (MakeCallback (&XgponOltDsSchedulerRoundRobin::ActivateConnection, this));
+  if(conn->GetQueueStatus() > 0) ActivateConnection (conn);
+
   return;
 }
 
 
 
 
+void
+XgponOltDsSchedulerRoundRobin::ActivateConnection (Ptr<XgponConnectionSender> conn)
+{
+  if(conn->IsInActiveList ()) return;
+  conn->SetInActiveList (true);
+
+  //put it just before the connection served most recently, i.e., at the tail of the current round.
+  if(m_lastServedConn == m_activeConns.end()) m_activeConns.push_back (conn);
+  else m_activeConns.insert (m_lastServedConn, conn);
+}
+
+
+
+
 
 
 }//namespace ns3
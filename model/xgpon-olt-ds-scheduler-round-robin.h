@@ -22,6 +22,7 @@
 #define XGPON_OLT_DS_SCHEDULER_ROUND_ROBIN_H
 
 #include <vector>
+#include <list>
 
 #include "xgpon-olt-ds-scheduler.h"
 
@@ -32,6 +33,10 @@ namespace ns3 {
 /**
  * \ingroup xgpon
  * \brief The class used to schedule the downstream connections at OLT side in a round-robin manner. 
+ *
+ * Only the connections with data to send are kept in a ring (active list). A connection joins the ring
+ * when it receives one packet from upper layers and leaves the ring when it is found empty by the scheduler.
+ * Thus, selecting the next connection does not walk the idle connections.
  */
 class XgponOltDsSchedulerRoundRobin : public XgponOltDsScheduler
 {
@@ -73,6 +78,9 @@ public:
 
 private:
 
+  //called by one connection when it receives data and is not in the active list.
+  void ActivateConnection (Ptr<XgponConnectionSender> conn);
+
   //Get the last connection served in the last downstream connection.
   Ptr<XgponConnectionSender> GetTheLastServedConnection () const;  
 
@@ -84,10 +92,12 @@ private:
 
 
 
-  //used when selecting the next connection
-  uint16_t m_lastServedConnIndex;   //the index in this list for the connection that are served most recently.
   std::vector< Ptr<XgponConnectionSender> > m_dsAllConns;
 
+  //used when selecting the next connection
+  std::list< Ptr<XgponConnectionSender> > m_activeConns;                //the ring of connections that may have data to send.
+  std::list< Ptr<XgponConnectionSender> >::iterator m_lastServedConn;  //the connection served most recently (end: none).
+
 };
 
 
@@ -99,17 +109,32 @@ private:
 inline Ptr<XgponConnectionSender> 
 XgponOltDsSchedulerRoundRobin::GetTheLastServedConnection () const
 {
-  return m_dsAllConns[m_lastServedConnIndex];
+  if(m_lastServedConn == m_activeConns.end()) return m_nullConn;
+  return *m_lastServedConn;
 }
 
 
 inline Ptr<XgponConnectionSender> 
 XgponOltDsSchedulerRoundRobin::GetNextConnection2Serve ()
 {
-  m_lastServedConnIndex++;
-  if(m_lastServedConnIndex >= m_dsAllConns.size()) m_lastServedConnIndex = 0;
-
-  return m_dsAllConns[m_lastServedConnIndex];
+  while(!m_activeConns.empty())
+  {
+    std::list< Ptr<XgponConnectionSender> >::iterator it = m_lastServedConn;
+    if(it == m_activeConns.end() || ++it == m_activeConns.end()) it = m_activeConns.begin();
+
+    if((*it)->GetQueueStatus() > 0) 
+    {
+      m_lastServedConn = it;
+      return *it;
+    }
+
+    //this connection has been drained. It leaves the ring and will join again when new data arrives.
+    (*it)->SetInActiveList (false);
+    if(it == m_lastServedConn) m_lastServedConn = m_activeConns.end();
+    m_activeConns.erase (it);
+  }
+
+  return m_nullConn;
 }
 
 
@@ -83,11 +83,60 @@ XgponOltFramingEngine::ProduceXgtcDsFrame (XgponXgtcDsFrame& xgtcDsFrame)
 
   //BWmap
   header.SetBwmap ((m_device->GetDbaEngine( ))->GenerateBwMap ());
+  (header.GetBwmap ( ))->SetSfc ((m_device->GetPhyAdapter ( ))->GetSfc ( ));   //the superframe counter to be assigned to this frame
+  header.CalculateHec ();
 
   //produce a list of xgem frames
   uint32_t payloadLen = (m_device->GetXgponPhy())->GetXgtcDsFrameSize ( )  - header.GetSerializedSize();
   //std::cout << "dsFrame frame size: " << (m_device->GetXgponPhy())->GetXgtcDsFrameSize ( ) << ", payload Len : " << payloadLen << std::endl;//ja:update:xgspon
-  (m_device->GetXgemEngine( ))->GenerateFramesToTransmit(xgtcDsFrame.GetUnicastXgemFrames(), xgtcDsFrame.GetBroadcastXgemFrames(), xgtcDsFrame.GetBitmap(), payloadLen); 
+  uint32_t idleSize = (m_device->GetXgemEngine( ))->GenerateFramesToTransmit(xgtcDsFrame.GetUnicastXgemFrames(), xgtcDsFrame.GetBroadcastXgemFrames(), xgtcDsFrame.GetServedOnus(), payloadLen); 
+  xgtcDsFrame.AddIdleSpan (idleSize);
+
+  MarkOnusForDelivery (xgtcDsFrame);
+
+  return;
+}
+
+
+void 
+XgponOltFramingEngine::MarkOnusForDelivery (XgponXgtcDsFrame& xgtcDsFrame)
+{
+  NS_LOG_FUNCTION(this);
+
+  if(xgtcDsFrame.GetNBroadcastXgemFrames() > 0)
+  {
+    xgtcDsFrame.MarkAllOnusForDelivery ( );
+    return;
+  }
+
+  XgponXgtcDsHeader& header = xgtcDsFrame.GetHeader ();
+
+  //PLOAM messages
+  uint32_t ploamNum = header.GetPloamCount ();
+  for(uint32_t i=0; i<ploamNum; i++)
+  {
+    uint16_t onuId = header.GetPloamByIndex(i)->GetOnuId();
+    if(onuId == XgponXgtcDsFrame::XGPON_BROADCAST_ONU_ID)
+    {
+      xgtcDsFrame.MarkAllOnusForDelivery ( );
+      return;
+    }
+    xgtcDsFrame.MarkOnuForDelivery (onuId);
+  }
+
+  //grants in BWmap; the default Alloc-ID of one ONU is its ONU-ID.
+  const Ptr<XgponOltConnManager>& connManager = m_device->GetConnManager ( );
+  const Ptr<XgponXgtcBwmap>& bwmap = header.GetBwmap ( );
+  uint16_t bwMapSize = bwmap->GetNumberOfBwAllocation ( );
+  for(uint16_t i=0; i<bwMapSize; i++)
+  {
+    uint16_t allocId = bwmap->GetBwAllocationByIndex(i)->GetAllocId();
+    const Ptr<XgponTcontOlt>& tcont = connManager->GetTcontById (allocId);
+    if(tcont != nullptr) xgtcDsFrame.MarkOnuForDelivery (tcont->GetOnuId());
+    else if(allocId < XgponXgtcDsFrame::XGPON_BROADCAST_ONU_ID) xgtcDsFrame.MarkOnuForDelivery (allocId);
+  }
+
+  //the ONUs served by unicast XGEM frames are covered by the served ONU set of the frame.
 
   return;
 }
@@ -115,7 +164,7 @@ XgponOltFramingEngine::ParseXgtcUpstreamBurst (XgponXgtcUsBurst& burst, uint64_t
 
   //find the BWmap in which this burst was scheduled
   const Ptr<XgponOltDbaEngine>& dbaEngine = m_device->GetDbaEngine ( );
-  Ptr<XgponXgtcBwmap> bwmap = dbaEngine->GetBwMap4CurrentBurst (nowNano);
+  const Ptr<XgponXgtcBwmap>& bwmap = dbaEngine->GetBwMap4CurrentBurst (nowNano);
   NS_ASSERT_MSG((bwmap!=nullptr), "Cannot find the corresponding Bwmap of this upstream burst.");
 
 
@@ -150,7 +199,7 @@ XgponOltFramingEngine::ParseXgtcUpstreamBurst (XgponXgtcUsBurst& burst, uint64_t
     if(bwAlloc->GetDbruFlag ()) dbaEngine->ReceiveStatusReport(alloc->GetDbru(), onuId, allocId, nowNano); 
 
     //xgem frames
-    xgemEngine->ProcessXgemFramesFromLowerLayer (alloc->GetXgemFrames ( ), onuId, allocId);
+    xgemEngine->ProcessXgemFramesFromLowerLayer (alloc->GetXgemFrames ( ), onuId, allocId, bwmap->GetSfc ( ));
   }  
 
   return;
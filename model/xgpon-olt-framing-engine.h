@@ -60,6 +60,10 @@ public:
   static TypeId GetTypeId (void);
   virtual TypeId GetInstanceTypeId (void) const;
 
+private:
+  //mark the ONUs that have unicast data, a grant, a PLOAM or broadcast content in this frame (for the delivery filter of the channel)
+  void MarkOnusForDelivery (XgponXgtcDsFrame& xgtcDsFrame);
+
 };
 
 }// namespace ns3
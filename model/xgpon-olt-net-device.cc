@@ -114,8 +114,8 @@ XgponOltNetDevice::ReceivePonFrameFromChannel (const Ptr<PonFrame>& frame)
   //get the burst profile used by this burst based on the bwmap history maintained by dba engine and the time that this burst is received
   const Ptr<XgponBurstProfile>& profile = m_oltDbaEngine->GetProfile4BurstFromChannel(now.GetNanoSeconds());
 
-  //PHY+PHY-Adaptation sub-layer  
-  m_oltPhyAdapter->ProcessXgponUsBurstFromChannel(usBurst, profile);
+  //PHY+PHY-Adaptation sub-layer; the burst is lost when its header or one DBRu cannot be corrected.
+  if(!m_oltPhyAdapter->ProcessXgponUsBurstFromChannel(usBurst, profile)) return;
 
 
   //Framing sub-layer
@@ -130,6 +130,17 @@ XgponOltNetDevice::ReceivePonFrameFromChannel (const Ptr<PonFrame>& frame)
 
 
 
+void 
+XgponOltNetDevice::AnnounceUpstreamData (uint16_t allocId, uint32_t size, const Time& arrival)
+{
+  NS_LOG_FUNCTION(this);
+  NS_ASSERT_MSG((arrival >= Simulator::Now()), "The data is announced after its arrival!!!");
+
+  m_oltDbaEngine->AnnounceUpstreamData (allocId, size, arrival.GetNanoSeconds());
+}
+
+
+
 
 
 
@@ -149,7 +160,8 @@ XgponOltNetDevice::DoSend (const Ptr<Packet>& packet, const Address& dest, uint1
   dstAddress=ipHeader.GetDestination();  
 
 	NS_LOG_FUNCTION (this << ipHeader.GetSource() << dstAddress << packet << protocolNumber << dest); 
-  const Ptr<XgponConnectionSender>& conn=m_oltConnManager->FindDsConnByAddress(dstAddress);	
+  uint8_t trafficClass = ipHeader.GetTos() >> 2;  //the same as the T-CONT type derived at ONU-side (ECN bits excluded)
+  const Ptr<XgponConnectionSender>& conn=m_oltConnManager->FindDsConnByAddressAndClass(dstAddress, trafficClass);	
   if(conn == nullptr) return false;
   else
   {
@@ -178,6 +190,9 @@ XgponOltNetDevice::DoInitialize (void)
 {
   NS_LOG_FUNCTION(this);
 
+  //in distributed simulations, only the rank that simulates the OLT generates downstream frames.
+  if(GetNode ()->GetSystemId () != Simulator::GetSystemId ()) return;
+
   Simulator::ScheduleNow(&XgponOltNetDevice::SendDownstreamFrameToChannelPeriodically, this );
   return;
 }
@@ -64,6 +64,17 @@ public:
   virtual void ReceivePonFrameFromChannel (const Ptr<PonFrame>& frame);
 
 
+  /**
+   * \brief announce the upstream data that will arrive at one T-CONT (cooperative DBA for mobile fronthaul/midhaul).
+   *        An external scheduler (e.g., the one of a small cell behind the ONU) calls it ahead of time, so that
+   *        the T-CONT is granted in the frame that the data arrives, without the status-report/grant loop.
+   * \param allocId the T-CONT that the data is put into
+   * \param size the size of the XGEM frames (XGEM headers included) that carry the data. unit: byte
+   * \param arrival the time that the data arrives at the T-CONT
+   */
+  void AnnounceUpstreamData (uint16_t allocId, uint32_t size, const Time& arrival);
+
+
 
   ///////////////////////////////////////////////////////member variable accessors
   const Ptr<XgponOltConnManager>& GetConnManager ( ) const; 
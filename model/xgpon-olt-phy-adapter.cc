@@ -18,12 +18,17 @@
  * Author: Xiuchao Wu <xw2@cs.ucc.ie>
  */
 #include "ns3/log.h"
+#include "ns3/simulator.h"
 
 #include "xgpon-olt-phy-adapter.h"
 #include "xgpon-olt-net-device.h"
+#include "xgpon-olt-ploam-engine.h"
 
 //#include "xgpon-psbu.h"
 #include "xgpon-psbd.h"
+#include "xgpon-fec.h"
+#include "xgpon-integrity.h"
+#include "xgpon-xgem-routines.h"
 
 
 
@@ -60,15 +65,105 @@ XgponOltPhyAdapter::~XgponOltPhyAdapter ()
 
 
 
-void 
+bool 
 XgponOltPhyAdapter::ProcessXgponUsBurstFromChannel (const Ptr<XgponUsBurst>& burst, const Ptr<XgponBurstProfile>& profile)
 {
   NS_LOG_FUNCTION(this);
 
-  //profile is determined based on the receiving time.
-  //it might be used for deserialization, FEC decode, etc. when physical layer details are simulated. 
+  XgponXgtcUsBurst& xgtcBurst = burst->GetXgtcUsBurst ();
+
+  //the HEC of the header and the BIP-32 trailer are only checked when integrity fields are enabled.
+  if(XgponIntegrity::IsEnabled () && (!xgtcBurst.GetHeader ().VerifyHec () || !xgtcBurst.VerifyTrailer ()))
+  {
+    NS_LOG_INFO("Upstream burst dropped for HEC or BIP mismatch.");
+    DiscardSdus4LostBurst (xgtcBurst);
+    return false;
+  }
 
-  return;
+  //profile is determined based on the receiving time.
+  Ptr<XgponChannel> channel = DynamicCast<XgponChannel, Channel> (m_device->GetChannel ());
+  if(channel == nullptr) return true;
+
+  bool analytic = channel->IsAnalyticErrorModelUsed ();
+  if(!analytic && !XgponFec::IsEnabled () && !channel->IsBitErrorEnabled ()) return true;
+
+  uint32_t len = xgtcBurst.GetSerializedSize ();
+  std::vector<uint32_t> lostBlocks;
+  const XgponFec* code;
+
+  if(analytic)
+  {
+    //the bytes are not simulated: the lost codewords are sampled from the bit error rate of this ONU.
+    const Ptr<XgponLinkInfo>& linkInfo = (m_device->GetPloamEngine ())->GetLinkInfo (xgtcBurst.GetHeader ().GetOnuId ());
+    double ber = linkInfo->GetBitErrorRate ();
+    if(ber < 0) ber = channel->GetBitErrorRate ();
+    if(ber <= 0) return true;
+
+    code = &XgponFec::GetUsCode (m_device->GetXgponPhy (), profile->GetFec ());
+    channel->SampleLostBlocks (code->GetUncorrectableProbability (ber), code->GetNumberOfBlocks (len), lostBlocks);
+    if(lostBlocks.empty ()) return true;
+  }
+  else
+  {
+    code = &XgponFec::GetUsCode (m_device->GetXgponPhy (), XgponFec::IsEnabled () && profile->GetFec ());
+
+    std::vector<uint8_t>& sent = burst->GetCodewords ();
+    if(sent.empty ())   //the codewords are not carried between ranks in distributed simulations.
+    {
+      Buffer buffer;
+      buffer.AddAtStart (len);
+      xgtcBurst.Serialize (buffer.Begin ());
+      code->EncodeBlocks (buffer.PeekData (), len, sent);
+    }
+
+    std::vector<uint8_t> received (sent);
+    uint32_t flipped = channel->AddBitErrors (&received[0], received.size ());
+    if(flipped == 0 && code->GetParitySize () == 0) return true;
+
+    code->DecodeBlocks (&received[0], &sent[0], len, lostBlocks);
+    if(lostBlocks.empty ()) return true;
+    NS_LOG_INFO("Upstream burst with " << flipped << " flipped bits and " << lostBlocks.size () << " damaged blocks.");
+  }
+
+
+  //the burst has only one receiver. Thus, the XGEM frames in damaged blocks are replaced in it directly.
+  //The offsets follow XgponXgtcUsBurst::Serialize.
+  uint32_t offset = xgtcBurst.GetHeader ().GetSerializedSize ();
+  if(code->IsRangeLost (lostBlocks, 0, offset)) 
+  {
+    DiscardSdus4LostBurst (xgtcBurst);
+    return false;
+  }
+
+  uint16_t allocNum = xgtcBurst.GetUsAllocationCount ();
+  for(uint16_t j = 0; j < allocNum; j++)
+  {
+    const Ptr<XgponXgtcUsAllocation>& alloc = xgtcBurst.GetUsAllocationByIndex (j);
+    if(alloc->DoesDbruExist ())
+    {
+      uint32_t dbruSize = alloc->GetDbru ()->GetSerializedSize ();
+      if(code->IsRangeLost (lostBlocks, offset, offset + dbruSize)) 
+      {
+        DiscardSdus4LostBurst (xgtcBurst);
+        return false;
+      }
+      offset += dbruSize;
+    }
+
+    std::vector<Ptr<XgponXgemFrame> >& frames = alloc->GetXgemFrames ();
+    std::vector<Ptr<XgponXgemFrame> >::iterator it, out = frames.begin ();
+    for(it = frames.begin (); it != frames.end (); it++)
+    {
+      uint32_t frameSize = (*it)->GetSerializedSize ();
+      if(!code->IsRangeLost (lostBlocks, offset, offset + frameSize)) *(out++) = *it;
+      else if((*it)->GetType () == XgponXgemFrame::XGPON_XGEM_FRAME_WITH_DATA) *(out++) = XgponXgemRoutines::CreateLostXgemFrame (*it);
+      offset += frameSize;
+    }
+    frames.erase (out, frames.end ());
+    offset += alloc->GetIdleSpan ();
+  }
+
+  return true;
 }
 
 
@@ -83,13 +178,64 @@ XgponOltPhyAdapter::ProcessXgtcDsFrameFromUpperLayer (const Ptr<XgponDsFrame>& f
   psbd.SetPsync(0);                  //currently, we don't care about the value of PSYNC
   psbd.SetSfc(m_sfc++);              //frame counter must be added by one
   psbd.SetPonId (m_ponid);
-  psbd.CalculateSfcHec (0);
+  psbd.CalculateSfcHec (psbd.GetSfc ());
   psbd.CalculatePonIdHec (m_ponid);
 
-  //FEC and Line Coding are omitted here.
+  //Line coding is omitted. The codewords are only calculated when the bytes are simulated (FEC or bit errors enabled).
+  //PSBd is not FEC-protected; the XGTC frame is encoded.
+  if(GetChannel4ByteSimulation () != nullptr)
+  {
+    XgponXgtcDsFrame& xgtcFrame = frame->GetXgtcDsFrame ();
+    uint32_t len = xgtcFrame.GetSerializedSize ();
+    Buffer buffer;
+    buffer.AddAtStart (len);
+    xgtcFrame.Serialize (buffer.Begin ());
+    XgponFec::GetDsCode (m_device->GetXgponPhy (), XgponFec::IsEnabled ()).EncodeBlocks (buffer.PeekData (), len, frame->GetCodewords ());
+  }
 
   return;  
 }
 
 
+
+void
+XgponOltPhyAdapter::DiscardSdus4LostBurst (XgponXgtcUsBurst& xgtcBurst)
+{
+  uint16_t allocNum = xgtcBurst.GetUsAllocationCount ();
+  if(allocNum == 0) return;
+
+  //the T-CONTs of the allocations are found from the BWmap in which this burst was scheduled (as XgponOltFramingEngine does).
+  uint64_t nowNano = Simulator::Now ().GetNanoSeconds ();
+  const Ptr<XgponOltDbaEngine>& dbaEngine = m_device->GetDbaEngine ( );
+  const Ptr<XgponXgtcBwmap>& bwmap = dbaEngine->GetBwMap4CurrentBurst (nowNano);
+  uint32_t first = dbaEngine->GetIndexOfBurstFirstBwAllocation (bwmap, nowNano);
+  const Ptr<XgponOltConnManager>& connManager = m_device->GetConnManager ( );
+
+  for(uint16_t j = 0; j < allocNum; j++)
+  {
+    const Ptr<XgponTcontOlt>& tcontOlt = connManager->GetTcontById (bwmap->GetBwAllocationByIndex (first + j)->GetAllocId ());
+    if(tcontOlt == nullptr) continue;
+
+    std::vector<Ptr<XgponXgemFrame> >& frames = xgtcBurst.GetUsAllocationByIndex (j)->GetXgemFrames ();
+    std::vector<Ptr<XgponXgemFrame> >::const_iterator it;
+    for(it = frames.begin (); it != frames.end (); it++)
+    {
+      if((*it)->GetType () != XgponXgemFrame::XGPON_XGEM_FRAME_WITH_DATA) continue;
+      tcontOlt->DiscardFragments4Reassemble (((*it)->GetXgemHeader ()).GetLastFragmentFlag ()==0);
+    }
+  }
+}
+
+
+
+Ptr<XgponChannel>
+XgponOltPhyAdapter::GetChannel4ByteSimulation (void) const
+{
+  Ptr<XgponChannel> channel = DynamicCast<XgponChannel, Channel> (m_device->GetChannel ());
+  if(channel == nullptr || channel->IsAnalyticErrorModelUsed ()) return 0;
+  if(XgponFec::IsEnabled () || channel->IsBitErrorEnabled ()) return channel;
+  else return 0;
+}
+
+
 }//namespace ns3
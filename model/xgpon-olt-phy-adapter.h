@@ -25,6 +25,7 @@
 #include "xgpon-burst-profile.h"
 #include "xgpon-ds-frame.h"
 #include "xgpon-us-burst.h"
+#include "xgpon-channel.h"
 
 
 namespace ns3 {
@@ -47,7 +48,15 @@ public:
 
 
   /////////////////////Inherited from XgponPhy
-  void ProcessXgponUsBurstFromChannel (const Ptr<XgponUsBurst>& burst, const Ptr<XgponBurstProfile>& profile);
+  /**
+   * \brief process one upstream burst received from the channel. When the bytes are simulated (FEC or bit errors enabled),
+   *        the codewords are corrupted by the channel and decoded; with the analytic error model of the channel, the lost codewords
+   *        are sampled from the bit error rate of the ONU. The XGEM frames in lost codewords are replaced by lost ones in the burst,
+   *        so that the XGEM engine discards their SDUs.
+   * \return false if the burst is lost (XGTC header or one DBRu in lost codewords); it should not be processed further 
+   *         (the SDUs being reassembled by its T-CONTs are discarded here).
+   */
+  bool ProcessXgponUsBurstFromChannel (const Ptr<XgponUsBurst>& burst, const Ptr<XgponBurstProfile>& profile);
   void ProcessXgtcDsFrameFromUpperLayer (const Ptr<XgponDsFrame>& frame);
 
 
@@ -66,6 +75,13 @@ public:
 
 
 private:
+  //the channel if the bytes of frames have to be simulated (FEC or bit errors enabled); otherwise, 0.
+  Ptr<XgponChannel> GetChannel4ByteSimulation (void) const;
+
+  //the whole burst is lost: the SDUs being reassembled by its T-CONTs are discarded.
+  void DiscardSdus4LostBurst (XgponXgtcUsBurst& xgtcBurst);
+
+
   //PON ID and Frame Counter used in downstream frame header
   uint64_t  m_sfc;                //51bits
   uint64_t  m_ponid;              //51bits
@@ -62,8 +62,8 @@ XgponOltXgemEngine::~XgponOltXgemEngine ()
 
 
 
-void
-XgponOltXgemEngine::GenerateFramesToTransmit(std::vector<Ptr<XgponXgemFrame> >& xgemFrames, std::vector<Ptr<XgponXgemFrame> >& broadcastXgemFrames, std::vector<uint8_t>& bitmap4Onus, uint32_t payloadLength)
+uint32_t
+XgponOltXgemEngine::GenerateFramesToTransmit(std::vector<Ptr<XgponXgemFrame> >& xgemFrames, std::vector<Ptr<XgponXgemFrame> >& broadcastXgemFrames, XgponOnuIdSet& servedOnus, uint32_t payloadLength)
 {
   NS_LOG_FUNCTION(this);
 
@@ -72,19 +72,18 @@ XgponOltXgemEngine::GenerateFramesToTransmit(std::vector<Ptr<XgponXgemFrame> >&
   
   scheduler->Prepare2ProduceDsFrame ( );
 
+  //encryption: the superframe counter to be assigned to this frame is the nonce; 
+  //the keystream blocks of the unicast XGEM frames are laid one after another.
+  uint64_t sfc = (m_device->GetPhyAdapter ( ))->GetSfc ( );
+  uint64_t counter = 0;
+
   uint32_t currentPayloadSize = 0;
   while(currentPayloadSize < payloadLength)
   {
     uint32_t availableSize = payloadLength - currentPayloadSize;
-    if(availableSize==4)  //create a short idle xgem frame
-    {
-      xgemFrames.push_back(XgponXgemRoutines::CreateShortIdleXgemFrame ( ));
-      return;
-    }
-    else if(availableSize<=16)
+    if(availableSize<=16)  //too small for data: the rest is filled with idle xgem frames
     {
-      xgemFrames.push_back(XgponXgemRoutines::CreateIdleXgemFrame (availableSize));
-      return;
+      return availableSize;
     }
     else //SDUs (if exist) will be encapsulated.
     {
@@ -93,25 +92,7 @@ XgponOltXgemEngine::GenerateFramesToTransmit(std::vector<Ptr<XgponXgemFrame> >&
 
       if(conn==nullptr)  //OLT has no data send. Fill with idle XGEM frames
       {
-        while(availableSize>0)
-        {
-          if(availableSize > XgponXgemRoutines::XGPON_XGEM_FRAME_MAXLEN) 
-          {
-            xgemFrames.push_back(XgponXgemRoutines::CreateIdleXgemFrame (XgponXgemRoutines::XGPON_XGEM_FRAME_MAXLEN));
-            availableSize = availableSize - XgponXgemRoutines::XGPON_XGEM_FRAME_MAXLEN;
-          } 
-          else if(availableSize==4)
-          {
-            xgemFrames.push_back(XgponXgemRoutines::CreateShortIdleXgemFrame ( ));
-            return;
-          }
-          else
-          {
-            xgemFrames.push_back(XgponXgemRoutines::CreateIdleXgemFrame (availableSize));
-            return;
-          }
-        }
-        return;
+        return availableSize;
       }
       else //OLT has data to send. Generate XGEM frames with upper layer data
       {
@@ -133,8 +114,14 @@ XgponOltXgemEngine::GenerateFramesToTransmit(std::vector<Ptr<XgponXgemFrame> >&
           else
           {
             const Ptr<XgponLinkInfo>& linkInfo = ploamEngine->GetLinkInfo(conn->GetOnuId());
-            //TODO: THIS IS WHERE THE DIFFERENCE COULD BE
-            frame = XgponXgemRoutines::GenerateXgemFrame (m_device, conn, amountToServe, linkInfo->GetCurrentUsKey(), linkInfo->GetCurrentUsKeyIndex(), doSegmentation);
+            const Ptr<XgponKey>& key = linkInfo->GetCurrentDsKey();
+            frame = XgponXgemRoutines::GenerateXgemFrame (m_device, conn, amountToServe, key, linkInfo->GetCurrentDsKeyIndex(), doSegmentation);
+            if(frame!=nullptr)
+            {
+              frame->SetKeystreamOffset (counter);
+              if(XgponXgemRoutines::IsPayloadEncrypted (frame->GetXgemHeader()))
+                frame->SetData (XgponXgemRoutines::CryptXgemPayload (frame->GetData(), key, sfc, counter));
+            }
           }
 
           if(frame!=nullptr)
@@ -142,8 +129,9 @@ XgponOltXgemEngine::GenerateFramesToTransmit(std::vector<Ptr<XgponXgemFrame> >&
             if(conn->IsBroadcast()) broadcastXgemFrames.push_back(frame);
             else 
             {
-              bitmap4Onus[conn->GetOnuId()] = 1;
+              servedOnus.Add (conn->GetOnuId());
               xgemFrames.push_back(frame);
+              counter += XgponAesCtr::GetNumberOfBlocks ((frame->GetXgemHeader()).GetPli());
             }
            
 
@@ -159,21 +147,22 @@ XgponOltXgemEngine::GenerateFramesToTransmit(std::vector<Ptr<XgponXgemFrame> >&
     }
   }  //end of while 
 
-  return;
+  return 0;
 }
 
 
 
 void 
-XgponOltXgemEngine::ProcessXgemFramesFromLowerLayer (std::vector<Ptr<XgponXgemFrame> >& frames, uint16_t onuId, uint16_t allocId)
+XgponOltXgemEngine::ProcessXgemFramesFromLowerLayer (std::vector<Ptr<XgponXgemFrame> >& frames, uint16_t onuId, uint16_t allocId, uint64_t sfc)
 {
   NS_LOG_FUNCTION(this);
 
   //Get the engines necessary for processing these Xgem frames
   const Ptr<XgponOltConnManager>& connManager = m_device->GetConnManager ( ); 
 
-  //const Ptr<XgponLinkInfo>& linkInfo = (m_device->GetPloamEngine ( ))->GetLinkInfo(onuId);
   //used to get key for decryption
+  const Ptr<XgponLinkInfo>& linkInfo = (m_device->GetPloamEngine ( ))->GetLinkInfo(onuId);
+  uint64_t counterBase = ((uint64_t) allocId) << 32;   //the allocations of one burst use different counters.
 
   const Ptr<XgponTcontOlt>& tcontOlt = connManager->GetTcontById(allocId);
   NS_ASSERT_MSG((tcontOlt!=nullptr), "Cannot find the corresponding T-CONT at OLT-side!!!");
@@ -188,25 +177,37 @@ XgponOltXgemEngine::ProcessXgemFramesFromLowerLayer (std::vector<Ptr<XgponXgemFr
   for(;it!=end; it++)
   {  
     XgponXgemFrame::XgponXgemFrameType type = (*it)->GetType();
-    if(type ==  XgponXgemFrame::XGPON_XGEM_FRAME_WITH_DATA) //For idle XGEM frame, do nothing
+    if(type ==  XgponXgemFrame::XGPON_XGEM_FRAME_WITH_DATA || type == XgponXgemFrame::XGPON_XGEM_FRAME_LOST) //For idle XGEM frame, do nothing
     {
       XgponXgemHeader& xgemHeader = (*it)->GetXgemHeader();
-      const Ptr<Packet>& payload = (*it)->GetData();
+
+      //an XGEM header failing its HEC (checked only when integrity fields are enabled) is handled like a lost frame.
+      if(type == XgponXgemFrame::XGPON_XGEM_FRAME_WITH_DATA && !xgemHeader.VerifyHec ()) type = XgponXgemFrame::XGPON_XGEM_FRAME_LOST;
+
+      //one segment of this SDU was lost in the channel: the SDU cannot be reassembled and its other segments are dropped.
+      if(type == XgponXgemFrame::XGPON_XGEM_FRAME_LOST || tcontOlt->IsSduDiscarded ())
+      {
+        tcontOlt->DiscardFragments4Reassemble (xgemHeader.GetLastFragmentFlag()==0);
+        continue;
+      }
+
+      Ptr<Packet> payload = (*it)->GetData();
       NS_ASSERT_MSG((payload->GetSize() > 0), "Data length should not be zero!!!");
 
-      //const Ptr<XgponKey>& key = linkInfo->GetUsKeyByIndex (xgemHeader.GetKeyIndex());      
       //carry out decryption if needed.
+      if(XgponXgemRoutines::IsPayloadEncrypted (xgemHeader))
+      {
+        //the keystream offset is carried by each frame: the frames before it in this allocation may have been lost.
+        payload = XgponXgemRoutines::CryptXgemPayload (payload, linkInfo->GetUsKeyByIndex (xgemHeader.GetKeyIndex() - 1), sfc, counterBase + (*it)->GetKeystreamOffset ());
+      }
  
-      Ptr<Packet> sdu = tcontOlt->GetPacket4Reassemble();
-      if(sdu!=nullptr) { sdu->AddAtEnd(payload); }
-      else { sdu = payload; }
-
       if(xgemHeader.GetLastFragmentFlag()==0) //save back for further reassemble
       {
-        tcontOlt->SetPacket4Reassemble (sdu);
+        tcontOlt->AddFragment4Reassemble (payload);
       }
       else  //send to upper layer
       {
+        Ptr<Packet> sdu = XgponXgemRoutines::ReassembleSdu (tcontOlt->GetFragments4Reassemble(), payload);
         uint16_t portId = xgemHeader.GetXgemPortId ();
         if(portId == onuId) { m_device->GetOmciEngine()->ReceiveOmciPacket(sdu); } //send to OMCI
         else 
@@ -26,6 +26,7 @@
 
 #include "xgpon-olt-engine.h"
 #include "xgpon-xgem-frame.h"
+#include "xgpon-onu-id-set.h"
 
 
 
@@ -53,19 +54,21 @@ public:
    * \brief receive a list of XGEM Frames from lower layer (the peer). 
    * \param onuId the ID of the ONU who sends these frames to OLT
    * \param allocId the Alloc-ID that these frames belong to.
+   * \param sfc the superframe counter of the downstream frame carrying the BWmap of this burst (the nonce used for decryption)
    */
-  void ProcessXgemFramesFromLowerLayer(std::vector<Ptr<XgponXgemFrame> >& xgemFrames, uint16_t onuId, uint16_t allocId);
+  void ProcessXgemFramesFromLowerLayer(std::vector<Ptr<XgponXgemFrame> >& xgemFrames, uint16_t onuId, uint16_t allocId, uint64_t sfc);
 
 
   /**
    * \brief generate a list of XGEM Frames to be transmitted in downstream (payload of XgponXgtcDsFrame).
    * \param xgemFrames the list that the generated unicast xgem frames will be put into
    * \param broadcastXgemFrames the list that the generated broadcast xgem frames will be put into
-   * \param bitmap the bitmap used to specifies the served ONUs
+   * \param servedOnus the set that the ONUs served by the unicast xgem frames will be added into
    * \param payloadLength the total length of these generated frames (unit: byte)
+   * \return the size of the idle span (unit: byte) that fills the rest of the payload. No idle xgem frame is generated.
    */
-  void GenerateFramesToTransmit(std::vector<Ptr<XgponXgemFrame> >& xgemFrames, std::vector<Ptr<XgponXgemFrame> >& broadcastXgemFrames, 
-                                std::vector<uint8_t>& bitmap, uint32_t payloadLength);
+  uint32_t GenerateFramesToTransmit(std::vector<Ptr<XgponXgemFrame> >& xgemFrames, std::vector<Ptr<XgponXgemFrame> >& broadcastXgemFrames, 
+                                XgponOnuIdSet& servedOnus, uint32_t payloadLength);
 
 
 
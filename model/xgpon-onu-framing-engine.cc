@@ -80,6 +80,7 @@ XgponOnuFramingEngine::ParseXgtcDownstreamFrame (XgponXgtcDsFrame& frame)
   //processing BWmap
   const Ptr<XgponOnuDbaEngine>& dbaEngine = m_device->GetDbaEngine ( ); 
 
+  (xgtcDsHeader.GetBwmap( ))->SetSfc ((m_device->GetPhyAdapter ( ))->GetSfc ( ));  //meta-data: the superframe counter of this frame
   dbaEngine->ProcessBwMap(xgtcDsHeader.GetBwmap( ));
 
 	//processing Ploam messages
@@ -98,8 +99,7 @@ XgponOnuFramingEngine::ParseXgtcDownstreamFrame (XgponXgtcDsFrame& frame)
   }
 
   //unicast traffics
-  std::vector<uint8_t>& bitmap = frame.GetBitmap ();
-  if(bitmap[m_device->GetOnuId()] != 0)
+  if(frame.IsOnuServed (m_device->GetOnuId()))
   {
     xgemEngine->ProcessXgemFramesFromLowerLayer(frame.GetUnicastXgemFrames());
   }
@@ -148,7 +148,7 @@ XgponOnuFramingEngine::ProduceXgtcUsBurst (XgponXgtcUsBurst& usBurst, const Ptr<
 	  	}
     
       //Generate XGEM Frames to be transmitted and put them into UsAllocation
-		  xgemEngine->GenerateFramesToTransmit(allocation->GetXgemFrames(), allocSizeInBytes, allocId); //ja:update:xgspon replaced allocSize with allocSizeInBytes
+		  allocation->AddIdleSpan (xgemEngine->GenerateFramesToTransmit(allocation->GetXgemFrames(), allocSizeInBytes, allocId, map->GetSfc ( ))); //ja:update:xgspon replaced allocSize with allocSizeInBytes
 		}
 				
 				
@@ -0,0 +1,118 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2012 University College Cork (UCC), Ireland
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jerome Arokkiam <jerome.arokkia@bt.com>
+ */
+
+#include <cstring>
+
+#include "xgpon-onu-id-set.h"
+
+
+
+namespace ns3 {
+
+XgponOnuIdSet::XgponOnuIdSet () : m_size(0), m_useBitset(false)
+{
+  //m_ids and m_bits are not initialized; they are only read after being written.
+}
+
+
+void
+XgponOnuIdSet::Add (uint16_t onuId)
+{
+  NS_ASSERT_MSG((onuId < XGPON_ONU_ID_SET_MAX_ID), "ONU-ID is too large (unlawful)!!!");
+
+  if(m_useBitset)
+  {
+    uint64_t mask = ((uint64_t) 1) << (onuId & 63);
+    if((m_bits[onuId >> 6] & mask) == 0)
+    {
+      m_bits[onuId >> 6] |= mask;
+      m_size++;
+    }
+    return;
+  }
+
+  //find the position in the sorted array.
+  uint16_t pos = 0;
+  while(pos < m_size && m_ids[pos] < onuId) pos++;
+  if(pos < m_size && m_ids[pos] == onuId) return;
+
+  if(m_size == XGPON_ONU_ID_SET_LIST_SIZE)
+  {
+    ConvertToBitset ();
+    Add (onuId);
+    return;
+  }
+
+  memmove (&m_ids[pos + 1], &m_ids[pos], (m_size - pos) * sizeof (uint16_t));
+  m_ids[pos] = onuId;
+  m_size++;
+}
+
+
+void
+XgponOnuIdSet::AddAll (const XgponOnuIdSet& other)
+{
+  if(other.m_useBitset)
+  {
+    if(!m_useBitset) ConvertToBitset ();
+
+    m_size = 0;
+    for(uint16_t i = 0; i < XGPON_ONU_ID_SET_MAX_ID / 64; i++)
+    {
+      m_bits[i] |= other.m_bits[i];
+      m_size += __builtin_popcountll (m_bits[i]);
+    }
+  }
+  else
+  {
+    for(uint16_t i = 0; i < other.m_size; i++) Add (other.m_ids[i]);
+  }
+}
+
+
+void
+XgponOnuIdSet::GetOnuIds (std::vector<uint16_t>& ids) const
+{
+  if(!m_useBitset)
+  {
+    ids.insert (ids.end (), m_ids, m_ids + m_size);
+    return;
+  }
+
+  for(uint16_t id = 0; id < XGPON_ONU_ID_SET_MAX_ID; id++)
+  {
+    if((m_bits[id >> 6] >> (id & 63)) & 1) ids.push_back (id);
+  }
+}
+
+
+void
+XgponOnuIdSet::ConvertToBitset (void)
+{
+  memset (m_bits, 0, sizeof (m_bits));
+  for(uint16_t i = 0; i < m_size; i++)
+  {
+    m_bits[m_ids[i] >> 6] |= ((uint64_t) 1) << (m_ids[i] & 63);
+  }
+  m_useBitset = true;
+}
+
+
+} // namespace ns3
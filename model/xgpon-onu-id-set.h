@@ -0,0 +1,137 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2012 University College Cork (UCC), Ireland
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jerome Arokkiam <jerome.arokkia@bt.com>
+ */
+
+#ifndef XGPON_ONU_ID_SET_H
+#define XGPON_ONU_ID_SET_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "ns3/assert.h"
+
+
+
+namespace ns3 {
+
+/**
+ * \ingroup xgpon
+ * \brief A compact set of ONU-IDs (e.g., the ONUs served in one downstream frame).
+ *
+ * Only a few ONUs are served in most downstream frames. Thus, the ONU-IDs are kept in a small sorted array
+ * and the set switches to a bitset (one bit per ONU-ID) once this array is full.
+ * Both are stored inside the object, so that no memory is allocated from the heap. When the set is a member
+ * of one pooled frame, its storage is reused together with the frame.
+ */
+class XgponOnuIdSet
+{
+public:
+  const static uint16_t XGPON_ONU_ID_SET_LIST_SIZE = 32;    //the number of ONU-IDs kept in the sorted array before switching to the bitset
+  const static uint16_t XGPON_ONU_ID_SET_MAX_ID = 1024;     //ONU-ID is 10 bits long
+
+  /**
+   * \brief Constructor
+   */
+  XgponOnuIdSet ();
+
+
+  /**
+   * \brief add one ONU-ID into this set. Nothing changes if it is already in the set.
+   */
+  void Add (uint16_t onuId);
+
+  /**
+   * \brief add all ONU-IDs of another set into this set.
+   */
+  void AddAll (const XgponOnuIdSet& other);
+
+  /**
+   * \return whether the ONU-ID is in this set.
+   */
+  bool Contains (uint16_t onuId) const;
+
+  /**
+   * \brief remove all ONU-IDs.
+   */
+  void Clear (void);
+
+  bool IsEmpty (void) const;
+  uint16_t GetSize (void) const;
+
+  /**
+   * \brief get all ONU-IDs of this set (ascending order). It is not expected to be used in the fast path.
+   * \param ids the vector that the ONU-IDs are appended to.
+   */
+  void GetOnuIds (std::vector<uint16_t>& ids) const;
+
+
+private:
+  //move the ONU-IDs from the sorted array to the bitset
+  void ConvertToBitset (void);
+
+
+  uint16_t m_size;                                            //the number of ONU-IDs in this set
+  bool m_useBitset;                                           //false: m_ids is used; true: m_bits is used.
+
+  uint16_t m_ids[XGPON_ONU_ID_SET_LIST_SIZE];                 //the sorted ONU-IDs (only the first m_size entries are valid)
+  uint64_t m_bits[XGPON_ONU_ID_SET_MAX_ID / 64];              //one bit per ONU-ID (only valid when m_useBitset is true)
+};
+
+
+
+
+////////////////////////////////////////////////////INLINE Functions
+inline bool
+XgponOnuIdSet::Contains (uint16_t onuId) const
+{
+  if(m_useBitset)
+  {
+    return (onuId < XGPON_ONU_ID_SET_MAX_ID) && ((m_bits[onuId >> 6] >> (onuId & 63)) & 1);
+  }
+
+  for(uint16_t i = 0; i < m_size && m_ids[i] <= onuId; i++)
+  {
+    if(m_ids[i] == onuId) return true;
+  }
+  return false;
+}
+
+inline void
+XgponOnuIdSet::Clear (void)
+{
+  m_size = 0;
+  m_useBitset = false;
+}
+
+inline bool
+XgponOnuIdSet::IsEmpty (void) const
+{
+  return (m_size == 0);
+}
+
+inline uint16_t
+XgponOnuIdSet::GetSize (void) const
+{
+  return m_size;
+}
+
+
+} // namespace ns3
+
+#endif /* XGPON_ONU_ID_SET_H */
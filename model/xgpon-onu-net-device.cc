@@ -76,12 +76,12 @@ XgponOnuNetDevice::ReceivePonFrameFromChannel (const Ptr<PonFrame>& frame)
 
   const Ptr<XgponDsFrame>& dsFrame = DynamicCast<XgponDsFrame, PonFrame>(frame);
   
-  //PMD layer and PHY Adaptation sub-layer;
-  m_onuPhyAdapter->ProcessXgponDsFrameFromChannel (dsFrame);
+  //PMD layer and PHY Adaptation sub-layer; the frame is replaced (or lost) when bit errors are simulated.
+  Ptr<XgponDsFrame> receivedFrame = m_onuPhyAdapter->ProcessXgponDsFrameFromChannel (dsFrame);
 
 
   //Framing sublayer; It will call XGEM engine to process the XGEM frames.
-  m_onuFramingEngine->ParseXgtcDownstreamFrame(dsFrame->GetXgtcDsFrame ());
+  if(receivedFrame != nullptr) m_onuFramingEngine->ParseXgtcDownstreamFrame(receivedFrame->GetXgtcDsFrame ());
 
 
   //tracesource callback for network device statistics
@@ -94,6 +94,14 @@ XgponOnuNetDevice::ReceivePonFrameFromChannel (const Ptr<PonFrame>& frame)
 }
 
 
+bool
+XgponOnuNetDevice::IsDownstreamFrameRequired (const Ptr<PonFrame>& frame) const
+{
+  const Ptr<XgponDsFrame>& dsFrame = DynamicCast<XgponDsFrame, PonFrame>(frame);
+  return dsFrame->GetXgtcDsFrame ().IsDeliveryRequired (m_onuId);
+}
+
+
 
 
 
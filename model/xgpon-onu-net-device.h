@@ -66,6 +66,12 @@ public:
    */
   virtual void ReceivePonFrameFromChannel (const Ptr<PonFrame>& frame);      
 
+  /**
+   * \brief whether the downstream frame carries anything (unicast data, grant, PLOAM, broadcast) for this ONU. Inherited from PonNetDevice
+   *        The skipped frames need no catch-up: SFC is taken from the PSBd of the next received frame and the statistics only change upon reception.
+   */
+  virtual bool IsDownstreamFrameRequired (const Ptr<PonFrame>& frame) const;
+
 
 
 
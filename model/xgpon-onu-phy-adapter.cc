@@ -22,9 +22,13 @@
 
 #include "xgpon-onu-phy-adapter.h"
 #include "xgpon-onu-net-device.h"
+#include "xgpon-onu-ploam-engine.h"
+#include "xgpon-onu-conn-manager.h"
+#include "xgpon-xgem-routines.h"
 
 //#include "xgpon-psbu.h"
 //#include "xgpon-psbd.h"
+#include "xgpon-fec.h"
 
 
 NS_LOG_COMPONENT_DEFINE ("XgponOnuPhyAdapter");
@@ -60,19 +64,106 @@ XgponOnuPhyAdapter::~XgponOnuPhyAdapter ()
 
 
 
-void
+Ptr<XgponDsFrame>
 XgponOnuPhyAdapter::ProcessXgponDsFrameFromChannel (const Ptr<XgponDsFrame>& frame)
 {
   NS_LOG_FUNCTION(this);
 
   NS_ASSERT_MSG((frame!=nullptr), "The downstream to be processed is zero!!!");
-  //FEC and Line decode are omitted here.
-  //We also assume that data is received successfully (w/o error). May change in the future to simulate corruption
+  //Line decode is omitted here. PSBd is not FEC-protected and is assumed to be received without error.
 
   XgponPsbd& psbd = frame->GetPsbd ();
+  XgponXgtcDsFrame& xgtcFrame = frame->GetXgtcDsFrame ();
+
+  //the HEC fields are only checked when integrity fields are enabled. The frame cannot be delineated if PSBd or the header is damaged.
+  if(!psbd.VerifySfcHec () || !psbd.VerifyPonIdHec () || !xgtcFrame.GetHeader ().VerifyHec ())
+  {
+    NS_LOG_INFO("Downstream frame dropped for HEC mismatch in PSBd or XGTC header.");
+    DiscardSdus4LostFrame (xgtcFrame.GetBroadcastXgemFrames ());
+    DiscardSdus4LostFrame (xgtcFrame.GetUnicastXgemFrames ());
+    return 0;
+  }
   m_sfc = psbd.GetSfc();
 
-  return;
+  Ptr<XgponChannel> channel = DynamicCast<XgponChannel, Channel> (m_device->GetChannel ());
+  if(channel == nullptr) return frame;
+
+  bool analytic = channel->IsAnalyticErrorModelUsed ();
+  if(!analytic && !XgponFec::IsEnabled () && !channel->IsBitErrorEnabled ()) return frame;
+
+  uint32_t len = xgtcFrame.GetSerializedSize ();
+  std::vector<uint32_t> lostBlocks;
+  const XgponFec* code;
+
+  if(analytic)
+  {
+    //the bytes are not simulated: the lost codewords are sampled from the bit error rate of this ONU (FEC is always used in downstream).
+    double ber = (m_device->GetPloamEngine ()->GetLinkInfo ())->GetBitErrorRate ();
+    if(ber < 0) ber = channel->GetBitErrorRate ();
+    if(ber <= 0) return frame;
+
+    code = &XgponFec::GetDsCode (m_device->GetXgponPhy (), true);
+    channel->SampleLostBlocks (code->GetUncorrectableProbability (ber), code->GetNumberOfBlocks (len), lostBlocks);
+    if(lostBlocks.empty ()) return frame;
+  }
+  else
+  {
+    code = &XgponFec::GetDsCode (m_device->GetXgponPhy (), XgponFec::IsEnabled ());
+
+    std::vector<uint8_t>& sent = frame->GetCodewords ();
+    if(sent.empty ())   //the codewords are not carried between ranks in distributed simulations.
+    {
+      Buffer buffer;
+      buffer.AddAtStart (len);
+      xgtcFrame.Serialize (buffer.Begin ());
+      code->EncodeBlocks (buffer.PeekData (), len, sent);
+    }
+
+    std::vector<uint8_t> received (sent);
+    uint32_t flipped = channel->AddBitErrors (&received[0], received.size ());
+    if(flipped == 0 && code->GetParitySize () == 0) return frame;
+
+    code->DecodeBlocks (&received[0], &sent[0], len, lostBlocks);
+    if(lostBlocks.empty ()) return frame;
+    NS_LOG_INFO("Downstream frame with " << flipped << " flipped bits and " << lostBlocks.size () << " damaged blocks.");
+  }
+
+
+  //The offsets follow XgponXgtcDsFrame::Serialize (header, broadcast xgem frames, unicast xgem frames).
+  uint32_t offset = xgtcFrame.GetHeader ().GetSerializedSize ();
+  if(code->IsRangeLost (lostBlocks, 0, offset)) 
+  {
+    DiscardSdus4LostFrame (xgtcFrame.GetBroadcastXgemFrames ());
+    DiscardSdus4LostFrame (xgtcFrame.GetUnicastXgemFrames ());
+    return 0;
+  }
+
+  Ptr<XgponDsFrame> copy = Create<XgponDsFrame> ();
+  copy->GetPsbd () = psbd;
+  XgponXgtcDsFrame& copyXgtcFrame = copy->GetXgtcDsFrame ();
+  copyXgtcFrame.GetHeader () = xgtcFrame.GetHeader ();
+  copyXgtcFrame.GetServedOnus ().AddAll (xgtcFrame.GetServedOnus ());
+
+  std::vector<Ptr<XgponXgemFrame> >::const_iterator it;
+  const std::vector<Ptr<XgponXgemFrame> >& broadcastFrames = xgtcFrame.GetBroadcastXgemFrames ();
+  for(it = broadcastFrames.begin (); it != broadcastFrames.end (); it++)
+  {
+    uint32_t frameSize = (*it)->GetSerializedSize ();
+    if(!code->IsRangeLost (lostBlocks, offset, offset + frameSize)) copyXgtcFrame.AddBroadcastXgemFrame (*it);
+    else if((*it)->GetType () == XgponXgemFrame::XGPON_XGEM_FRAME_WITH_DATA) copyXgtcFrame.AddBroadcastXgemFrame (XgponXgemRoutines::CreateLostXgemFrame (*it));
+    offset += frameSize;
+  }
+
+  const std::vector<Ptr<XgponXgemFrame> >& unicastFrames = xgtcFrame.GetUnicastXgemFrames ();
+  for(it = unicastFrames.begin (); it != unicastFrames.end (); it++)
+  {
+    uint32_t frameSize = (*it)->GetSerializedSize ();
+    if(!code->IsRangeLost (lostBlocks, offset, offset + frameSize)) copyXgtcFrame.AddUnicastXgemFrame (*it);
+    else if((*it)->GetType () == XgponXgemFrame::XGPON_XGEM_FRAME_WITH_DATA) copyXgtcFrame.AddUnicastXgemFrame (XgponXgemRoutines::CreateLostXgemFrame (*it));
+    offset += frameSize;
+  }
+
+  return copy;
 }
 
 
@@ -92,11 +183,49 @@ XgponOnuPhyAdapter::ProcessXgtcBurstFromUpperLayer (const Ptr<XgponUsBurst>& bur
 
 
 
-  //the potential FEC and Line Coding are omitted here.
+  //Line coding is omitted. The codewords are only calculated when the bytes are simulated (FEC or bit errors enabled).
+  if(GetChannel4ByteSimulation () != nullptr)
+  {
+    XgponXgtcUsBurst& xgtcBurst = burst->GetXgtcUsBurst ();
+    uint32_t len = xgtcBurst.GetSerializedSize ();
+    Buffer buffer;
+    buffer.AddAtStart (len);
+    xgtcBurst.Serialize (buffer.Begin ());
+    XgponFec::GetUsCode (m_device->GetXgponPhy (), XgponFec::IsEnabled () && profile->GetFec ()).EncodeBlocks (buffer.PeekData (), len, burst->GetCodewords ());
+  }
 
   return;
 }
 
 
 
+
+void
+XgponOnuPhyAdapter::DiscardSdus4LostFrame (const std::vector<Ptr<XgponXgemFrame> >& frames)
+{
+  const Ptr<XgponOnuConnManager>& connManager = m_device->GetConnManager ( );
+
+  std::vector<Ptr<XgponXgemFrame> >::const_iterator it;
+  for(it = frames.begin (); it != frames.end (); it++)
+  {
+    if((*it)->GetType () != XgponXgemFrame::XGPON_XGEM_FRAME_WITH_DATA) continue;
+
+    XgponXgemHeader& xgemHeader = (*it)->GetXgemHeader ();
+    const Ptr<XgponConnectionReceiver>& conn = connManager->FindDsConnByXgemPort (xgemHeader.GetXgemPortId ());
+    if(conn != nullptr) conn->DiscardFragments4Reassemble (xgemHeader.GetLastFragmentFlag ()==0);
+  }
+}
+
+
+
+Ptr<XgponChannel>
+XgponOnuPhyAdapter::GetChannel4ByteSimulation (void) const
+{
+  Ptr<XgponChannel> channel = DynamicCast<XgponChannel, Channel> (m_device->GetChannel ());
+  if(channel == nullptr || channel->IsAnalyticErrorModelUsed ()) return 0;
+  if(XgponFec::IsEnabled () || channel->IsBitErrorEnabled ()) return channel;
+  else return 0;
+}
+
+
 }//namespace ns3
@@ -27,6 +27,7 @@
 #include "xgpon-ds-frame.h"
 #include "xgpon-us-burst.h"
 #include "xgpon-burst-profile.h"
+#include "xgpon-channel.h"
 
 
 
@@ -49,7 +50,15 @@ public:
 
 
   /////////////////////Main functions
-  void ProcessXgponDsFrameFromChannel (const Ptr<XgponDsFrame>& frame); 
+  /**
+   * \brief process one downstream frame received from the channel. When the bytes are simulated (FEC or bit errors enabled),
+   *        the codewords are corrupted by the channel and decoded; with the analytic error model of the channel, the lost codewords
+   *        are sampled from the bit error rate of this ONU.
+   * \return the frame to be processed by the upper layers: the same frame if nothing is damaged; 
+   *         a copy in which the XGEM frames in lost codewords are replaced by lost ones (the frame is shared by all ONUs),
+   *         so that the XGEM engine discards their SDUs; 0 if the XGTC header is lost.
+   */
+  Ptr<XgponDsFrame> ProcessXgponDsFrameFromChannel (const Ptr<XgponDsFrame>& frame); 
   void ProcessXgtcBurstFromUpperLayer (const Ptr<XgponUsBurst>& burst, const Ptr<XgponBurstProfile>& profile);
 
 
@@ -68,6 +77,13 @@ public:
 
 private:
 
+  //the channel if the bytes of frames have to be simulated (FEC or bit errors enabled); otherwise, 0.
+  Ptr<XgponChannel> GetChannel4ByteSimulation (void) const;
+
+  //the whole downstream frame is lost: the SDUs being reassembled by the connections of this ONU are discarded.
+  void DiscardSdus4LostFrame (const std::vector<Ptr<XgponXgemFrame> >& frames);
+
+
   //PON ID and Frame Counter used in downstream frame header
   uint64_t  m_sfc;                //51bits
   uint64_t  m_ponid;              //51bits ja:update:xgspon PON-ID is not exactly same in XGPON and XGSPON. But the 51-bit field remains the same operationally, if the additional fields (other than the 32-bit PON-ID filed) can be ignored, which is the case for data transmission in a standalone XGSPON or XGPON
@@ -61,8 +61,8 @@ XgponOnuXgemEngine::~XgponOnuXgemEngine ()
 
 
 
-void
-XgponOnuXgemEngine::GenerateFramesToTransmit(std::vector<Ptr<XgponXgemFrame> >& xgemFrames, uint32_t payloadLength, uint16_t allocId)
+uint32_t
+XgponOnuXgemEngine::GenerateFramesToTransmit(std::vector<Ptr<XgponXgemFrame> >& xgemFrames, uint32_t payloadLength, uint16_t allocId, uint64_t sfc)
 {
   NS_LOG_FUNCTION(this);
 
@@ -77,6 +77,9 @@ XgponOnuXgemEngine::GenerateFramesToTransmit(std::vector<Ptr<XgponXgemFrame> >&
   
   const Ptr<XgponOnuUsScheduler>& scheduler = tcontOnu->GetOnuUsScheduler();
   const Ptr<XgponLinkInfo>& linkInfo = (m_device->GetPloamEngine ( ))->GetLinkInfo();
+  const Ptr<XgponKey>& key = linkInfo->GetCurrentUsKey();
+  uint64_t counterBase = ((uint64_t) allocId) << 32;   //the allocations of one burst use different counters.
+  uint64_t counter = 0;                                //the keystream offset of the next XGEM frame in this allocation
 
 
   uint32_t currentPayloadSize, availableSize;
@@ -90,17 +93,9 @@ XgponOnuXgemEngine::GenerateFramesToTransmit(std::vector<Ptr<XgponXgemFrame> >&
      * an idle XGEM frame is created at the transmitter's own discretion based on the avaialble payload secion. Here, it's between 4 and 15 bytes, inclusive.
      * a payload length of 16 or more Bytes results in a full SDU being created for transmission
     */
-    if(availableSize ==4 )  //create a short idle xgem frame (this in only applicable for XGPON; for XGSPON, this condition is met by the end portion of the payload has 4 Bytes left to be transmitted and not when a single block is assigned as minimum with no packets are in the queue.
+    if(availableSize<16) //the rest is filled with idle xgem frames (a short idle one when 4 bytes are left); ja:update:xgspon; for XGSPON (16Byte block size), this is when a status report is sent (4 Bytes) but the remaining block size (12Bytes) needs to be filled; = sign not needed
     {
-      xgemFrames.push_back(XgponXgemRoutines::CreateShortIdleXgemFrame ( ));
-			//std::cout << " creating SHORT idle Xgem Frame upfront with availableSize:  " << availableSize << std::endl;
-      return;
-    }
-    else if(availableSize<16) //create one idle xgem frame; ja:update:xgspon; for XGSPON (16Byte block size), this is when a status report is sent (4 Bytes) but the remaining block size (12Bytes) needs to be filled; = sign not needed
-    {
-      xgemFrames.push_back(XgponXgemRoutines::CreateIdleXgemFrame(availableSize));
-			//std::cout << " creating IDLE Xgem Frame upfront with availableSize: " << availableSize << std::endl;
-      return;
+      return availableSize;
     }
     else //SDUs (if exist) will be encapsulated.
     {
@@ -109,26 +104,7 @@ XgponOnuXgemEngine::GenerateFramesToTransmit(std::vector<Ptr<XgponXgemFrame> >&
       conn = scheduler->SelectConnToServe (&amountToServe);
       if(conn==nullptr)  //this T-CONT has no data send. fill with idle XGEM frames
       {
-				//std::cout << "\t for a NULL connection with amountToServe: " << amountToServe << ", and VERY BIG availableSize: " << availableSize << std::endl;
-        while(availableSize>0)
-        {
-          if(availableSize > XgponXgemRoutines::XGPON_XGEM_FRAME_MAXLEN) 
-          {
-            xgemFrames.push_back(XgponXgemRoutines::CreateIdleXgemFrame (XgponXgemRoutines::XGPON_XGEM_FRAME_MAXLEN));
-            availableSize = availableSize - XgponXgemRoutines::XGPON_XGEM_FRAME_MAXLEN;
-          } 
-          else if(availableSize==4)
-          {
-						xgemFrames.push_back(XgponXgemRoutines::CreateShortIdleXgemFrame ( ));
-            return;
-          }
-          else
-          {
-            xgemFrames.push_back(XgponXgemRoutines::CreateIdleXgemFrame (availableSize));
-            return;
-          }
-        }
-        return;
+        return availableSize;
       }
       else
       {
@@ -146,9 +122,16 @@ XgponOnuXgemEngine::GenerateFramesToTransmit(std::vector<Ptr<XgponXgemFrame> >&
         {
 					//std::cout << "\t for a VALID Upstream Connection with amountToServe: " << amountToServe << ", and segmentation: " << doSegmentation << std::endl; 
           frame = XgponXgemRoutines::GenerateXgemFrame (m_device, conn, amountToServe, 
-                                       linkInfo->GetCurrentUsKey(), linkInfo->GetCurrentUsKeyIndex(), doSegmentation);
+                                       key, linkInfo->GetCurrentUsKeyIndex(), doSegmentation);
           if(frame!=nullptr)
           {
+            frame->SetKeystreamOffset (counter);
+            if(XgponXgemRoutines::IsPayloadEncrypted (frame->GetXgemHeader()))
+            {
+              frame->SetData (XgponXgemRoutines::CryptXgemPayload (frame->GetData(), key, sfc, counterBase + counter));
+            }
+            counter += XgponAesCtr::GetNumberOfBlocks ((frame->GetXgemHeader()).GetPli());
+
             xgemFrames.push_back(frame);
             currentPayloadSize += frame->GetSerializedSize();
 						amountToServe -= frame->GetSerializedSize();
@@ -162,7 +145,7 @@ XgponOnuXgemEngine::GenerateFramesToTransmit(std::vector<Ptr<XgponXgemFrame> >&
     }
   }  //end of while 
 
-  return;
+  return 0;
 }
 
 
@@ -178,8 +161,9 @@ XgponOnuXgemEngine::ProcessXgemFramesFromLowerLayer (std::vector<Ptr<XgponXgemFr
   const uint16_t tcontOnuType = 0;//there's no reason to have tcont types in the downstream since QoS aware DBA is not used in the downstream
   
 
-  //const Ptr<XgponLinkInfo>& linkInfo = (m_device->GetPloamEngine ( ))->GetLinkInfo();
-  //used to find the key for decryption
+  //used to find the key for decryption. The superframe counter of this downstream frame is the nonce.
+  const Ptr<XgponLinkInfo>& linkInfo = (m_device->GetPloamEngine ( ))->GetLinkInfo();
+  uint64_t sfc = (m_device->GetPhyAdapter ( ))->GetSfc ( );
 
 
   std::vector<Ptr<XgponXgemFrame> >::iterator it, end;
@@ -188,7 +172,7 @@ XgponOnuXgemEngine::ProcessXgemFramesFromLowerLayer (std::vector<Ptr<XgponXgemFr
   for(;it!=end; it++)
   {
     XgponXgemFrame::XgponXgemFrameType type = (*it)->GetType();
-    if(type ==  XgponXgemFrame::XGPON_XGEM_FRAME_WITH_DATA) //For idle XGEM frame, do nothing
+    if(type ==  XgponXgemFrame::XGPON_XGEM_FRAME_WITH_DATA || type == XgponXgemFrame::XGPON_XGEM_FRAME_LOST) //For idle XGEM frame, do nothing
     {
       XgponXgemHeader& xgemHeader = (*it)->GetXgemHeader();
       uint16_t portId = xgemHeader.GetXgemPortId ();
@@ -196,22 +180,33 @@ XgponOnuXgemEngine::ProcessXgemFramesFromLowerLayer (std::vector<Ptr<XgponXgemFr
 
       if(conn!=nullptr)  //whether this XGEM frame is for this ONU
       {
-        const Ptr<Packet>& payload = (*it)->GetData();
+        //an XGEM header failing its HEC (checked only when integrity fields are enabled) is handled like a lost frame.
+        if(type == XgponXgemFrame::XGPON_XGEM_FRAME_WITH_DATA && !xgemHeader.VerifyHec ()) type = XgponXgemFrame::XGPON_XGEM_FRAME_LOST;
+
+        //one segment of this SDU was lost in the channel: the SDU cannot be reassembled and its other segments are dropped.
+        if(type == XgponXgemFrame::XGPON_XGEM_FRAME_LOST || conn->IsSduDiscarded ())
+        {
+          conn->DiscardFragments4Reassemble (xgemHeader.GetLastFragmentFlag()==0);
+          continue;
+        }
+
+        Ptr<Packet> payload = (*it)->GetData();
         NS_ASSERT_MSG((payload->GetSize() > 0), "Data length should not be zero!!!");
 
-        //Ptr<XgponKey> key = linkInfo->GetDsKeyByIndex (xgemHeader.GetKeyIndex());
         //carry out decryption if needed.
+        if(XgponXgemRoutines::IsPayloadEncrypted (xgemHeader))
+        {
+          //the keystream offset is carried by each frame: the frames before it may have been lost.
+          payload = XgponXgemRoutines::CryptXgemPayload (payload, linkInfo->GetDsKeyByIndex (xgemHeader.GetKeyIndex() - 1), sfc, (*it)->GetKeystreamOffset ());
+        }
  
-        Ptr<Packet> sdu = conn->GetPacket4Reassemble();
-        if(sdu!=nullptr) { sdu->AddAtEnd(payload); }
-        else { sdu = payload; }
-
         if(xgemHeader.GetLastFragmentFlag()==0) //save back for further reassemble
         {
-          conn->SetPacket4Reassemble (sdu);
+          conn->AddFragment4Reassemble (payload);
         }
         else  //send to upper layer
         {          
+          Ptr<Packet> sdu = XgponXgemRoutines::ReassembleSdu (conn->GetFragments4Reassemble(), payload);
           if(portId == m_device->GetOnuId( )) { m_device->GetOmciEngine()->ReceiveOmciPacket(sdu); } //send to OMCI
           else { m_device->SendSduToUpperLayer (sdu, tcontOnuType, 1024, m_device->GetOnuId()); } //send to upper layers          
         } //end for fragmentation state
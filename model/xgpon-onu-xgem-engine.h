@@ -56,8 +56,10 @@ public:
    * \param xgemFrames the list that the generated xgem frames will be put into
    * \param payloadLength the total length of these generated frames (unit: byte)
    * \param allocId the T-CONT that these frames belong to. 
+   * \param sfc the superframe counter of the downstream frame carrying the BWmap (the nonce used for encryption)
+   * \return the size of the idle span (unit: byte) that fills the rest of the payload. No idle xgem frame is generated.
    */
-  void GenerateFramesToTransmit(std::vector<Ptr<XgponXgemFrame> >& xgemFrames, uint32_t payloadLength, uint16_t allocId);
+  uint32_t GenerateFramesToTransmit(std::vector<Ptr<XgponXgemFrame> >& xgemFrames, uint32_t payloadLength, uint16_t allocId, uint64_t sfc);
 
 
   //////////////////////////////////////////////Functions required by NS-3
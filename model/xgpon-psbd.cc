@@ -79,7 +79,7 @@ void
 XgponPsbd::Serialize (Buffer::Iterator start) const
 {
   uint64_t sfcStructure=(m_sfc<<13)|m_sfcHec;
-  uint64_t ponIdStructure=(m_ponId<<13)|m_sfcHec;
+  uint64_t ponIdStructure=(m_ponId<<13)|m_ponIdHec;
   
   start.WriteHtonU64 (m_psync);
   start.WriteHtonU64 (sfcStructure);
@@ -23,6 +23,8 @@
 
 #include "ns3/buffer.h"
 
+#include "xgpon-integrity.h"
+
 
 
 namespace ns3 {
@@ -129,23 +131,27 @@ inline void
 XgponPsbd::CalculateSfcHec (uint64_t sfc)
 {
   m_sfcHec=0;
+  if(XgponIntegrity::IsEnabled ()) m_sfcHec = XgponIntegrity::CalculateHec (sfc & 0x0007ffffffffffff, 51);
   return;
 }
 inline bool 
 XgponPsbd::VerifySfcHec ( ) const
 {
-  return true;
+  if(!XgponIntegrity::IsEnabled ()) return true;
+  return m_sfcHec == XgponIntegrity::CalculateHec (m_sfc & 0x0007ffffffffffff, 51);
 }
 
 inline void 
 XgponPsbd::CalculatePonIdHec (uint64_t ponId)
 {
+  if(XgponIntegrity::IsEnabled ()) m_ponIdHec = XgponIntegrity::CalculateHec (ponId & 0x0007ffffffffffff, 51);
   return;
 }
 inline bool 
 XgponPsbd::VerifyPonIdHec ( ) const
 {
-  return true;
+  if(!XgponIntegrity::IsEnabled ()) return true;
+  return m_ponIdHec == XgponIntegrity::CalculateHec (m_ponId & 0x0007ffffffffffff, 51);   //the same field as CalculatePonIdHec
 }
 
 
@@ -0,0 +1,347 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2012 University College Cork (UCC), Ireland
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jerome Arokkiam <jerome.arokkia@bt.com>
+ */
+
+#include <map>
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#ifdef NS3_MPI
+#include "ns3/mpi-interface.h"
+#include "ns3/mpi-receiver.h"
+#include "ns3/distributed-simulator-impl.h"
+#endif
+
+#include "xgpon-channel.h"
+#include "xgpon-remote-channel-proxy.h"
+
+
+NS_LOG_COMPONENT_DEFINE ("XgponRemoteChannelProxy");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (XgponRemoteChannelProxy);
+
+TypeId
+XgponRemoteChannelProxy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::XgponRemoteChannelProxy")
+    .SetParent<Object> ()
+    .AddConstructor<XgponRemoteChannelProxy> ()
+  ;
+  return tid;
+}
+TypeId
+XgponRemoteChannelProxy::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+
+XgponRemoteChannelProxy::XgponRemoteChannelProxy () : m_channel(0), m_localDelay(0)
+{
+}
+XgponRemoteChannelProxy::~XgponRemoteChannelProxy ()
+{
+}
+
+void
+XgponRemoteChannelProxy::DoDispose (void)
+{
+  m_channel = 0;
+  m_partitions.clear ();
+  Object::DoDispose ();
+}
+
+
+
+
+void
+XgponRemoteChannelProxy::Setup (const Ptr<XgponChannel>& channel)
+{
+  NS_LOG_FUNCTION (this);
+
+#ifdef NS3_MPI
+  NS_ASSERT_MSG(MpiInterface::IsEnabled (), "MPI has not been enabled!!!");
+
+  m_channel = channel;
+  uint32_t localId = MpiInterface::GetSystemId ();
+
+  const Ptr<PonNetDevice>& olt = channel->GetOlt ();
+  uint32_t oltId = olt->GetNode ()->GetSystemId ();
+
+  //key: rank; ONUs are visited in index order, so that the partitions (and the ONUs addressed) are the same in all ranks.
+  std::map<uint32_t, RemotePartition> partitions;
+  uint32_t minRemoteDelay = 0;
+  bool hasLocalOnu = false;
+  for (uint16_t i = 0; i < channel->GetNOnuDevices (); i++)
+  {
+    const Ptr<PonNetDevice>& onu = channel->GetOnuByIndex (i);
+    uint32_t systemId = onu->GetNode ()->GetSystemId ();
+    if(systemId == oltId) continue;
+
+    uint32_t delay = channel->GetOnuPropagationDelay (i);
+    if(minRemoteDelay == 0 || delay < minRemoteDelay) { minRemoteDelay = delay; }
+
+    RemotePartition& partition = partitions[systemId];
+    if(partition.m_onuIndexes.empty () || delay < partition.m_delay)
+    {
+      partition.m_systemId = systemId;
+      partition.m_firstOnuIndex = i;
+      partition.m_delay = delay;
+    }
+    partition.m_onuIndexes.push_back (i);
+
+    if(systemId == localId)
+    {
+      if(!hasLocalOnu || delay < m_localDelay) { m_localDelay = delay; }
+      hasLocalOnu = true;
+
+      Ptr<MpiReceiver> receiver = CreateObject<MpiReceiver> ();
+      receiver->SetReceiveCallback (MakeCallback (&XgponRemoteChannelProxy::ReceiveFromRemote, this));
+      onu->AggregateObject (receiver);
+    }
+  }
+
+  m_partitions.clear ();
+  if(localId == oltId)
+  {
+    for (std::map<uint32_t, RemotePartition>::iterator it = partitions.begin (); it != partitions.end (); it++)
+    {
+      m_partitions.push_back (it->second);
+    }
+
+    Ptr<MpiReceiver> receiver = CreateObject<MpiReceiver> ();
+    receiver->SetReceiveCallback (MakeCallback (&XgponRemoteChannelProxy::ReceiveFromRemote, this));
+    olt->AggregateObject (receiver);
+  }
+
+  //the frames on this channel are never received earlier than the smallest delay across ranks.
+  if(minRemoteDelay > 0)
+  {
+    Ptr<DistributedSimulatorImpl> impl = DynamicCast<DistributedSimulatorImpl> (Simulator::GetImplementation ());
+    if(impl != nullptr) { impl->BoundLookAhead (NanoSeconds (minRemoteDelay)); }
+  }
+
+  NS_LOG_INFO ("Rank " << localId << ": " << partitions.size () << " remote partitions, lookahead bound " << minRemoteDelay << "ns");
+#else
+  NS_FATAL_ERROR ("Distributed simulation of XG-PON requires ns-3 to be built with MPI!!!");
+#endif
+}
+
+
+
+
+void
+XgponRemoteChannelProxy::SendDownstream (const Ptr<XgponDsFrame>& frame)
+{
+  NS_LOG_FUNCTION (this);
+
+#ifdef NS3_MPI
+  Ptr<Packet> packet = 0;
+  for (uint32_t i = 0; i < m_partitions.size (); i++)
+  {
+    const RemotePartition& partition = m_partitions[i];
+    if(m_channel->IsDsDeliveryFilterEnabled () && !IsFrameRequired (partition, frame)) continue;
+
+    //serialize once; the packet is only encoded when at least one rank needs it.
+    if(packet == nullptr) { packet = EncodeDsFrame (frame); }
+
+    const Ptr<PonNetDevice>& onu = m_channel->GetOnuByIndex (partition.m_firstOnuIndex);
+    MpiInterface::SendPacket (packet->Copy (), Simulator::Now () + NanoSeconds (partition.m_delay),
+                              onu->GetNode ()->GetId (), onu->GetIfIndex ());
+  }
+#endif
+}
+
+
+void
+XgponRemoteChannelProxy::SendUpstream (const Ptr<XgponUsBurst>& burst, uint16_t onuIndex)
+{
+  NS_LOG_FUNCTION (this);
+
+#ifdef NS3_MPI
+  const Ptr<PonNetDevice>& olt = m_channel->GetOlt ();
+  MpiInterface::SendPacket (EncodeUsBurst (burst), Simulator::Now () + NanoSeconds (m_channel->GetOnuPropagationDelay (onuIndex)),
+                            olt->GetNode ()->GetId (), olt->GetIfIndex ());
+#endif
+}
+
+
+void
+XgponRemoteChannelProxy::ReceiveFromRemote (Ptr<Packet> packet)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t size = packet->GetSize ();
+  uint8_t* data = new uint8_t[size];
+  packet->CopyData (data, size);
+
+  Buffer buffer;
+  buffer.AddAtStart (size);
+  buffer.Begin ().Write (data, size);
+  delete [] data;
+
+  Buffer::Iterator i = buffer.Begin ();
+  uint8_t type = i.ReadU8 ();
+  if(type == XGPON_REMOTE_DS_FRAME)
+  {
+    //the frame reaches the closest local ONU now; the others receive it later.
+    m_channel->DeliverDownstreamFromRemote (DecodeDsFrame (i), m_localDelay);
+  }
+  else
+  {
+    NS_ASSERT_MSG((type == XGPON_REMOTE_US_BURST), "Unknown message from the remote rank!!!");
+    m_channel->GetOlt ()->ReceivePonFrameFromChannel (DecodeUsBurst (i));
+  }
+}
+
+
+bool
+XgponRemoteChannelProxy::IsFrameRequired (const RemotePartition& partition, const Ptr<PonFrame>& frame) const
+{
+  for (uint32_t i = 0; i < partition.m_onuIndexes.size (); i++)
+  {
+    if(m_channel->GetOnuByIndex (partition.m_onuIndexes[i])->IsDownstreamFrameRequired (frame)) return true;
+  }
+  return false;
+}
+
+
+
+
+
+
+
+/*
+ * Downstream message: type (1 byte), size of the xgtc frame (4), number of broadcast xgem frames (4),
+ * delivered to all (1), number of served ONUs (2) + their ONU-IDs (2 each),
+ * number of ONUs marked for delivery (2) + their ONU-IDs (2 each), the serialized downstream frame.
+ */
+Ptr<Packet>
+XgponRemoteChannelProxy::EncodeDsFrame (const Ptr<XgponDsFrame>& frame)
+{
+  XgponXgtcDsFrame& xgtcFrame = frame->GetXgtcDsFrame ();
+
+  std::vector<uint16_t> servedIds;
+  std::vector<uint16_t> deliveryIds;
+  xgtcFrame.GetServedOnus ().GetOnuIds (servedIds);
+  xgtcFrame.GetDeliveryOnus ().GetOnuIds (deliveryIds);
+
+  uint32_t prologue = 1 + 4 + 4 + 1 + 2 + 2 * servedIds.size () + 2 + 2 * deliveryIds.size ();
+  uint32_t size = prologue + frame->GetSerializedSize ();
+
+  Buffer buffer;
+  buffer.AddAtStart (size);
+  Buffer::Iterator i = buffer.Begin ();
+
+  i.WriteU8 (XGPON_REMOTE_DS_FRAME);
+  i.WriteHtonU32 (xgtcFrame.GetSerializedSize ());
+  i.WriteHtonU32 (xgtcFrame.GetNBroadcastXgemFrames ());
+  i.WriteU8 (xgtcFrame.IsDeliveredToAll () ? 1 : 0);
+  i.WriteHtonU16 (servedIds.size ());
+  for (uint32_t j = 0; j < servedIds.size (); j++) { i.WriteHtonU16 (servedIds[j]); }
+  i.WriteHtonU16 (deliveryIds.size ());
+  for (uint32_t j = 0; j < deliveryIds.size (); j++) { i.WriteHtonU16 (deliveryIds[j]); }
+
+  frame->Serialize (i);
+
+  return Create<Packet> (buffer.PeekData (), size);
+}
+
+Ptr<XgponDsFrame>
+XgponRemoteChannelProxy::DecodeDsFrame (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  Ptr<XgponDsFrame> frame = Create<XgponDsFrame> ();
+  XgponXgtcDsFrame& xgtcFrame = frame->GetXgtcDsFrame ();
+
+  xgtcFrame.SetBurstSize (i.ReadNtohU32 ());
+  xgtcFrame.SetBroadcastXgemFrameNumber (i.ReadNtohU32 ());
+  if(i.ReadU8 () != 0) { xgtcFrame.MarkAllOnusForDelivery (); }
+
+  XgponOnuIdSet& servedOnus = xgtcFrame.GetServedOnus ();
+  uint16_t num = i.ReadNtohU16 ();
+  for (uint16_t j = 0; j < num; j++) { servedOnus.Add (i.ReadNtohU16 ()); }
+  num = i.ReadNtohU16 ();
+  for (uint16_t j = 0; j < num; j++) { xgtcFrame.MarkOnuForDelivery (i.ReadNtohU16 ()); }
+
+  frame->Deserialize (i);
+  return frame;
+}
+
+
+
+
+/*
+ * Upstream message: type (1 byte), PLOAM exists (1), number of allocations (2),
+ * for each allocation: DBRu exists (1) + its size (4), the serialized upstream burst.
+ */
+Ptr<Packet>
+XgponRemoteChannelProxy::EncodeUsBurst (const Ptr<XgponUsBurst>& burst)
+{
+  XgponXgtcUsBurst& xgtcBurst = burst->GetXgtcUsBurst ();
+  uint16_t allocNum = xgtcBurst.GetUsAllocationCount ();
+
+  //the XGTC burst is carried directly: XgponUsBurst::GetSerializedSize does not count it (PSBu is not simulated).
+  uint32_t size = 1 + 1 + 2 + 5 * allocNum + xgtcBurst.GetSerializedSize ();
+
+  Buffer buffer;
+  buffer.AddAtStart (size);
+  Buffer::Iterator i = buffer.Begin ();
+
+  i.WriteU8 (XGPON_REMOTE_US_BURST);
+  i.WriteU8 (xgtcBurst.GetHeader ().GetPloam () != nullptr ? 1 : 0);
+  i.WriteHtonU16 (allocNum);
+  for (uint16_t j = 0; j < allocNum; j++)
+  {
+    const Ptr<XgponXgtcUsAllocation>& alloc = xgtcBurst.GetUsAllocationByIndex (j);
+    i.WriteU8 (alloc->GetDbru () != nullptr ? 1 : 0);
+    i.WriteHtonU32 (alloc->GetSerializedSize ());
+  }
+
+  xgtcBurst.Serialize (i);
+
+  return Create<Packet> (buffer.PeekData (), size);
+}
+
+Ptr<XgponUsBurst>
+XgponRemoteChannelProxy::DecodeUsBurst (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  Ptr<XgponUsBurst> burst = Create<XgponUsBurst> ();
+  XgponXgtcUsBurst& xgtcBurst = burst->GetXgtcUsBurst ();
+
+  xgtcBurst.GetHeader ().SetPloamExist (i.ReadU8 () != 0);
+  uint16_t allocNum = i.ReadNtohU16 ();
+  for (uint16_t j = 0; j < allocNum; j++)
+  {
+    Ptr<XgponXgtcUsAllocation> alloc = Create<XgponXgtcUsAllocation> ();
+    alloc->SetDbruExist (i.ReadU8 () != 0);
+    alloc->SetAllocationSize (i.ReadNtohU32 ());
+    xgtcBurst.AddUsAllocation (alloc);
+  }
+
+  xgtcBurst.Deserialize (i);
+  return burst;
+}
+
+
+} // namespace ns3
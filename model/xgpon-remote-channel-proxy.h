@@ -0,0 +1,138 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2012 University College Cork (UCC), Ireland
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jerome Arokkiam <jerome.arokkia@bt.com>
+ */
+
+#ifndef XGPON_REMOTE_CHANNEL_PROXY_H
+#define XGPON_REMOTE_CHANNEL_PROXY_H
+
+#include <vector>
+
+#include "ns3/object.h"
+#include "ns3/packet.h"
+
+#include "xgpon-ds-frame.h"
+#include "xgpon-us-burst.h"
+
+
+
+namespace ns3 {
+
+class XgponChannel;
+
+/**
+ * \ingroup xgpon
+ * \brief Carries XG-PON frames between simulator instances (MPI ranks) in a distributed simulation.
+ *
+ * The OLT and the ONUs attached to one XgponChannel may be simulated by different ranks.
+ * All ranks hold the whole topology; the channel only schedules frames for the local devices and
+ * passes the others to this proxy. One downstream frame is serialized once and sent once per remote rank
+ * that simulates ONUs, addressed to its closest ONU. The receiving rank fans it out to its local ONUs with
+ * the remaining propagation delays. Upstream bursts are serialized and sent to the OLT directly.
+ *
+ * The meta-data that the air interface does not carry (set by the receiver before deserialization)
+ * is sent in a short prologue before the frame. Packet tags (and byte tags) are not carried across ranks:
+ * the SDUs received from another rank carry none. This path is not covered by the test suite (it needs mpirun);
+ * examples/xpon-mpi-DS-US.cc can be run with one rank as the reference.
+ * The channel is not point-to-point, so the lookahead of the distributed simulator is bounded by the
+ * smallest propagation delay between the OLT and one ONU simulated by another rank.
+ */
+class XgponRemoteChannelProxy : public Object
+{
+public:
+  const static uint8_t XGPON_REMOTE_DS_FRAME = 0;    //the type of the message that carries one downstream frame
+  const static uint8_t XGPON_REMOTE_US_BURST = 1;    //the type of the message that carries one upstream burst
+
+
+  /**
+   * \brief Constructor
+   */
+  XgponRemoteChannelProxy ();
+  virtual ~XgponRemoteChannelProxy ();
+
+
+  /**
+   * \brief find the remote ranks, install the MPI receivers on the local devices and bound the lookahead.
+   *        It should be called after all devices are attached to the channel and their propagation delays are set.
+   * \param channel the channel whose devices are simulated by different ranks
+   */
+  void Setup (const Ptr<XgponChannel>& channel);
+
+
+  /**
+   * \brief send one downstream frame to the ranks that simulate ONUs (called at the rank of OLT)
+   */
+  void SendDownstream (const Ptr<XgponDsFrame>& frame);
+
+  /**
+   * \brief send one upstream burst to the rank that simulates the OLT
+   * \param burst the upstream burst
+   * \param onuIndex the index of the ONU (in the channel) that transmits this burst
+   */
+  void SendUpstream (const Ptr<XgponUsBurst>& burst, uint16_t onuIndex);
+
+
+
+  /////////////////////////////////////////conversion between frames and the packets sent between ranks
+  static Ptr<Packet> EncodeDsFrame (const Ptr<XgponDsFrame>& frame);
+  static Ptr<XgponDsFrame> DecodeDsFrame (Buffer::Iterator start);
+
+  static Ptr<Packet> EncodeUsBurst (const Ptr<XgponUsBurst>& burst);
+  static Ptr<XgponUsBurst> DecodeUsBurst (Buffer::Iterator start);
+
+
+
+
+  /////////////////////////////////////////////////////////////////////////required by NS-3
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+
+
+
+private:
+  /**
+   * \brief one rank (other than the one of OLT) that simulates ONUs.
+   */
+  struct RemotePartition
+  {
+    uint32_t m_systemId;                   //the rank
+    uint16_t m_firstOnuIndex;              //the ONU with the smallest delay in this rank. The downstream frames are addressed to it.
+    uint32_t m_delay;                      //the propagation delay of this ONU. unit: nanosecond
+    std::vector<uint16_t> m_onuIndexes;    //all ONUs simulated by this rank
+  };
+
+  //called by the MPI receivers of local devices
+  void ReceiveFromRemote (Ptr<Packet> packet);
+
+  //whether any ONU of this rank has to receive the frame (used when the delivery filter is enabled)
+  bool IsFrameRequired (const RemotePartition& partition, const Ptr<PonFrame>& frame) const;
+
+
+  Ptr<XgponChannel> m_channel;
+
+  std::vector<RemotePartition> m_partitions;   //used at the rank of OLT: the ranks that simulate ONUs
+  uint32_t m_localDelay;                       //used at the ranks of ONUs: the smallest delay of the local ONUs. unit: nanosecond
+
+
+  virtual void DoDispose (void);
+};
+
+
+} // namespace ns3
+
+#endif /* XGPON_REMOTE_CHANNEL_PROXY_H */
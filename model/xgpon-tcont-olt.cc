@@ -58,7 +58,11 @@ XgponTcontOlt::XgponTcontOlt (): XgponTcont (),
   m_totalAllocatedRate(0),
   m_variable_word(0),
   m_connections(0),
-  m_pkt4Reassemble(0)
+  m_fragments4Reassemble(0),
+  m_sduDiscarded(false),
+  m_grants(16),
+  m_firstGrantSeq(0), m_endGrantSeq(0), m_assignedTotal(0),
+  m_reportCursorSeq(0), m_reportCursorTime(0), m_reportCursorDelay(0)
 {
 }
 
@@ -144,15 +148,59 @@ XgponTcontOlt::AddNewBwAllocation2ServiceHistory (const Ptr<XgponXgtcBwAllocatio
   NS_LOG_FUNCTION(this);
 
   allocation->SetCreateTime(time);
-  AddNewBwAllocation (allocation);
 
   int64_t timeTh = time - XgponNetDevice::HISTORY_2_MAINTAIN;
   if(timeTh > 0) ClearOldBandwidthAllocations(timeTh);
 
+  if(m_endGrantSeq - m_firstGrantSeq == m_grants.size())
+  {
+    //the ring is full: double it and keep the sequence-to-slot mapping (seq & (size-1)).
+    std::vector<GrantRecord> grants(m_grants.size() * 2);
+    for(uint64_t seq = m_firstGrantSeq; seq < m_endGrantSeq; seq++) grants[seq & (grants.size() - 1)] = GetGrantRecord(seq);
+    m_grants.swap(grants);
+  }
+
+  GrantRecord& record = m_grants[m_endGrantSeq & (m_grants.size() - 1)];
+  record.m_createTime = time;
+  record.m_assignedBefore = m_assignedTotal;
+  m_endGrantSeq++;
+
+  //the occupancy report occupies one block of the grant.
+  m_assignedTotal += allocation->GetGrantSize();
+  if(allocation->GetDbruFlag()) m_assignedTotal -= 1;
+
   if(allocation->GetDbruFlag() != 0) { m_lastPollingTime = time; }
 }
 
 
+void
+XgponTcontOlt::AddNewBwAllocation (const Ptr<XgponXgtcBwAllocation>& allocation)
+{
+  NS_FATAL_ERROR ("The OLT keeps only the creation times and sizes of the bandwidth allocations (use AddNewBwAllocation2ServiceHistory)!!!");
+}
+
+const Ptr<XgponXgtcBwAllocation>&
+XgponTcontOlt::GetOldestBwAllocation () const
+{
+  NS_FATAL_ERROR ("The bandwidth allocations are not kept at the OLT side!!!");
+  return m_nullBwAlloc;
+}
+
+const Ptr<XgponXgtcBwAllocation>&
+XgponTcontOlt::GetLatestBwAllocation () const
+{
+  NS_FATAL_ERROR ("The bandwidth allocations are not kept at the OLT side!!!");
+  return m_nullBwAlloc;
+}
+
+const std::deque < Ptr<XgponXgtcBwAllocation> >&
+XgponTcontOlt::GetAllBwAllocations ()
+{
+  NS_FATAL_ERROR ("The bandwidth allocations are not kept at the OLT side!!!");
+  return m_bwAllocations;
+}
+
+
 void 
 XgponTcontOlt::AddOneConnection (const Ptr<XgponConnectionReceiver>& conn)
 {
@@ -174,31 +222,16 @@ XgponTcontOlt::CalculateRemainingDataToServe (uint64_t rtt, uint64_t slotSize)
   uint32_t latestOccupancy = dbru->GetBufOcc (); //unit: blocks (4-Bytes/16-Bytes)
   uint64_t lastReportTime = dbru->GetReceiveTime ();
 
-  if(m_bwAllocations.size()==0) return latestOccupancy;
+  if(m_endGrantSeq==m_firstGrantSeq) return latestOccupancy;
 
 
-  //since m_bwAllocations is maintained according to creation time (ascend order), we should start from the tail to consider the newer bwallocs.
-  std::deque < Ptr<XgponXgtcBwAllocation> >::reverse_iterator rit, rend;
-  rend = m_bwAllocations.rend();
-  rit = m_bwAllocations.rbegin();
+  //The allocations that have been counted in the latest report are those created at least (rtt + slotSize/2) before the report.
+  //the status report in one burst includes the data transmitted in that burst. Thus, slotSize / 2 is added to include the corresponding bwalloc.
+  //The data of the newer allocations (a suffix of the history) is assigned but not reported yet; its sum is calculated from m_assignedBefore.
+  UpdateReportCursor (lastReportTime, rtt + slotSize/2);
+
   uint32_t assignedSize = 0; //unit: blocks (of 4 Bytes in XGPON, of 16 Bytes in XGSPON)
-  while(rit!=rend)
-  {
-    //the status report in one burst includes the data transmitted in that burst. Thus, slotSize / 2 is added to include the corresponding bwalloc.
-    uint64_t timeTh = (*rit)->GetCreateTime() + rtt + slotSize/2; //ja:update:xgsponv5, slotSize/2 replaced by slotSize, to allow time for all buf occupancy to be read; in the Config History, this is referred to as Fix 3;
-		//std::cout << "DBA_timing,timeTh: " << timeTh << ",lastReportTime,"<< lastReportTime << ",createTime,"<< (*rit)->GetCreateTime() << std::endl;
-			
-		if(timeTh > lastReportTime)   
-    {	
-			//std::cout << "DBA_timing,timeTh > lastReportTime" << std::endl;
-      assignedSize += (*rit)->GetGrantSize();
-      if((*rit)->GetDbruFlag()) assignedSize -= 1;   //ocuupancy report occupies one word;    
-      rit++;  
-    }else{
-			//std::cout << "timeTh <= lastReportTime " << std::endl;
-			break;
-		}
-  } 
+  if(m_reportCursorSeq < m_endGrantSeq) assignedSize = (uint32_t) (m_assignedTotal - GetGrantRecord(m_reportCursorSeq).m_assignedBefore);
   
   int remain = latestOccupancy - assignedSize;
   if(remain < 0) remain = 0;
@@ -209,6 +242,35 @@ XgponTcontOlt::CalculateRemainingDataToServe (uint64_t rtt, uint64_t slotSize)
 
 
 
+void
+XgponTcontOlt::UpdateReportCursor (uint64_t reportTime, uint64_t delay)
+{
+  if(reportTime < m_reportCursorTime || delay != m_reportCursorDelay || m_reportCursorSeq < m_firstGrantSeq)
+  {
+    m_reportCursorSeq = m_firstGrantSeq;
+  }
+  m_reportCursorTime = reportTime;
+  m_reportCursorDelay = delay;
+
+  while(m_reportCursorSeq < m_endGrantSeq && GetGrantRecord(m_reportCursorSeq).m_createTime + delay <= reportTime) m_reportCursorSeq++;
+}
+
+
+uint64_t
+XgponTcontOlt::GetAssignedSizeReported (uint64_t rtt, uint64_t slotSize)
+{
+  NS_LOG_FUNCTION(this);
+
+  const Ptr<XgponXgtcDbru>& dbru = GetLatestBufOccupancyReport ();
+  if(dbru==nullptr) return 0;
+
+  UpdateReportCursor (dbru->GetReceiveTime (), rtt + slotSize/2);
+  if(m_reportCursorSeq < m_endGrantSeq) return GetGrantRecord(m_reportCursorSeq).m_assignedBefore;
+  else return m_assignedTotal;
+}
+
+
+
 void 
 XgponTcontOlt::ClearOldBufOccupancyReports (uint64_t time)
 {
@@ -230,12 +292,7 @@ XgponTcontOlt::ClearOldBandwidthAllocations (uint64_t time)
 {
   NS_LOG_FUNCTION(this);
 
-  while(m_bwAllocations.size() > 0)
-  {
-    const Ptr<XgponXgtcBwAllocation>& bwAlloc = m_bwAllocations.front();
-    if(bwAlloc->GetCreateTime () < time) m_bwAllocations.pop_front();
-    else break;
-  }
+  while(m_firstGrantSeq < m_endGrantSeq && GetGrantRecord(m_firstGrantSeq).m_createTime < time) m_firstGrantSeq++;
 
   return;
 }
@@ -61,9 +61,17 @@ public:
 
 
   //put the just created bandwidth allocation into the service history of this T-CONT.
+  //Only its creation time and size are kept (the allocation itself is not referenced after this call).
   void AddNewBwAllocation2ServiceHistory (const Ptr<XgponXgtcBwAllocation>& allocation, uint64_t time);
 
 
+  //The allocations themselves are not kept at the OLT side: these accessors of XgponTcont must not be used on XgponTcontOlt.
+  virtual void AddNewBwAllocation (const Ptr<XgponXgtcBwAllocation>& allocation);
+  virtual const Ptr<XgponXgtcBwAllocation>& GetOldestBwAllocation () const;
+  virtual const Ptr<XgponXgtcBwAllocation>& GetLatestBwAllocation () const;
+  virtual const std::deque < Ptr<XgponXgtcBwAllocation> >& GetAllBwAllocations ();
+
+
   //Get the time that the latest polling grant is sent to this T-CONT.
   //the latest polling time is set when the corresponding bwalloc is put into the history list.
   uint64_t GetLatestPollingTime();
@@ -84,18 +92,39 @@ public:
    */
   uint32_t CalculateRemainingDataToServe (uint64_t rtt, uint64_t slotSize);
 
+  /**
+   * \brief the data assigned to this T-CONT by all bandwidth allocations so far (DBRu excluded). It only grows. unit: block
+   */
+  uint64_t GetAssignedSizeTotal (void) const;
+
+  /**
+   * \brief the part of GetAssignedSizeTotal that has been counted by the latest queue occupancy report
+   *        (the allocations created at least rtt + slotSize/2 before the report). unit: block
+   */
+  uint64_t GetAssignedSizeReported (uint64_t rtt, uint64_t slotSize);
+
   //////////////////////////////////////////////////////////////Reassemble related functions
   /**
-   * \brief put back the received fragments for further reassemble. 
+   * \brief keep one received segment (not the last one) for further reassemble. 
    */  
-  void SetPacket4Reassemble (const Ptr<Packet>& pkt);
+  void AddFragment4Reassemble (const Ptr<Packet>& pkt);
 
   /**
-   * \brief Return the received segments to carry out further reassemble. 
-   * \return the segments received previously. 0: have not received any segment.
-   * Note that we cannot return one reference since the packet to be reassembled may be empty.
+   * \brief Return the segments received previously (empty: no SDU is being reassembled). 
+   * They are cleared by XgponXgemRoutines::ReassembleSdu when the last segment arrives.
    */
-  const Ptr<Packet> GetPacket4Reassemble ( );
+  std::vector< Ptr<Packet> >& GetFragments4Reassemble ( );
+
+  /**
+   * \brief one segment of the SDU being received was lost: the segments received before are discarded.
+   * \param restDiscarded whether the lost segment was not the last one of its SDU (the following segments, up to the last one, are discarded too)
+   */
+  void DiscardFragments4Reassemble (bool restDiscarded);
+
+  /**
+   * \return whether the segments of the current SDU are discarded (one of them was lost)
+   */
+  bool IsSduDiscarded ( ) const;
 
   
   
@@ -141,8 +170,35 @@ private:
   uint16_t m_girTimer;
   int32_t  m_variable_word;                 //unit: bytes, to store the remaining variable byte
   std::vector< Ptr<XgponConnectionReceiver> > m_connections;    //Connections of the same alloc-id. They should have the same T-CONT type
-  Ptr<Packet> m_pkt4Reassemble;             //used to hold the packet to be reassembled (only one connection of the same T-CONT can be in reassemble mode). 
+  std::vector< Ptr<Packet> > m_fragments4Reassemble;   //used to hold the segments to be reassembled (only one connection of the same T-CONT can be in reassemble mode). 
+  bool m_sduDiscarded;                                  //one segment of the current SDU was lost
   XgponQosParameters::XgponTcontType m_tcontType; //jerome, A1, C1, T-CONT type of the T-CONT
+
+
+  /**
+   * \brief one bandwidth allocation in the service history.
+   */
+  struct GrantRecord
+  {
+    uint64_t m_createTime;       //unit: nanosecond
+    uint64_t m_assignedBefore;   //the sum of the data sizes of all earlier allocations (DBRu excluded). unit: block
+  };
+
+  //the service history is a ring (in the order of creation time). Allocations are identified by their sequence numbers.
+  std::vector<GrantRecord> m_grants;        //the size is a power of 2
+  uint64_t m_firstGrantSeq;                 //the sequence number of the oldest allocation in the ring
+  uint64_t m_endGrantSeq;                   //the sequence number of the next allocation
+  uint64_t m_assignedTotal;                 //the sum of the data sizes of all allocations. unit: block
+
+  //the oldest allocation that is created after the latest report minus (rtt + slotSize/2); it only moves forward for the same delay.
+  uint64_t m_reportCursorSeq;
+  uint64_t m_reportCursorTime;              //the receive time of the report that the cursor is calculated for
+  uint64_t m_reportCursorDelay;             //rtt + slotSize/2 that the cursor is calculated for
+
+  const GrantRecord& GetGrantRecord (uint64_t seq) const;
+
+  //move m_reportCursorSeq to the oldest allocation that is not counted in the report received at the time.
+  void UpdateReportCursor (uint64_t reportTime, uint64_t delay);
   
   
   //remove based on receive_time
@@ -157,21 +213,26 @@ private:
 
 //////////////////////////////////////INLINE Functions
 inline void 
-XgponTcontOlt::SetPacket4Reassemble (const Ptr<Packet>& pkt)
+XgponTcontOlt::AddFragment4Reassemble (const Ptr<Packet>& pkt)
 {
   NS_ASSERT_MSG((pkt!=nullptr), "The packet to be reassembled is NULL!!!");
-  m_pkt4Reassemble = pkt;
+  m_fragments4Reassemble.push_back (pkt);
 }
-inline const Ptr<Packet>
-XgponTcontOlt::GetPacket4Reassemble () 
+inline std::vector< Ptr<Packet> >&
+XgponTcontOlt::GetFragments4Reassemble () 
 {
-  Ptr<Packet> pkt = 0;
-  
-  if(m_pkt4Reassemble!=nullptr) pkt = m_pkt4Reassemble;
-
-  m_pkt4Reassemble = 0;
-
-  return pkt;
+  return m_fragments4Reassemble;
+}
+inline void
+XgponTcontOlt::DiscardFragments4Reassemble (bool restDiscarded)
+{
+  m_fragments4Reassemble.clear ();
+  m_sduDiscarded = restDiscarded;
+}
+inline bool
+XgponTcontOlt::IsSduDiscarded () const
+{
+  return m_sduDiscarded;
 }
 
 inline void 
@@ -199,6 +260,18 @@ XgponTcontOlt::GetAllocationWords ( ) const
   return  m_allocationWords;
 }
 
+inline const XgponTcontOlt::GrantRecord&
+XgponTcontOlt::GetGrantRecord (uint64_t seq) const
+{
+  return m_grants[seq & (m_grants.size() - 1)];
+}
+
+inline uint64_t
+XgponTcontOlt::GetAssignedSizeTotal (void) const
+{
+  return m_assignedTotal;
+}
+
 inline uint64_t 
 XgponTcontOlt::GetLatestPollingTime()
 {
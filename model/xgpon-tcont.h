@@ -55,10 +55,11 @@ public:
 
   /* bandwidth allocation related operations */
   //this is the actual bandwidth allocation for this TCONT, when served by GIANT MAC
-  void AddNewBwAllocation (const Ptr<XgponXgtcBwAllocation>& allocation);
-  const Ptr<XgponXgtcBwAllocation>& GetOldestBwAllocation () const;  
-  const Ptr<XgponXgtcBwAllocation>& GetLatestBwAllocation () const;  
-  const std::deque < Ptr<XgponXgtcBwAllocation> >& GetAllBwAllocations ();
+  //The OLT keeps only the creation times and sizes of its allocations (XgponTcontOlt::AddNewBwAllocation2ServiceHistory); it overrides these with assertions.
+  virtual void AddNewBwAllocation (const Ptr<XgponXgtcBwAllocation>& allocation);
+  virtual const Ptr<XgponXgtcBwAllocation>& GetOldestBwAllocation () const;  
+  virtual const Ptr<XgponXgtcBwAllocation>& GetLatestBwAllocation () const;  
+  virtual const std::deque < Ptr<XgponXgtcBwAllocation> >& GetAllBwAllocations ();
 
   ////////////////////////////////////////////////Member variable accessors
   void SetAllocId (uint16_t allocId);
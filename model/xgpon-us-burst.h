@@ -24,6 +24,7 @@
 
 #include <cstdlib>
 #include <stack>
+#include <vector>
 
 #include "pon-frame.h"
 //#include "xgpon-psbu.h"
@@ -70,6 +71,12 @@ public:
    */
   XgponXgtcUsBurst& GetXgtcUsBurst ();
 
+  /**
+   * \brief get the FEC codewords of the XGTC burst. They are only filled by the transmitter when the bytes are simulated
+   *        (FEC or bit errors enabled) and they are not serialized (the receiver encodes the frame again if empty).
+   */
+  std::vector<uint8_t>& GetCodewords ();
+
 
 
   
@@ -92,6 +99,8 @@ private:
   //XgponPsbu m_psbu; ja:update:xgspon
   XgponXgtcUsBurst m_xgtcUsBurst;
 
+  std::vector<uint8_t> meta_codewords;   //the codewords sent over the channel; used for simulating bit errors and FEC decoding
+
   //disable users to call new[] and delete[].
   void* operator new[](size_t size) noexcept(false) //throw(const char*) 
   {
@@ -120,6 +129,14 @@ XgponUsBurst::GetXgtcUsBurst ()
 
 
 
+inline std::vector<uint8_t>&
+XgponUsBurst::GetCodewords ()
+{
+  return meta_codewords;
+}
+
+
+
 }; // namespace ns3
 
 #endif // XGPON_US_Burst_H
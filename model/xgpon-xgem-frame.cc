@@ -22,6 +22,7 @@
 #include "ns3/log.h"
 
 #include "xgpon-xgem-frame.h"
+#include "xgpon-xgem-routines.h"
 
 
 
@@ -36,7 +37,7 @@ std::stack<void*> XgponXgemFrame::m_pool;   //initialize as one empty list;
 bool XgponXgemFrame::m_poolEnabled = true;
 
 XgponXgemFrame::XgponXgemFrame () 
-  : m_type(XGPON_XGEM_FRAME_SHORT_IDLE), m_data(0)
+  : m_type(XGPON_XGEM_FRAME_SHORT_IDLE), m_data(0), meta_keystreamOffset(0)
 {
   /*
   CREATED_XGEM_FRAME_NUM4DEBUG++;
@@ -131,6 +132,11 @@ XgponXgemFrame::Print (std::ostream &os)  const
   else if (m_type == XGPON_XGEM_FRAME_LONG_IDLE)
   {
     os << " LONG-IDLE-XGEM-FRAME: " << GetSerializedSize() << " bytes ";
+  } 
+  else if (m_type == XGPON_XGEM_FRAME_LOST)
+  {
+    os << " LOST-XGEM-FRAME: " << GetSerializedSize() << " bytes " << std::endl;
+    m_header.Print(os);
   } else
   {  
     os << " LONG-IDLE-XGEM-FRAME: " << GetSerializedSize() << " bytes " << std::endl;
@@ -159,12 +165,60 @@ XgponXgemFrame::GetSerializedSize (void) const
 void 
 XgponXgemFrame::Serialize (Buffer::Iterator start) const
 {
+  Buffer::Iterator i = start;
+
+  if(m_type == XGPON_XGEM_FRAME_SHORT_IDLE)  //4 bytes of zeros
+  {
+    i.WriteU32 (0);
+    return;
+  }
+
+  m_header.Serialize (i);
+  i.Next (XgponXgemHeader::XGPON_XGEM_HEADER_LENGTH);
+
+  uint32_t pli = m_header.GetPli ();
+  uint32_t written = 0;
+  if(m_type == XGPON_XGEM_FRAME_WITH_DATA)
+  {
+    NS_ASSERT_MSG((m_data->GetSize() == pli), "PLI does not match the size of the SDU!!!");
+    uint8_t *buf = new uint8_t[pli];
+    m_data->CopyData (buf, pli);
+    i.Write (buf, pli);
+    delete [] buf;
+    written = pli;
+  }
+
+  //padding (and the payload of idle frames) are all zeros
+  uint32_t padded = GetPaddedPayloadSize (pli);
+  for(; written < padded; written++) i.WriteU8 (0);
+
   return;
 }
 
 uint32_t 
 XgponXgemFrame::Deserialize (Buffer::Iterator start)
 {
+  //short idle frames are recognized by the receiver (less than one XGEM header remains) and are not deserialized here.
+  Buffer::Iterator i = start;
+
+  m_header.Deserialize (i);
+  i.Next (XgponXgemHeader::XGPON_XGEM_HEADER_LENGTH);
+
+  uint32_t pli = m_header.GetPli ();
+  if(m_header.GetXgemPortId () == XgponXgemRoutines::XGPON_IDLE_XGEM_PORT_ID)
+  {
+    m_type = XGPON_XGEM_FRAME_LONG_IDLE;
+    m_data = 0;
+  }
+  else
+  {
+    m_type = XGPON_XGEM_FRAME_WITH_DATA;
+    uint8_t *buf = new uint8_t[pli];
+    i.Read (buf, pli);
+    m_data = Create<Packet> (buf, pli);
+    delete [] buf;
+  }
+
   return GetSerializedSize ();
 }
 
@@ -55,6 +55,7 @@ public:
     XGPON_XGEM_FRAME_SHORT_IDLE,     //short idle frame (shorter than header, there is no header and data)
     XGPON_XGEM_FRAME_LONG_IDLE,      //long idle frame (one header exist, but sdu is empty)
     XGPON_XGEM_FRAME_WITH_DATA,      //normal frame (with both header and sdu)
+    XGPON_XGEM_FRAME_LOST,           //normal frame in the FEC blocks that could not be corrected (only the header is kept, to tell the receiver)
   };
 
 
@@ -76,6 +77,12 @@ public:
   XgponXgemHeader& GetXgemHeader ();  //there is no corresponding set-operator for the header.
                                       //the caller will change the header of the xgem frame directly.
 
+  //META-data: the first keystream block of the payload (unit: AES block), counted from the first unicast XGEM frame of the
+  //downstream frame or from the first XGEM frame of the upstream allocation. It is set by the sender (or when deserializing),
+  //so that the receiver does not depend on the XGEM frames before this one (they may be lost).
+  uint64_t GetKeystreamOffset () const;
+  void SetKeystreamOffset (uint64_t offset);
+
 
 
   /**
@@ -105,6 +112,7 @@ private:
   XgponXgemFrameType m_type;
   XgponXgemHeader m_header;
   Ptr<Packet> m_data;
+  uint64_t meta_keystreamOffset;    //META-data: it will not be serialized.
 
   //disable users to call new[] and delete[].
   void* operator new[](size_t size) noexcept(false) //throw(const char*) 
@@ -147,6 +155,18 @@ XgponXgemFrame::GetXgemHeader ()
   return m_header;
 }
 
+inline uint64_t
+XgponXgemFrame::GetKeystreamOffset () const
+{
+  return meta_keystreamOffset;
+}
+
+inline void
+XgponXgemFrame::SetKeystreamOffset (uint64_t offset)
+{
+  meta_keystreamOffset = offset;
+}
+
 
 
 
@@ -23,6 +23,8 @@
 
 #include "ns3/buffer.h"
 
+#include "xgpon-integrity.h"
+
 
 
 namespace ns3 {
@@ -85,6 +87,9 @@ private:
   uint8_t   m_lastFragment;//Last Fragment. Len: 1 bit;  1: The last Fragment or a complete SDU; 0: Fragment
   uint16_t  m_hec;         //Hybrid error correction. Len: 13 bits
 
+  //the 51 bits protected by HEC
+  uint64_t GetProtectedBits () const;
+
 };
 
 
@@ -149,17 +154,23 @@ XgponXgemHeader::GetLastFragmentFlag () const
 }
 
 
+inline uint64_t 
+XgponXgemHeader::GetProtectedBits () const
+{
+  return ((uint64_t) m_pli << 37) | ((uint64_t) m_keyIndex << 35) | ((uint64_t) m_xgemPortId << 19) | ((uint64_t) m_options << 1) | m_lastFragment;
+}
+
 inline void 
 XgponXgemHeader::CalculateHec ()
 {
-  //won't calculate for simulation speed 
-  //uint16_t hec;
-  //m_hec = hec & 0x1fff;  //13its
+  //won't calculate for simulation speed unless integrity fields are enabled.
+  if(XgponIntegrity::IsEnabled ()) m_hec = XgponIntegrity::CalculateHec (GetProtectedBits (), 51);
 }
 inline  bool 
 XgponXgemHeader::VerifyHec () const
 {
-  return true;
+  if(!XgponIntegrity::IsEnabled ()) return true;
+  return m_hec == XgponIntegrity::CalculateHec (GetProtectedBits (), 51);
 }
 
 
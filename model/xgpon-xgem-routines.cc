@@ -53,6 +53,107 @@ XgponXgemRoutines::CreateShortIdleXgemFrame ( )
   return frame;
 }
 
+Ptr<XgponXgemFrame>
+XgponXgemRoutines::CreateLostXgemFrame (const Ptr<XgponXgemFrame>& frame)
+{
+  Ptr<XgponXgemFrame> lost = Create<XgponXgemFrame> ();
+  lost->SetType (XgponXgemFrame::XGPON_XGEM_FRAME_LOST);
+  lost->GetXgemHeader () = frame->GetXgemHeader ();
+  lost->SetKeystreamOffset (frame->GetKeystreamOffset ());
+
+  return lost;
+}
+
+
+
+void
+XgponXgemRoutines::SerializeIdleSpan (Buffer::Iterator start, uint32_t size)
+{
+  NS_ASSERT_MSG(((size%4) == 0), "The size of the idle span is not a multiple of 4!!!");
+
+  Buffer::Iterator i = start;
+  while(size > 0)
+  {
+    if(size < XgponXgemHeader::XGPON_XGEM_HEADER_LENGTH)  //short idle xgem frame: 4 bytes of zeros
+    {
+      i.WriteU32 (0);
+      return;
+    }
+
+    uint32_t frameSize = (size > XGPON_XGEM_FRAME_MAXLEN) ? XGPON_XGEM_FRAME_MAXLEN : size;
+    if(size - frameSize == 4) frameSize -= 8;   //avoid leaving 4 bytes that cannot hold a header behind a full frame
+
+    XgponXgemHeader idleHeader;
+    idleHeader.SetXgemPortId(XGPON_IDLE_XGEM_PORT_ID);
+    idleHeader.SetPli(frameSize - XgponXgemHeader::XGPON_XGEM_HEADER_LENGTH);
+    idleHeader.SetKeyIndex(0);
+    idleHeader.SetOptions(0);
+    idleHeader.SetLastFragmentFlag(1);
+    idleHeader.CalculateHec ();
+    idleHeader.Serialize (i);
+    i.Next (XgponXgemHeader::XGPON_XGEM_HEADER_LENGTH);
+
+    for(uint32_t j = XgponXgemHeader::XGPON_XGEM_HEADER_LENGTH; j < frameSize; j += 4) i.WriteU32 (0);
+    size -= frameSize;
+  }
+}
+
+uint32_t
+XgponXgemRoutines::DeserializeIdleSpan (Buffer::Iterator start, uint32_t maxSize)
+{
+  Buffer::Iterator i = start;
+  uint32_t size = 0;
+  while(size < maxSize)
+  {
+    uint32_t remaining = maxSize - size;
+    if(remaining < XgponXgemHeader::XGPON_XGEM_HEADER_LENGTH) return maxSize;
+
+    XgponXgemHeader header;
+    header.Deserialize (i);
+    if(header.GetXgemPortId () != XGPON_IDLE_XGEM_PORT_ID) break;
+
+    uint32_t frameSize = XgponXgemHeader::XGPON_XGEM_HEADER_LENGTH + header.GetPli ();
+    NS_ASSERT_MSG((frameSize <= remaining), "The idle xgem frame is longer than the payload!!!");
+    i.Next (frameSize);
+    size += frameSize;
+  }
+  return size;
+}
+
+
+
+
+Ptr<Packet>
+XgponXgemRoutines::ReassembleSdu (std::vector< Ptr<Packet> >& fragments, const Ptr<Packet>& lastFragment)
+{
+  if(fragments.empty()) return lastFragment;  //not segmented
+
+  Ptr<Packet> sdu = fragments[0]->Copy ();   //the buffer is shared until the segments are appended.
+  for(uint32_t i = 1; i < fragments.size(); i++) { sdu->AddAtEnd (fragments[i]); }
+  sdu->AddAtEnd (lastFragment);
+
+  fragments.clear ();
+  return sdu;
+}
+
+
+
+Ptr<Packet>
+XgponXgemRoutines::CryptXgemPayload (const Ptr<Packet>& payload, const Ptr<XgponKey>& key, uint64_t nonce, uint64_t counter)
+{
+  NS_ASSERT_MSG((key != nullptr && key->HasKeyData ()), "Try to encrypt with one key without key data!!!");
+
+  uint8_t buffer[XGPON_XGEM_FRAME_MAXLEN];
+  uint32_t size = payload->CopyData (buffer, XGPON_XGEM_FRAME_MAXLEN);
+  XgponAesCtr::Crypt (key->GetRoundKeys (), nonce, counter, buffer, size);
+
+  //an emptied copy keeps the packet tags (e.g., the ones used by flow monitor) of the original payload.
+  Ptr<Packet> result = payload->Copy ();
+  result->RemoveAtStart (size);
+  result->AddAtEnd (Create<Packet> (buffer, size));
+  return result;
+}
+
 
 
 
@@ -115,7 +216,12 @@ XgponXgemRoutines::CreateXgemFrameWithData(const Ptr<Packet>& sdu, uint16_t port
   //Setting Xgem Header
   XgponXgemHeader& xgemHeader = frame->GetXgemHeader();
   xgemHeader.SetPli(sdu->GetSize());
-  xgemHeader.SetKeyIndex(keyIndex);
+  if(key != nullptr && XgponAesCtr::IsEnabled ())
+  {
+    NS_ASSERT_MSG((keyIndex < 3), "The key index cannot be carried by the 2-bit field!!!");
+    xgemHeader.SetKeyIndex(keyIndex + 1);
+  }
+  else xgemHeader.SetKeyIndex(keyIndex);
   xgemHeader.SetXgemPortId(portId);
   xgemHeader.SetOptions(0);
   if(lastFrame)	xgemHeader.SetLastFragmentFlag(1);
@@ -123,7 +229,7 @@ XgponXgemRoutines::CreateXgemFrameWithData(const Ptr<Packet>& sdu, uint16_t port
   xgemHeader.CalculateHec ();
 
   //std::cout << "at Time: " << Simulator::Now().GetNanoSeconds() << ", sdu Size: " << sdu->GetSize() << ", keyIndex: " << keyIndex << ", portId: " << portId << ", lastFrame: " << lastFrame << std::endl; //ja:update:xgspon
-  //ENCRYPTION is omitted for simulation speed.
+  //ENCRYPTION is carried out by the XGEM engine, which knows the position of this frame in the downstream frame (or upstream allocation).
 	
   return frame;	
 }
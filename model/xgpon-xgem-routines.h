@@ -22,6 +22,7 @@
 #define XGPON_XGEM_ENGINE_H
 
 #include <math.h>
+#include <vector>
 
 #include "ns3/object.h"
 #include "ns3/packet.h"
@@ -59,7 +60,7 @@ public:
    * \param device the corresponding xgpon-net-device that is generating this frame. (used for tracing.)
    * \param conn the connection whose data will be transmitted.
    * \param maxLen the available space in XGTC frame or its fair-share of bandwidth to be granted.
-   * \param key the key is used to encrypt the payload of xgem frame (unused in our model).
+   * \param key the key is used to encrypt the payload of xgem frame (the payload is encrypted by the XGEM engine through CryptXgemPayload).
    * \param keyIndex the index of the current key for encryption
    * \param doSegmentation whether to carry out segmentation if SDU is larger than the available space for this connection.
    *        it should be true only when this connection is the last one for the current downstream frame or upstream Allocation.
@@ -80,6 +81,60 @@ public:
    */
   static Ptr<XgponXgemFrame> CreateShortIdleXgemFrame ( );
 
+  /**
+   * \brief create the placeholder of one xgem frame that was lost in the channel (the frame itself may be shared by other receivers).
+   * \return the lost xgem frame (same header and keystream offset, no payload)
+   * \param frame the xgem frame that was lost
+   */
+  static Ptr<XgponXgemFrame> CreateLostXgemFrame (const Ptr<XgponXgemFrame>& frame);
+
+
+
+  /**
+   * \brief write an idle span, i.e., the idle xgem frames that fill the given number of bytes (MAXLEN-long frames, then one shorter frame
+   *        or a short idle frame). Unlike the idle XgponXgemFrame objects, the payload of the last frame is not padded, so that the span is byte-exact.
+   * \param start the position to write
+   * \param size the size of the idle span (unit: byte; a multiple of 4)
+   */
+  static void SerializeIdleSpan (Buffer::Iterator start, uint32_t size);
+
+  /**
+   * \brief read the idle xgem frames at the current position
+   * \return the overall size of these idle frames (0: the next xgem frame carries data)
+   * \param start the position to read
+   * \param maxSize the number of bytes left in the payload. When less than one XGEM header remains, it is a short idle frame.
+   */
+  static uint32_t DeserializeIdleSpan (Buffer::Iterator start, uint32_t maxSize);
+
+
+
+  /**
+   * \brief rebuild one SDU from its segments. The SDU is materialized only once when its last segment is received.
+   * \return the reassembled SDU
+   * \param fragments the segments received before (cleared after reassembling; its capacity is kept for the next SDU)
+   * \param lastFragment the last segment of this SDU
+   *
+   * Note that the segments carried by one downstream frame may be shared by all ONUs. Thus, they are never modified.
+   */
+  static Ptr<Packet> ReassembleSdu (std::vector< Ptr<Packet> >& fragments, const Ptr<Packet>& lastFragment);
+
+
+
+  /**
+   * \brief encrypt (or decrypt) the payload of one XGEM frame with AES-128 in counter mode.
+   * \return the resulting payload. It is a new packet with the packet tags of the original one (byte tags are not kept).
+   * \param payload the payload of one XGEM frame (never modified, since it may be shared by all ONUs)
+   * \param key the key whose key data has been set
+   * \param nonce the superframe counter of the downstream frame (or of the downstream frame carrying the BWmap for upstream)
+   * \param counter the counter of the first keystream block of this payload
+   */
+  static Ptr<Packet> CryptXgemPayload (const Ptr<Packet>& payload, const Ptr<XgponKey>& key, uint64_t nonce, uint64_t counter);
+
+  /**
+   * \return whether the payload of one XGEM frame is encrypted, i.e., encryption is enabled and its key index is not 0.
+   */
+  static bool IsPayloadEncrypted (const XgponXgemHeader& header);
+
 
 
 private:
@@ -89,13 +144,23 @@ private:
    * \param sdu the SDU (may be a segment)
    * \param portId XGEM port that this packet belongs to
    * \param key the key used to encrypt the payload of XGEM frame
-   * \param keyIndex the index of the current key for encryption
+   * \param keyIndex the index of the current key for encryption. When encryption is enabled, it is carried as keyIndex+1 (0: not encrypted; ITU-T G.987.3).
    * \param lastFrame whether its the last part of one SDU.
    */
   static Ptr<XgponXgemFrame> CreateXgemFrameWithData(const Ptr<Packet>& sdu, uint16_t portId, const Ptr<XgponKey>& key, uint8_t keyIndex, bool lastFrame);
 
 };
 
+
+
+
+////////////////////////////////////////////////////INLINE Functions
+inline bool
+XgponXgemRoutines::IsPayloadEncrypted (const XgponXgemHeader& header)
+{
+  return XgponAesCtr::IsEnabled () && (header.GetKeyIndex () > 0);
+}
+
 }; // namespace ns3
 
 #endif // XGPON_XGEM_ENGINE_H
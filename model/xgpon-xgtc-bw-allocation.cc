@@ -95,11 +95,7 @@ XgponXgtcBwAllocation::~XgponXgtcBwAllocation ()
 uint64_t
 XgponXgtcBwAllocation::GetSerializedAllocation (void)
 {
-  uint64_t sAlloc=m_allocId;
-  sAlloc=(sAlloc<<2)|(m_dbru<<1)|m_ploamu;
-  sAlloc=(sAlloc<<16)|m_startTime;
-  sAlloc=(sAlloc<<16)|m_grantSize;
-  sAlloc=(sAlloc<<3)|(m_fwi<<2)|m_burstProfile;
+  uint64_t sAlloc=GetProtectedBits ();
   sAlloc=(sAlloc<<13)|m_hec;
   return sAlloc;  
 }
@@ -231,11 +227,7 @@ XgponXgtcBwAllocation::GetSerializedSize (void) const
 void 
 XgponXgtcBwAllocation::Serialize (Buffer::Iterator start) const
 {
-  uint64_t sAlloc=m_allocId;
-  sAlloc=(sAlloc<<2)|(m_dbru<<1)|m_ploamu;
-  sAlloc=(sAlloc<<16)|m_startTime;
-  sAlloc=(sAlloc<<16)|m_grantSize;
-  sAlloc=(sAlloc<<3)|(m_fwi<<2)|m_burstProfile;
+  uint64_t sAlloc=GetProtectedBits ();
   sAlloc=(sAlloc<<13)|m_hec;
 
   start.WriteHtonU64 (sAlloc);
@@ -30,6 +30,8 @@
 #include "ns3/simple-ref-count.h"
 #include "ns3/buffer.h"
 
+#include "xgpon-integrity.h"
+
 
 namespace ns3 {
 
@@ -151,6 +153,9 @@ private:
   uint8_t   m_burstProfile;   //the index of burst profile used by physical adaptation sub-layer. Len: 2 bits
   uint16_t  m_hec;            //for the purpose of error detection and correction purpose. Len: 13 bits
 
+  //the 51 bits protected by HEC
+  uint64_t GetProtectedBits () const;
+
 
   //////////////META-data. unit: nanosecond. used to clear history. 
   //Note that receive time may be different for various ONUs and is changed multiple times. 
@@ -257,15 +262,28 @@ XgponXgtcBwAllocation::GetBurstProfileIndex () const
 }
 
 
+inline uint64_t 
+XgponXgtcBwAllocation::GetProtectedBits () const
+{
+  uint64_t sAlloc=m_allocId;
+  sAlloc=(sAlloc<<2)|(m_dbru<<1)|m_ploamu;
+  sAlloc=(sAlloc<<16)|m_startTime;
+  sAlloc=(sAlloc<<16)|m_grantSize;
+  sAlloc=(sAlloc<<3)|(m_fwi<<2)|m_burstProfile;
+  return sAlloc;
+}
+
 inline void 
 XgponXgtcBwAllocation::CalculateHec ()
 {
-  //leave blank for saving CPU.
+  //leave blank for saving CPU unless integrity fields are enabled.
+  if(XgponIntegrity::IsEnabled ()) m_hec = XgponIntegrity::CalculateHec (GetProtectedBits (), 51);
 }
 inline bool 
 XgponXgtcBwAllocation::VerifyHec () const
 {
-  return true;
+  if(!XgponIntegrity::IsEnabled ()) return true;
+  return m_hec == XgponIntegrity::CalculateHec (GetProtectedBits (), 51);
 }
 
 
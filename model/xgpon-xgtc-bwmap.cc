@@ -37,7 +37,7 @@ bool XgponXgtcBwmap::m_poolEnabled = true;
 
 
 XgponXgtcBwmap::XgponXgtcBwmap ()
-  : meta_allocationNumber (0), meta_creationTime (0)
+  : meta_allocationNumber (0), meta_creationTime (0), meta_sfc (0)
 {
   //m_bwAllocations.reserve(XgponOltDbaEngine::MAX_ALLOCID_PER_BWMAP+1);  
   /*
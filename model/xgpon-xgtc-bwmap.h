@@ -76,6 +76,10 @@ public:
   void SetCreationTime (uint64_t time);
   uint64_t GetCreationTime ( ) const;
 
+  //superframe counter of the downstream frame carrying this map. It is the nonce used to encrypt the upstream bursts scheduled by this map.
+  void SetSfc (uint64_t sfc);
+  uint64_t GetSfc ( ) const;
+
 
   //called by the receiver (ONU) to carry out deserialization
   void SetNumberOfBwAllocation (uint16_t num); 
@@ -112,6 +116,9 @@ private:
                                    //This field is used by OLT to associate the received upstream burst and its corresponding BW-MAP.
                                    //OLT needs the information in BW-MAP to parse the received burst, such as whether PLOAM message and DBRu exist.
 
+  uint64_t meta_sfc;               //META-data: the superframe counter of the downstream frame carrying this map. It will not be serialized.
+                                   //It is set by OLT when the frame is produced and by ONU when the frame is received.
+
 
 
 
@@ -143,6 +150,19 @@ XgponXgtcBwmap::GetCreationTime ( ) const
 
 
 
+inline void
+XgponXgtcBwmap::SetSfc (uint64_t sfc)
+{
+  meta_sfc = sfc;
+}
+inline uint64_t
+XgponXgtcBwmap::GetSfc ( ) const
+{
+  return meta_sfc;
+}
+
+
+
 inline void 
 XgponXgtcBwmap::SetNumberOfBwAllocation (uint16_t num)
 {
@@ -153,13 +153,17 @@ uint32_t XgponXgtcDbru::GetSerializedSize (void) const
 
 void XgponXgtcDbru::Serialize (Buffer::Iterator start) const
 {
-  //leave alone in first phase
+  start.WriteHtonU32 ((m_bufOcc << 8) | m_crc);
   return;
 }
 
 uint32_t XgponXgtcDbru::Deserialize (Buffer::Iterator start)
 {
-  //leave alone in first phase
+  uint32_t rst = start.ReadNtohU32 ();
+  m_bufOcc = (rst >> 8) & 0x00ffffff;
+  m_crc = rst & 0xff;
+
+  //VerifyCrc ();
   return GetSerializedSize ();
 }
 
@@ -21,6 +21,8 @@
 #include "ns3/log.h"
 
 #include "xgpon-xgtc-ds-frame.h"
+#include "xgpon-xgem-routines.h"
+#include "xgpon-aes-ctr.h"
 
 
 
@@ -30,7 +32,7 @@ NS_LOG_COMPONENT_DEFINE ("XgponXgtcDsFrame");
 namespace ns3 {
 
 XgponXgtcDsFrame::XgponXgtcDsFrame ()
-  :m_burst (0), m_broadcastBurst(0), meta_burstSize (0), m_bitmap(1024, 0) 
+  :m_burst (0), m_broadcastBurst(0), m_idleSpan (0), meta_burstSize (0), meta_broadcastFrameNum (0), m_deliverToAll(false) 
 {
   m_burst.reserve(XGPON1_MAX_XGEM_FRAMES_PER_DS_FRAME);
   m_broadcastBurst.reserve(XGPON1_MAX_BROADCAST_XGEM_FRAMES_PER_DS_FRAME);
@@ -78,6 +80,8 @@ XgponXgtcDsFrame::Print (std::ostream &os)  const
     i++;
   }
 
+  os << " IDLE-SPAN= " << m_idleSpan;
+
   os << std::endl;
 
   return;
@@ -92,49 +96,87 @@ uint32_t XgponXgtcDsFrame::GetSerializedSize (void) const
   std::vector<Ptr<XgponXgemFrame> >::const_iterator it, end;
   it = m_broadcastBurst.begin();
   end = m_broadcastBurst.end();
-  while(it!=end) { len += (*it)->GetSerializedSize (); }
+  while(it!=end) { len += (*it)->GetSerializedSize (); it++; }
 
 
   it = m_burst.begin();
   end = m_burst.end();
-  while(it!=end) { len += (*it)->GetSerializedSize (); }
+  while(it!=end) { len += (*it)->GetSerializedSize (); it++; }
 
+  len += m_idleSpan;
 
   return len;
 }
 
 void XgponXgtcDsFrame::Serialize (Buffer::Iterator start) const
 {
-  std::vector<Ptr<Packet> >::const_iterator iteratorSerialize, end;
-
-  m_header.Serialize(start);
-
-  //TODO: packet burst serialization;
-  //iteratorSerialize = m_burst.Begin();
-  //end = m_burst.End();
-  //while (iteratorSerialize != end)
-  //{
-  //  (*iteratorSerialize)->Serialize(start);
-  //  iteratorSerialize++;
-  //}
+  Buffer::Iterator i = start;
+
+  m_header.Serialize(i);
+  i.Next(m_header.GetSerializedSize());
+
+  //broadcast xgem frames are put before the unicast ones.
+  std::vector<Ptr<XgponXgemFrame> >::const_iterator iteratorSerialize, end;
+  iteratorSerialize = m_broadcastBurst.begin();
+  end = m_broadcastBurst.end();
+  while (iteratorSerialize != end)
+  {
+    (*iteratorSerialize)->Serialize(i);
+    i.Next((*iteratorSerialize)->GetSerializedSize());
+    iteratorSerialize++;
+  }
+
+  iteratorSerialize = m_burst.begin();
+  end = m_burst.end();
+  while (iteratorSerialize != end)
+  {
+    (*iteratorSerialize)->Serialize(i);
+    i.Next((*iteratorSerialize)->GetSerializedSize());
+    iteratorSerialize++;
+  }
+
+  if(m_idleSpan > 0) XgponXgemRoutines::SerializeIdleSpan (i, m_idleSpan);
   return;
 }
 
 
 uint32_t XgponXgtcDsFrame::Deserialize (Buffer::Iterator start)
 {
-  //uint32_t size;
-
-  //size = m_header.Deserialize(start);
-
-  //TODO: packet burst deserialization;  
-  //while (size < meta_burstSize)
-  //{
-  //  Ptr<Packet> pkt = Create<Packet>();
-  //  size = size + pkt->Deserialize(start);
-  //  AddPacket(pkt);
-  //}
-  return GetSerializedSize ();
+  NS_ASSERT_MSG((meta_burstSize > 0), "The burst size must be set before deserialization!!!");
+
+  Buffer::Iterator i = start;
+  uint32_t size = m_header.Deserialize(i);
+  i.Next(size);
+
+  uint32_t frameNum = 0;
+  uint64_t keystreamOffset = 0;   //the keystream blocks of the unicast XGEM frames are laid one after another (see XgponOltXgemEngine).
+  while (size < meta_burstSize)
+  {
+    //idle xgem frames are not materialized; only their size is counted.
+    uint32_t idleSize = XgponXgemRoutines::DeserializeIdleSpan (i, meta_burstSize - size);
+    if(idleSize > 0)
+    {
+      m_idleSpan += idleSize;
+      size += idleSize;
+      i.Next(idleSize);
+      continue;
+    }
+
+    Ptr<XgponXgemFrame> frame = Create<XgponXgemFrame>();
+    i.Next(frame->Deserialize(i));
+    size += frame->GetSerializedSize();
+
+    //the first frames are broadcast ones (see Serialize).
+    if(frameNum < meta_broadcastFrameNum) AddBroadcastXgemFrame(frame);
+    else 
+    {
+      frame->SetKeystreamOffset (keystreamOffset);
+      keystreamOffset += XgponAesCtr::GetNumberOfBlocks ((frame->GetXgemHeader()).GetPli());
+      AddUnicastXgemFrame(frame);
+    }
+    frameNum++;
+  }
+  return size;
 }
 
 }; // namespace ns3
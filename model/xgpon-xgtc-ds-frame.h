@@ -25,6 +25,7 @@
 
 #include "xgpon-xgem-frame.h"
 #include "xgpon-xgtc-ds-header.h"
+#include "xgpon-onu-id-set.h"
 
 
 
@@ -47,6 +48,8 @@ class XgponXgtcDsFrame
   const static uint32_t XGPON1_MAX_BROADCAST_XGEM_FRAMES_PER_DS_FRAME = 400; 
 
 public:
+  const static uint16_t XGPON_BROADCAST_ONU_ID = 0x03FF;   //ONU-ID used by PLOAM messages broadcast to all ONUs
+
   /**
    * \brief Constructor
    */
@@ -91,13 +94,58 @@ public:
   uint32_t GetNBroadcastXgemFrames (void) const;
 
 
+  /**
+   * \brief add idle bytes at the end of the payload. They are kept as one counter instead of idle xgem frames.
+   * \param size the number of idle bytes (unit: byte)
+   */
+  void AddIdleSpan (uint32_t size);
+
+  /**
+   * \return the number of idle bytes at the end of the payload
+   */
+  uint32_t GetIdleSpan (void) const;
+
+
+
+
+
+  /**
+   * \return the set of ONUs that are served in the unicast xgem frames of this downstream frame
+   */
+  XgponOnuIdSet& GetServedOnus (void);
+
+  /**
+   * \return whether the ONU is served in the unicast xgem frames of this downstream frame
+   */
+  bool IsOnuServed (uint16_t onuId) const;
+
+
 
+  ////////////////////////////////////////////delivery filter: which ONUs have anything (data, grant, PLOAM, broadcast) in this frame
+  /**
+   * \brief mark one ONU as a receiver of this frame
+   */
+  void MarkOnuForDelivery (uint16_t onuId);
 
+  /**
+   * \brief mark all ONUs as receivers of this frame (broadcast content)
+   */
+  void MarkAllOnusForDelivery (void);
 
   /**
-   * \return the bitmap that specifies which onu is served in this downstream frame
+   * \return whether the ONU has to receive and parse this frame
    */
-  std::vector<uint8_t>& GetBitmap (void);
+  bool IsDeliveryRequired (uint16_t onuId) const;
+
+  /**
+   * \return the ONUs marked as receivers of this frame (those served in the unicast xgem frames are not included)
+   */
+  const XgponOnuIdSet& GetDeliveryOnus (void) const;
+
+  /**
+   * \return whether all ONUs have been marked as receivers of this frame
+   */
+  bool IsDeliveredToAll (void) const;
 
 
 
@@ -112,6 +160,10 @@ public:
   //the parameter is the overall size of the xgtc downstream frame
   void SetBurstSize (uint32_t size);  
 
+  //called by the receiver to tell how many xgem frames (at the beginning of the payload) are broadcast ones.
+  //The air interface has no such field; it is carried together with the frame when it is passed between simulator instances.
+  void SetBroadcastXgemFrameNumber (uint32_t num);
+
 
 
 
@@ -128,12 +180,20 @@ private:
 
   std::vector<Ptr<XgponXgemFrame> > m_broadcastBurst;  //The list of xgem frames for broadcast traffics. vector + reservation are used to save CPU.
 
+  uint32_t m_idleSpan;                                 //the idle bytes (idle xgem frames) that fill the rest of the payload.
+
   XgponXgtcDsHeader m_header;
 
   //META-data: the burst size (header included) set by the receiver. It is used to determine the end of deserialization.
   uint32_t  meta_burstSize;  
 
-  std::vector<uint8_t> m_bitmap;                      //The bitmap used to specify which onu is served in the unicast xgem frames;
+  //META-data: the number of broadcast xgem frames set by the receiver before deserialization.
+  uint32_t  meta_broadcastFrameNum;
+
+  XgponOnuIdSet m_servedOnus;                         //The ONUs served in the unicast xgem frames;
+
+  XgponOnuIdSet m_deliveryOnus;                       //The other ONUs that have something (grant, PLOAM) in this frame. Filled by the OLT for the delivery filter of the channel;
+  bool m_deliverToAll;                                //true: this frame has broadcast content and must be received by all ONUs;
 
 };
 
@@ -155,6 +215,13 @@ XgponXgtcDsFrame::SetBurstSize (uint32_t size)
 }
 
 
+inline void 
+XgponXgtcDsFrame::SetBroadcastXgemFrameNumber (uint32_t num)
+{
+  meta_broadcastFrameNum = num;
+}
+
+
 inline void 
 XgponXgtcDsFrame::AddUnicastXgemFrame (const Ptr<XgponXgemFrame>& frame)
 {
@@ -191,14 +258,64 @@ XgponXgtcDsFrame::GetNUnicastXgemFrames (void) const
 inline uint32_t 
 XgponXgtcDsFrame::GetNBroadcastXgemFrames (void) const
 {
-  return m_burst.size();
+  return m_broadcastBurst.size();
+}
+
+
+inline void 
+XgponXgtcDsFrame::AddIdleSpan (uint32_t size)
+{
+  m_idleSpan += size;
+}
+
+inline uint32_t 
+XgponXgtcDsFrame::GetIdleSpan (void) const
+{
+  return m_idleSpan;
+}
+
+
+inline XgponOnuIdSet& 
+XgponXgtcDsFrame::GetServedOnus (void)
+{
+  return m_servedOnus;
 }
 
+inline bool
+XgponXgtcDsFrame::IsOnuServed (uint16_t onuId) const
+{
+  return m_servedOnus.Contains (onuId);
+}
+
+
+inline void 
+XgponXgtcDsFrame::MarkOnuForDelivery (uint16_t onuId)
+{
+  m_deliveryOnus.Add (onuId);
+}
+
+inline void 
+XgponXgtcDsFrame::MarkAllOnusForDelivery (void)
+{
+  m_deliverToAll = true;
+}
+
+inline bool 
+XgponXgtcDsFrame::IsDeliveryRequired (uint16_t onuId) const
+{
+  return (m_deliverToAll || m_servedOnus.Contains (onuId) || m_deliveryOnus.Contains (onuId));
+}
+
+inline const XgponOnuIdSet& 
+XgponXgtcDsFrame::GetDeliveryOnus (void) const
+{
+  return m_deliveryOnus;
+}
 
-inline std::vector<uint8_t>& 
-XgponXgtcDsFrame::GetBitmap (void)
+inline bool 
+XgponXgtcDsFrame::IsDeliveredToAll (void) const
 {
-  return m_bitmap;
+  return m_deliverToAll;
 }
 
 
@@ -40,6 +40,21 @@ XgponXgtcDsHeader::~XgponXgtcDsHeader ()
 
 
 
+void 
+XgponXgtcDsHeader::CalculateHec ()
+{
+  //leave blank for saving CPU unless integrity fields are enabled.
+  if(!XgponIntegrity::IsEnabled ()) return;
+
+  uint32_t bwmapLen = m_bwmap->GetNumberOfBwAllocation();
+  for(uint32_t i=0; i<bwmapLen; i++) { m_bwmap->GetBwAllocationByIndex(i)->CalculateHec (); }
+
+  m_hec = XgponIntegrity::CalculateHec ((bwmapLen << 8) | m_ploams.size(), 19);
+}
+
+
+
+
 
 
 void
@@ -108,10 +123,12 @@ void XgponXgtcDsHeader::Serialize (Buffer::Iterator start) const
   {
     tmpBwAllocation=m_bwmap->GetBwAllocationByIndex(i);
     tmpBwAllocation->Serialize(start);
+    start.Next(tmpBwAllocation->GetSerializedSize());  //the iterator is passed by value
   }
   for(i=0;i<m_ploamCount2;i++)
   {
     m_ploams[i]->Serialize(start);
+    start.Next(m_ploams[i]->GetSerializedSize());
   }
   
   return;
@@ -134,6 +151,8 @@ uint32_t XgponXgtcDsHeader::Deserialize (Buffer::Iterator start)
   
   //std::cout<<"In deserialize -> Bw map len: "<<m_bwmapLen<<"Ploam count: "<<m_ploamCount<<std::endl;
 
+  if(m_bwmap == nullptr) m_bwmap = Create<XgponXgtcBwmap>();
+
   for(i=0;i<m_bwmapLen;i++)
   {
     serializedAllocation=start.ReadNtohU64();
@@ -143,7 +162,7 @@ uint32_t XgponXgtcDsHeader::Deserialize (Buffer::Iterator start)
   {
     //std::cout<<"Ploam count again: "<<m_ploamCount<<std::endl;
     ploam=Create<XgponXgtcPloam>();
-    ploam->Deserialize(start);
+    start.Next(ploam->Deserialize(start));
     AddPloam(ploam);
   }
 
@@ -25,6 +25,7 @@
 
 #include "xgpon-xgtc-bwmap.h"
 #include "xgpon-xgtc-ploam.h"
+#include "xgpon-integrity.h"
 
 
 
@@ -60,6 +61,10 @@ public:
   uint32_t GetBwMapLen () const;
  
 
+  /**
+   * \brief calculate HEC of this header and of the allocation structures in BwMap (when integrity fields are enabled). 
+   *        It should be called after BwMap and PLOAM messages are added.
+   */
   void CalculateHec ();
   bool VerifyHec () const;
 
@@ -133,16 +138,12 @@ XgponXgtcDsHeader::GetBwMapLen () const
 
 
 
-inline void 
-XgponXgtcDsHeader::CalculateHec ()
-{
-  //leave blank for saving CPU
-  return;
-}
 inline bool 
 XgponXgtcDsHeader::VerifyHec () const
 {
-  return true;
+  if(!XgponIntegrity::IsEnabled ()) return true;
+  //like CalculateHec, the lengths are taken from the BWmap and PLOAM list (m_bwmapLen and m_ploamCount are only set by Deserialize).
+  return m_hec == XgponIntegrity::CalculateHec ((m_bwmap->GetNumberOfBwAllocation() << 8) | m_ploams.size(), 19);
 }
 
 
@@ -21,6 +21,8 @@
 #include "ns3/log.h"
 
 #include "xgpon-xgtc-us-allocation.h"
+#include "xgpon-xgem-routines.h"
+#include "xgpon-aes-ctr.h"
 
 
 
@@ -36,7 +38,7 @@ bool XgponXgtcUsAllocation::m_poolEnabled = true;
 
 
 XgponXgtcUsAllocation::XgponXgtcUsAllocation ()
-  : m_burst(0), m_dbru(0), meta_dbruExist (false)
+  : m_burst(0), m_idleSpan(0), m_dbru(0), meta_dbruExist (false), meta_allocationSize (0)
 {
   /*
   CREATED_USALLOC_NUM4DEBUG++;
@@ -143,6 +145,8 @@ XgponXgtcUsAllocation::Print (std::ostream &os)  const
     i++;
   }
 
+  os << " IDLE-SPAN= " << m_idleSpan;
+
   os << std::endl;
 
   return;
@@ -155,7 +159,9 @@ uint32_t XgponXgtcUsAllocation::GetSerializedSize (void) const
   std::vector<Ptr<XgponXgemFrame> >::const_iterator it, end;
   it = m_burst.begin();
   end = m_burst.end();
-  while(it!=end) { len += (*it)->GetSerializedSize(); }
+  while(it!=end) { len += (*it)->GetSerializedSize(); it++; }
+
+  len += m_idleSpan;
 
   if(meta_dbruExist == true) len = len + m_dbru->GetSerializedSize();
 
@@ -164,18 +170,66 @@ uint32_t XgponXgtcUsAllocation::GetSerializedSize (void) const
 
 void XgponXgtcUsAllocation::Serialize (Buffer::Iterator start) const
 {
-  //TODO: serialization;
-  //if(meta_dbruExist == true) m_dbru->Serialize(start);
+  Buffer::Iterator i = start;
+
+  if(meta_dbruExist == true) 
+  {
+    m_dbru->Serialize(i);
+    i.Next(m_dbru->GetSerializedSize());
+  }
+
   //packet burst serialization;
+  std::vector<Ptr<XgponXgemFrame> >::const_iterator it, end;
+  it = m_burst.begin();
+  end = m_burst.end();
+  while(it!=end) 
+  { 
+    (*it)->Serialize(i);
+    i.Next((*it)->GetSerializedSize());
+    it++; 
+  }
+
+  if(m_idleSpan > 0) XgponXgemRoutines::SerializeIdleSpan (i, m_idleSpan);
   return;
 }
 
 uint32_t XgponXgtcUsAllocation::Deserialize (Buffer::Iterator start)
 {
-  //TODO: deserialization;
-  //if(meta_dbruExist == true) m_dbru->Deserialize(start);
+  NS_ASSERT_MSG((meta_allocationSize > 0), "The allocation size must be set before deserialization!!!");
+
+  Buffer::Iterator i = start;
+  uint32_t size = 0;
+
+  if(meta_dbruExist == true) 
+  {
+    m_dbru = Create<XgponXgtcDbru>();
+    size = m_dbru->Deserialize(i);
+    i.Next(size);
+  }
+
   //packet burst deserialization;
-  return GetSerializedSize ();
+  uint64_t keystreamOffset = 0;   //the keystream blocks of the XGEM frames are laid one after another (see XgponOnuXgemEngine).
+  while (size < meta_allocationSize)
+  {
+    //idle xgem frames are not materialized; only their size is counted.
+    uint32_t idleSize = XgponXgemRoutines::DeserializeIdleSpan (i, meta_allocationSize - size);
+    if(idleSize > 0)
+    {
+      m_idleSpan += idleSize;
+      size += idleSize;
+      i.Next(idleSize);
+      continue;
+    }
+
+    Ptr<XgponXgemFrame> frame = Create<XgponXgemFrame>();
+    i.Next(frame->Deserialize(i));
+    size += frame->GetSerializedSize();
+
+    frame->SetKeystreamOffset (keystreamOffset);
+    keystreamOffset += XgponAesCtr::GetNumberOfBlocks ((frame->GetXgemHeader()).GetPli());
+    AddXgemFrame(frame);
+  }
+  return size;
 }
 
 }; // namespace ns3
@@ -86,6 +86,18 @@ public:
   uint32_t GetNXgemFrames (void) const;
 
 
+  /**
+   * \brief add idle bytes at the end of this US-ALLOCATION. They are kept as one counter instead of idle xgem frames.
+   * \param size the number of idle bytes (unit: byte)
+   */
+  void AddIdleSpan (uint32_t size);
+
+  /**
+   * \return the number of idle bytes at the end of this US-ALLOCATION
+   */
+  uint32_t GetIdleSpan (void) const;
+
+
 
 
 
@@ -100,6 +112,9 @@ public:
   //OLT determines its existence based on the corresponding bwalloc.
   void SetDbruExist (bool exist);
 
+  //called by the receiver (OLT) based on the grant size of the corresponding bwalloc for the purpose of deserialization. unit: byte (DBRu included)
+  void SetAllocationSize (uint32_t size);
+
 
 
 
@@ -122,11 +137,13 @@ public:
 
 private:
   std::vector<Ptr<XgponXgemFrame> > m_burst;  //The list of packets
+  uint32_t m_idleSpan;                         //the idle bytes (idle xgem frames) that fill the rest of this allocation.
 
   Ptr<XgponXgtcDbru> m_dbru;   //Buffer occupancy report from ONU for the corresponding alloc-id.
                                //the existence of this reported is determined by BW map in the corresponding downstream frame.
 
   bool meta_dbruExist;         //Whether Dbru exist in this allocation; used for desrialization
+  uint32_t meta_allocationSize; //The size (unit: byte) of this allocation; used for desrialization
 
 
 
@@ -164,6 +181,18 @@ XgponXgtcUsAllocation::GetNXgemFrames (void) const
   return m_burst.size();
 }
 
+inline void 
+XgponXgtcUsAllocation::AddIdleSpan (uint32_t size)
+{
+  m_idleSpan += size;
+}
+
+inline uint32_t 
+XgponXgtcUsAllocation::GetIdleSpan (void) const
+{
+  return m_idleSpan;
+}
+
 
 
 
@@ -197,6 +226,12 @@ XgponXgtcUsAllocation::SetDbruExist (bool exist)
   meta_dbruExist = exist;
 }
 
+inline void 
+XgponXgtcUsAllocation::SetAllocationSize (uint32_t size)
+{
+  meta_allocationSize = size;
+}
+
 
 
 
@@ -20,7 +20,10 @@
 
 #include "ns3/log.h"
 
+#include "ns3/buffer.h"
+
 #include "xgpon-xgtc-us-burst.h"
+#include "xgpon-integrity.h"
 
 
 
@@ -31,7 +34,7 @@ NS_LOG_COMPONENT_DEFINE ("XgponXgtcUsBurst");
 namespace ns3 {
 
 XgponXgtcUsBurst::XgponXgtcUsBurst ()
-  : m_header (), m_allocations (0), m_trailer (0)
+  : m_header (), m_allocations (0), m_trailer (0), meta_bip (0), meta_bipCalculated (false)
 {
   //m_allocations.reserve(100);
 }
@@ -76,6 +79,34 @@ XgponXgtcUsBurst::Print (std::ostream &os)  const
   return;
 }
 
+void 
+XgponXgtcUsBurst::CalculateTrailer ()
+{
+  //leave alone for saving CPU unless integrity fields are enabled.
+  if(!XgponIntegrity::IsEnabled ()) return;
+
+  m_trailer = meta_bip = CalculateBip32 ();
+  meta_bipCalculated = true;
+}
+
+bool 
+XgponXgtcUsBurst::VerifyTrailer () const
+{
+  if(!XgponIntegrity::IsEnabled ()) return true;
+  return m_trailer == (meta_bipCalculated ? meta_bip : CalculateBip32 ());
+}
+
+uint32_t 
+XgponXgtcUsBurst::CalculateBip32 () const
+{
+  uint32_t len = GetSerializedSize ();
+  Buffer buffer;
+  buffer.AddAtStart (len);
+  Serialize (buffer.Begin ());
+
+  return XgponIntegrity::CalculateBip32 (buffer.PeekData (), len - 4);  //the trailer itself is excluded
+}
+
 uint32_t XgponXgtcUsBurst::GetSerializedSize (void) const
 {
   uint32_t i, len, allocNum;
@@ -93,14 +124,42 @@ uint32_t XgponXgtcUsBurst::GetSerializedSize (void) const
 
 void XgponXgtcUsBurst::Serialize (Buffer::Iterator start) const
 {
-  //TODO: serialization;
+  Buffer::Iterator i = start;
+
+  m_header.Serialize(i);
+  i.Next(m_header.GetSerializedSize());
+
+  uint32_t allocNum = m_allocations.size();
+  for(uint32_t j=0; j<allocNum; j++)
+  {
+    m_allocations[j]->Serialize(i);
+    i.Next(m_allocations[j]->GetSerializedSize());
+  }
+
+  i.WriteHtonU32(m_trailer);
   return;
 }
 
 uint32_t XgponXgtcUsBurst::Deserialize (Buffer::Iterator start)
 {
-  //TODO: deserialization;
-  return GetSerializedSize ();
+  //Like OLT does based on the BW map, the receiver must have added the US allocations (DBRu existence and size set) 
+  //and set PLOAM existence in the header before this call.
+  Buffer::Iterator i = start;
+
+  uint32_t len = m_header.Deserialize(i);
+  i.Next(len);
+
+  uint32_t allocNum = m_allocations.size();
+  for(uint32_t j=0; j<allocNum; j++)
+  {
+    uint32_t allocLen = m_allocations[j]->Deserialize(i);
+    i.Next(allocLen);
+    len += allocLen;
+  }
+
+  m_trailer = i.ReadNtohU32();
+  meta_bipCalculated = false;   //the bytes may differ from the ones of the sender
+  return len + 4;
 }
 
 }; // namespace ns3
@@ -63,9 +63,13 @@ public:
 
 
   /**
-   * \brief trailer related operations. leave BLANK for saving CPU.
+   * \brief trailer related operations. BIP-32 over the whole burst is calculated only when integrity fields are enabled (for saving CPU).
+   *        VerifyTrailer returns true when integrity fields are disabled. The BIP-32 calculated by CalculateTrailer is kept
+   *        as meta-data, so that a burst delivered within this simulator instance is verified without being serialized again;
+   *        a deserialized burst (e.g., from another MPI rank) is serialized to calculate it.
    */  
   void CalculateTrailer ();
+  bool VerifyTrailer () const;
   uint32_t GetTrailer () const;
 
 
@@ -79,10 +83,16 @@ public:
 
 
 private:
+  //BIP-32 over the serialized burst without the trailer
+  uint32_t CalculateBip32 () const;
+
   XgponXgtcUsHeader m_header;
   std::deque< Ptr<XgponXgtcUsAllocation> > m_allocations;
 
   uint32_t m_trailer;  //used to estimate BER; when FEC is used, BER should be estimated based on FEC decoding result.
+
+  uint32_t meta_bip;        //META-data: the BIP-32 calculated by CalculateTrailer. It will not be serialized.
+  bool meta_bipCalculated;  //META-data: whether meta_bip is valid (false after Deserialize).
 };
 
 
@@ -118,12 +128,6 @@ XgponXgtcUsBurst::GetHeader ()
   return m_header;
 }
 
-inline void 
-XgponXgtcUsBurst::CalculateTrailer ()
-{
-  //leave alone for saving CPU
-  return;
-}
 inline uint32_t 
 XgponXgtcUsBurst::GetTrailer () const
 {
@@ -99,11 +99,13 @@ uint32_t XgponXgtcUsHeader::Deserialize (Buffer::Iterator start)
   rst = start.ReadNtohU32();
   m_onuId = rst >> 22;
   m_ind = (rst >> 13) & 0x1ff;
-  m_hec = rst & 0x1fff;
+  m_hec = rst & 0x1fff;   //verified by XgponOltPhyAdapter before the burst is parsed
 
-  //VerifyHec ();
-
-  if(meta_ploamExist == true) m_ploam->Deserialize(start);
+  if(meta_ploamExist == true) 
+  {
+    if(m_ploam == nullptr) m_ploam = Create<XgponXgtcPloam>();
+    m_ploam->Deserialize(start);
+  }
 
   return GetSerializedSize ();
 }
@@ -25,6 +25,8 @@
 
 #include "ns3/xgpon-xgtc-ploam.h"
 
+#include "xgpon-integrity.h"
+
 
 
 namespace ns3 {
@@ -187,12 +189,14 @@ inline void XgponXgtcUsHeader::SetPloamExist (bool exist)
 inline void 
 XgponXgtcUsHeader::CalculateHec () 
 {
-  //leave blank for saving CPU.
+  //leave blank for saving CPU unless integrity fields are enabled.
+  if(XgponIntegrity::IsEnabled ()) m_hec = XgponIntegrity::CalculateHec ((m_onuId << 9) | m_ind, 19);
 }
 inline bool 
 XgponXgtcUsHeader::VerifyHec () const
 {
-  return true;
+  if(!XgponIntegrity::IsEnabled ()) return true;
+  return m_hec == XgponIntegrity::CalculateHec ((m_onuId << 9) | m_ind, 19);
 }
 
 
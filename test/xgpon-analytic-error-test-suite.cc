@@ -0,0 +1,151 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2012 University College Cork (UCC), Ireland
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jerome Arokkiam <jerome.arokkia@bt.com>
+ */
+
+/*
+ * The analytic error model of XgponChannel ("AnalyticErrorModel") has to use the bit error rate set for one ONU
+ * (XgponHelper::SetOnuBitErrorRate) in both directions. The OLT keeps its own copy of the link info of each ONU,
+ * so the upstream bursts are checked at the OLT phy adapter: with a bit error rate of 0.5, every unprotected codeword
+ * is lost (the burst header too); with 0, nothing is lost, whatever the rate of the channel is.
+ */
+
+#include <sstream>
+#include <string>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/test.h"
+
+#include "ns3/xgpon-helper.h"
+#include "ns3/xgpon-config-db.h"
+
+#include "ns3/xgpon-onu-net-device.h"
+#include "ns3/xgpon-olt-net-device.h"
+
+
+using namespace ns3;
+
+
+/**
+ * \brief the upstream bursts of two ONUs, one with its own bit error rate and one with the rate of the channel
+ */
+class XgponAnalyticErrorUpstreamTestCase : public TestCase
+{
+public:
+  XgponAnalyticErrorUpstreamTestCase (double channelBer, double onuBer);
+
+private:
+  static std::string GetTestName (double channelBer, double onuBer);
+
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  //whether one upstream burst (header and trailer only) of this ONU is received by the OLT
+  bool ReceiveBurst (const Ptr<XgponOltNetDevice>& oltDevice, const Ptr<XgponOnuNetDevice>& onuDevice);
+
+  double m_channelBer;
+  double m_onuBer;
+
+  static const uint32_t N_BURSTS = 20;
+};
+
+
+XgponAnalyticErrorUpstreamTestCase::XgponAnalyticErrorUpstreamTestCase (double channelBer, double onuBer)
+  : TestCase (GetTestName (channelBer, onuBer)),
+    m_channelBer (channelBer),
+    m_onuBer (onuBer)
+{
+}
+
+
+std::string
+XgponAnalyticErrorUpstreamTestCase::GetTestName (double channelBer, double onuBer)
+{
+  std::ostringstream name;
+  name << "Upstream loss with the bit error rate " << onuBer << " of one ONU (channel: " << channelBer << ")";
+  return name.str ();
+}
+
+
+bool
+XgponAnalyticErrorUpstreamTestCase::ReceiveBurst (const Ptr<XgponOltNetDevice>& oltDevice, const Ptr<XgponOnuNetDevice>& onuDevice)
+{
+  Ptr<XgponUsBurst> burst = Create<XgponUsBurst> ();
+  burst->GetXgtcUsBurst ().GetHeader ().SetOnuId (onuDevice->GetOnuId ());
+
+  Ptr<XgponBurstProfile> profile = CreateObject<XgponBurstProfile> ();
+  profile->SetFec (false);
+
+  return oltDevice->GetPhyAdapter ()->ProcessXgponUsBurstFromChannel (burst, profile);
+}
+
+
+void
+XgponAnalyticErrorUpstreamTestCase::DoRun (void)
+{
+  Config::SetDefault ("ns3::XgponChannel::AnalyticErrorModel", BooleanValue (true));
+  Config::SetDefault ("ns3::XgponChannel::BitErrorRate", DoubleValue (m_channelBer));
+
+  XgponHelper xgponHelper;
+  xgponHelper.InitializeObjectFactories ( );
+  NetDeviceContainer xgponDevices = xgponHelper.CreateDevices (2);
+  Ptr<XgponOltNetDevice> oltDevice = DynamicCast<XgponOltNetDevice, NetDevice> (xgponDevices.Get(0));
+  Ptr<XgponOnuNetDevice> onuDevice = DynamicCast<XgponOnuNetDevice, NetDevice> (xgponDevices.Get(1));
+  Ptr<XgponOnuNetDevice> otherOnuDevice = DynamicCast<XgponOnuNetDevice, NetDevice> (xgponDevices.Get(2));
+
+  //set after the ONU is added to the OLT: the copy kept by the OLT has to follow.
+  xgponHelper.SetOnuBitErrorRate (onuDevice, m_onuBer);
+
+  for(uint32_t i = 0; i < N_BURSTS; i++)
+  {
+    NS_TEST_EXPECT_MSG_EQ (ReceiveBurst (oltDevice, onuDevice), (m_onuBer <= 0), "The upstream loss does not follow the bit error rate of the ONU (burst " << i << ")");
+    NS_TEST_EXPECT_MSG_EQ (ReceiveBurst (oltDevice, otherOnuDevice), (m_channelBer <= 0), "The upstream loss does not follow the bit error rate of the channel (burst " << i << ")");
+  }
+
+  Simulator::Destroy ();
+}
+
+
+void
+XgponAnalyticErrorUpstreamTestCase::DoTeardown (void)
+{
+  Config::Reset ();
+}
+
+
+
+
+/**
+ * \brief the per-ONU bit error rates of the analytic error model
+ */
+class XgponAnalyticErrorTestSuite : public TestSuite
+{
+public:
+  XgponAnalyticErrorTestSuite ();
+};
+
+
+XgponAnalyticErrorTestSuite::XgponAnalyticErrorTestSuite ()
+  : TestSuite ("xgpon-analytic-error")
+{
+  AddTestCase (new XgponAnalyticErrorUpstreamTestCase (0, 0.5));    //a distant ONU on a clean channel
+  AddTestCase (new XgponAnalyticErrorUpstreamTestCase (0.5, 0));    //a clean ONU on a noisy channel
+}
+
+static XgponAnalyticErrorTestSuite g_xgponAnalyticErrorTestSuite;
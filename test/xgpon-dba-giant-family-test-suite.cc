@@ -0,0 +1,272 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2012 University College Cork (UCC), Ireland
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jerome Arokkiam <jerome.arokkia@bt.com>
+ */
+
+/*
+ * The DBA engines of the GIANT family and EBU (XgponOltDbaEngineGiantCore) have to produce the same BWmaps, bit for bit,
+ * as the engines they replaced. The BWmaps of those engines are recorded in xgpon-dba-giant-family/ (one line per BWmap:
+ * the number of ONUs, the frame, then AllocId:StartTime:GrantSize:DbruFlag:BurstProfileIndex of each allocation).
+ * The engine is driven as in examples/xpon-dba-benchmark.cc (devices without nodes, one BWmap per frame) and receives
+ * the status reports of a fixed pseudo-random sequence in the DBRu of its grants.
+ */
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/test.h"
+
+#include "ns3/xgpon-helper.h"
+#include "ns3/xgpon-config-db.h"
+
+#include "ns3/xgpon-onu-net-device.h"
+#include "ns3/xgpon-olt-net-device.h"
+
+
+using namespace ns3;
+
+
+// set to true to record the BWmaps of the current engines (only after checking a change of their behaviour on purpose)
+static const bool WRITE_VECTORS = false;
+
+
+/**
+ * \brief one engine of the GIANT family against its recorded BWmaps, for one PON mode, one load and one DBA cycle length
+ */
+class XgponDbaGiantFamilyTestCase : public TestCase
+{
+public:
+  XgponDbaGiantFamilyTestCase (const std::string& engine, const std::string& ponMode, double load, uint32_t framesPerCycle);
+
+private:
+  static std::string GetTestName (const std::string& engine, const std::string& ponMode, double load, uint32_t framesPerCycle);
+
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  //one frame: compare the BWmap with the recorded one (or record it) and deliver the reports of its DBRu
+  void RunFrame (uint32_t frame);
+
+  //create the OLT and nOnus ONUs (with T-CONTs of the types 1 to 4) of the engine
+  Ptr<XgponOltDbaEngine> CreateEngine (uint16_t nOnus);
+
+  //the next report of the fixed sequence (a linear congruential generator, not the random streams of ns-3)
+  uint32_t GetNextReport (void);
+
+  std::string m_engineStr;
+  std::string m_ponMode;
+  double m_load;                   //the maximum of the reports relative to the share of one T-CONT in the upstream frame
+  uint32_t m_framesPerCycle;
+
+  static const uint32_t N_FRAMES = 50;
+
+  Ptr<XgponOltDbaEngine> m_engine;
+  std::vector<uint16_t> m_onuIds;  //indexed by alloc-id
+  uint32_t m_reportState;
+  uint32_t m_maxReport;            //unit: block
+  uint16_t m_nOnus;
+
+  std::ifstream m_vectors;
+  std::ofstream m_recorded;
+};
+
+
+XgponDbaGiantFamilyTestCase::XgponDbaGiantFamilyTestCase (const std::string& engine, const std::string& ponMode, double load, uint32_t framesPerCycle)
+  : TestCase (GetTestName (engine, ponMode, load, framesPerCycle)),
+    m_engineStr (engine),
+    m_ponMode (ponMode),
+    m_load (load),
+    m_framesPerCycle (framesPerCycle),
+    m_reportState (0),
+    m_maxReport (0),
+    m_nOnus (0)
+{
+}
+
+
+std::string
+XgponDbaGiantFamilyTestCase::GetTestName (const std::string& engine, const std::string& ponMode, double load, uint32_t framesPerCycle)
+{
+  std::ostringstream name;
+  name << engine << " against its recorded BWmaps (" << ponMode << ", load " << load << ", " << framesPerCycle << " frames per DBA cycle)";
+  return name.str ();
+}
+
+
+Ptr<XgponOltDbaEngine>
+XgponDbaGiantFamilyTestCase::CreateEngine (uint16_t nOnus)
+{
+  XgponHelper xgponHelper;
+  XgponConfigDb& xgponConfigDb = xgponHelper.GetConfigDb ( );
+  xgponConfigDb.SetPonMode (m_ponMode);
+  xgponConfigDb.SetAllocateIds4Speed (false);    //the speed allocator only moves to the next alloc-id when an upstream connection is added
+  xgponConfigDb.SetOltDbaEngineTypeIdStr (m_engineStr);
+  xgponHelper.InitializeObjectFactories ( );
+
+  double capacity = (m_ponMode == "XGPON") ? 2.24e9 : 9.94e9;  //unit: bps
+  uint64_t perTcontRate = (uint64_t) (capacity / (nOnus * 4));
+  xgponHelper.SetQosParametersAttribute ("FixedBandwidth", UintegerValue (perTcontRate / 4));
+  xgponHelper.SetQosParametersAttribute ("AssuredBandwidth", UintegerValue (perTcontRate));
+  xgponHelper.SetQosParametersAttribute ("NonAssuredBandwidth", UintegerValue (perTcontRate));
+  xgponHelper.SetQosParametersAttribute ("BestEffortBandwidth", UintegerValue (perTcontRate));
+  xgponHelper.SetQosParametersAttribute ("MaxServiceInterval", UintegerValue (1));
+  xgponHelper.SetQosParametersAttribute ("MinServiceInterval", UintegerValue (2));
+
+  NetDeviceContainer xgponDevices = xgponHelper.CreateDevices (nOnus);
+  Ptr<XgponOltNetDevice> oltDevice = DynamicCast<XgponOltNetDevice, NetDevice> (xgponDevices.Get(0));
+
+  for(uint16_t i = 0; i < nOnus; i++)
+  {
+    Ptr<XgponOnuNetDevice> onuDevice = DynamicCast<XgponOnuNetDevice, NetDevice> (xgponDevices.Get(i+1));
+    for(uint16_t type = 1; type <= 4; type++)
+    {
+      uint16_t allocId = xgponHelper.AddOneTcontForOnu (onuDevice, oltDevice, static_cast<XgponQosParameters::XgponTcontType> (type));
+      if(allocId >= m_onuIds.size ()) m_onuIds.resize (allocId + 1, 0xFFFF);
+      m_onuIds[allocId] = onuDevice->GetOnuId ();
+    }
+  }
+
+  uint32_t usFrameSize = oltDevice->GetXgponPhy ()->GetUsPhyFrameSizeInBlocks ();
+  m_maxReport = (uint32_t) (m_load * usFrameSize / (nOnus * 4)) + 1;
+
+  return oltDevice->GetDbaEngine ();
+}
+
+
+uint32_t
+XgponDbaGiantFamilyTestCase::GetNextReport (void)
+{
+  m_reportState = m_reportState * 1103515245 + 12345;
+  return (m_reportState >> 16) % (m_maxReport + 1);
+}
+
+
+void
+XgponDbaGiantFamilyTestCase::RunFrame (uint32_t frame)
+{
+  Ptr<XgponXgtcBwmap> map = m_engine->GenerateBwMap ();
+
+  std::ostringstream line;
+  line << m_nOnus << " " << frame;
+  uint16_t num = map->GetNumberOfBwAllocation ();
+  for(uint16_t i = 0; i < num; i++)
+  {
+    const Ptr<XgponXgtcBwAllocation>& bwAlloc = map->GetBwAllocationByIndex (i);
+    line << " " << bwAlloc->GetAllocId () << ":" << bwAlloc->GetStartTime () << ":" << bwAlloc->GetGrantSize ()
+         << ":" << (uint32_t) bwAlloc->GetDbruFlag () << ":" << (uint32_t) bwAlloc->GetBurstProfileIndex ();
+  }
+
+  if(WRITE_VECTORS) m_recorded << line.str () << std::endl;
+  else
+  {
+    std::string expected;
+    std::getline (m_vectors, expected);
+    NS_TEST_EXPECT_MSG_EQ (line.str (), expected, "Different BWmap (" << m_nOnus << " ONUs, frame " << frame << ")");
+  }
+
+  uint64_t now = Simulator::Now ().GetNanoSeconds ();
+  for(uint16_t i = 0; i < num; i++)
+  {
+    const Ptr<XgponXgtcBwAllocation>& bwAlloc = map->GetBwAllocationByIndex (i);
+    if(bwAlloc->GetDbruFlag ())
+    {
+      uint16_t allocId = bwAlloc->GetAllocId ();
+      m_engine->ReceiveStatusReport (Create<XgponXgtcDbru> (GetNextReport ()), m_onuIds[allocId], allocId, now);
+    }
+  }
+}
+
+
+void
+XgponDbaGiantFamilyTestCase::DoRun (void)
+{
+  std::ostringstream filename;
+  filename << "xgpon-dba-giant-family/" << m_engineStr.substr (m_engineStr.find ("Engine") + 6) << "-" << m_ponMode
+           << "-" << m_load << "-" << m_framesPerCycle << ".txt";
+  SetDataDir (NS_TEST_SOURCEDIR);
+  if(WRITE_VECTORS) m_recorded.open (CreateDataDirFilename (filename.str ()).c_str ());
+  else
+  {
+    m_vectors.open (CreateDataDirFilename (filename.str ()).c_str ());
+    NS_TEST_ASSERT_MSG_EQ (m_vectors.good (), true, "Cannot open the recorded BWmaps " << filename.str ());
+  }
+
+  Config::SetDefault ("ns3::XgponOltDbaEngine::FramesPerDBAcycle", UintegerValue (m_framesPerCycle));
+
+  uint16_t onuCounts[] = { 1, 3, 9 };   //one ONU alone, a few ONUs and (9*4 T-CONTs) a full BWmap
+  for(uint32_t n = 0; n < 3; n++)
+  {
+    m_nOnus = onuCounts[n];
+    m_onuIds.clear ();
+    m_engine = CreateEngine (m_nOnus);
+    m_reportState = m_nOnus;
+
+    for(uint32_t frame = 0; frame < N_FRAMES; frame++)
+    {
+      Simulator::Schedule (NanoSeconds ((uint64_t) frame * 125000), &XgponDbaGiantFamilyTestCase::RunFrame, this, frame);
+    }
+    Simulator::Run ();
+    Simulator::Destroy ();
+
+    m_engine = nullptr;
+  }
+}
+
+
+void
+XgponDbaGiantFamilyTestCase::DoTeardown (void)
+{
+  m_vectors.close ();
+  m_recorded.close ();
+  Config::Reset ();
+}
+
+
+
+
+/**
+ * \brief the GIANT family and EBU against the BWmaps of the engines they replaced
+ */
+class XgponDbaGiantFamilyTestSuite : public TestSuite
+{
+public:
+  XgponDbaGiantFamilyTestSuite ();
+};
+
+
+XgponDbaGiantFamilyTestSuite::XgponDbaGiantFamilyTestSuite ()
+  : TestSuite ("xgpon-dba-giant-family")
+{
+  const char* engines[] = { "ns3::XgponOltDbaEngineGiant", "ns3::XgponOltDbaEngineXgiant", "ns3::XgponOltDbaEngineXgiantDeficit",
+                            "ns3::XgponOltDbaEngineXgiantProp", "ns3::XgponOltDbaEngineEbu" };
+  const char* ponModes[] = { "XGPON", "XGSPON" };   //the two upstream frame sizes
+  double loads[] = { 0.2, 1, 3 };                   //underloaded, loaded and overloaded frames
+  uint32_t framesPerCycle[] = { 1, 4 };
+
+  for(uint32_t e = 0; e < 5; e++)
+    for(uint32_t p = 0; p < 2; p++)
+      for(uint32_t l = 0; l < 3; l++)
+        for(uint32_t f = 0; f < 2; f++)
+          AddTestCase (new XgponDbaGiantFamilyTestCase (engines[e], ponModes[p], loads[l], framesPerCycle[f]));
+}
+
+static XgponDbaGiantFamilyTestSuite g_xgponDbaGiantFamilyTestSuite;